@@ -739,7 +739,7 @@ static void borg_cmd_grid_target_info(void)
         msg("Borg Info for grid (%d, %d) is XTRA", y, x);
 
     for (i = 0; i < SQUARE_MAX; i++)
-        if (sqinfo_has(square(cave, l)->info, i))
+        if (sqinfo_has(square_info(cave, l), i))
             msg(format("Sys Info for grid (%d, %d) is %d", y, x, i));
     prt_map();
 }
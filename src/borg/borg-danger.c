@@ -50,6 +50,341 @@ uint16_t borg_fear_monsters[AUTO_MAX_Y + 1][AUTO_MAX_X + 1];
  */
 bool borg_danger_wipe = false;
 
+/*
+ * The danger from all the monsters to each grid is worked out the first
+ * time the grid is asked about and kept until something it depends on
+ * changes.  A monster only matters within 20 grids, so when one moves, or
+ * the map changes near one, only the grids around it are forgotten; the
+ * rest stay known from turn to turn.
+ *
+ * There is one map for each "average" mode.  Each grid keeps the multiplier
+ * it was computed for, and the stamp of the borg's state it was computed
+ * in; the last few states are remembered, so that asking "what if" does
+ * not throw away the real danger.
+ */
+struct borg_danger_memo {
+    uint32_t stamp;
+    int      c;
+    int      p;
+};
+
+static struct borg_danger_memo borg_danger_memo[2][AUTO_MAX_Y][AUTO_MAX_X];
+
+/*
+ * The traits read by borg_danger_one_kill() and the functions it calls;
+ * the others change often as the borg tries on gear, and do not matter.
+ * Food, fuel, gold and mana are only compared with fixed amounts, which
+ * is done in borg_danger_check_state().
+ */
+static const int borg_danger_traits[] = {
+    BI_ARMOR, BI_CCON, BI_CDEPTH, BI_CDEX, BI_CINT, BI_CLASS,
+    BI_CLEVEL, BI_CSTR, BI_CURHP, BI_CWIS, BI_DAM_RED,
+    BI_DEX_INDEX, BI_FRACT, BI_HLIFE, BI_IACID, BI_ICOLD,
+    BI_IELEC, BI_IFIRE, BI_IPOIS, BI_ISHEAVYSTUN, BI_ISSTUN, BI_MAXDEPTH,
+    BI_MAXHP, BI_MAXSP, BI_RACID, BI_RBLIND, BI_RCOLD, BI_RCONF, BI_RDARK,
+    BI_RDIS, BI_RELEC, BI_RFEAR, BI_RFIRE, BI_RKAOS, BI_RLITE, BI_RNTHR,
+    BI_RNXUS, BI_RPOIS, BI_RSHRD, BI_RSND, BI_SAV, BI_SCON, BI_SDEX,
+    BI_SINT, BI_SPEED, BI_SSTR, BI_SWIS
+};
+
+/*
+ * What the borg was, and was pretending to be, when some danger was
+ * worked out.  The fight and gear code often sets a flag or a trait, asks
+ * for the danger, and puts it back, so this is compared on each call.
+ */
+struct borg_danger_state {
+    uint32_t    tp_other;
+    uint32_t    glyphs;
+    uint32_t    spells;
+    struct temp temp;
+    int         fighting_unique;
+    bool        bored;
+    bool        light_out;
+    bool        hungry;
+    bool        low_fuel;
+    bool        low_mana;
+    uint8_t     gold;
+    bool        attacking;
+    bool        create_door;
+    bool        on_glyph;
+    bool        as_position;
+    bool        morgoth_position;
+    bool        sleep_spell;
+    bool        sleep_spell_ii;
+    bool        slow_spell;
+    bool        confuse_spell;
+    bool        fear_mon_spell;
+    int16_t     book_idx[9];
+    int         trait[N_ELEMENTS(borg_danger_traits)];
+};
+
+#define BORG_DANGER_STATES 4
+
+static struct borg_danger_state borg_danger_states[BORG_DANGER_STATES];
+static uint32_t borg_danger_stamps[BORG_DANGER_STATES];
+static uint32_t borg_danger_used[BORG_DANGER_STATES];
+static uint32_t borg_danger_stamp;
+static uint32_t borg_danger_uses;
+static int      borg_danger_now;
+
+/*
+ * What the danger code reads of each monster, as it was when the danger
+ * was worked out.  Where the borg stands only matters to whether the
+ * monster's bolts can reach it.
+ */
+struct borg_danger_kill {
+    struct loc pos;
+    uint16_t   r_idx;
+    bool       awake;
+    bool       confused;
+    bool       afraid;
+    bool       stunned;
+    bool       reach;
+    uint8_t    speed;
+    uint8_t    ranged_attack;
+    int16_t    power;
+    int16_t    injury;
+    int16_t    level;
+};
+
+static struct borg_danger_kill borg_danger_kills[256];
+static int                     borg_danger_kills_nxt;
+
+/*
+ * The map as it was when the danger was worked out, and where the borg
+ * was, and how often the map had changed, when the reach of the monsters'
+ * bolts was
+ */
+static borg_grid  borg_danger_map[AUTO_MAX_Y][AUTO_MAX_X];
+static uint32_t   borg_danger_map_changes;
+static uint32_t   borg_danger_reach_changes;
+static struct loc borg_danger_reach_c;
+
+/*
+ * Forget the danger maps
+ */
+void borg_danger_forget(void)
+{
+    memset(borg_danger_stamps, 0, sizeof(borg_danger_stamps));
+}
+
+/*
+ * Forget the danger to the grids within the given distance of a grid
+ */
+static void borg_danger_forget_near(int y1, int x1, int y2, int x2, int d)
+{
+    int y;
+
+    y1 = MAX(y1 - d, 0);
+    x1 = MAX(x1 - d, 0);
+    y2 = MIN(y2 + d, AUTO_MAX_Y - 1);
+    x2 = MIN(x2 + d, AUTO_MAX_X - 1);
+    for (y = y1; y <= y2; y++) {
+        memset(&borg_danger_memo[0][y][x1], 0,
+            (x2 - x1 + 1) * sizeof(struct borg_danger_memo));
+        memset(&borg_danger_memo[1][y][x1], 0,
+            (x2 - x1 + 1) * sizeof(struct borg_danger_memo));
+    }
+}
+
+/*
+ * Mix a value into a hash (FNV-1a, a word at a time)
+ */
+static uint32_t borg_danger_hash(uint32_t h, uint32_t v)
+{
+    return (h ^ v) * 16777619U;
+}
+
+/*
+ * Forget the danger near any grid of the map which has changed near a
+ * monster.  A monster's danger depends on the map between it and the grid,
+ * and just around it, so on grids no more than 22 away.
+ *
+ * This is called each turn after the map has been read from the screen,
+ * and when the flows are told the danger has changed.
+ */
+void borg_danger_notice_map(void)
+{
+    int  x, y, i;
+    int  y1 = AUTO_MAX_Y, x1 = AUTO_MAX_X, y2 = -1, x2 = -1;
+    bool changed = false;
+
+    for (y = 0; y < AUTO_MAX_Y; y++) {
+        for (x = 0; x < AUTO_MAX_X; x++) {
+            borg_grid *ag  = &borg_grids[y][x];
+            borg_grid *old = &borg_danger_map[y][x];
+
+            if (ag->feat == old->feat && ag->kill == old->kill
+                && ag->glyph == old->glyph)
+                continue;
+            *old    = *ag;
+            changed = true;
+
+            for (i = 1; i < borg_kills_nxt; i++) {
+                borg_kill *kill = &borg_kills[i];
+
+                if (kill->r_idx && ABS(kill->pos.x - x) <= 22
+                    && ABS(kill->pos.y - y) <= 22)
+                    break;
+            }
+            if (i == borg_kills_nxt)
+                continue;
+            y1 = MIN(y1, y);
+            x1 = MIN(x1, x);
+            y2 = MAX(y2, y);
+            x2 = MAX(x2, x);
+        }
+    }
+
+    if (changed)
+        borg_danger_map_changes++;
+    if (y2 >= 0)
+        borg_danger_forget_near(y1, x1, y2, x2, 22);
+}
+
+/*
+ * Forget the danger near any monster which has changed
+ */
+static void borg_danger_check_kills(void)
+{
+    int  i, n = MAX(borg_kills_nxt, borg_danger_kills_nxt);
+    bool reach_known = loc_eq(borg.c, borg_danger_reach_c)
+        && borg_danger_map_changes == borg_danger_reach_changes;
+
+    for (i = 1; i < n; i++) {
+        struct borg_danger_kill  now;
+        struct borg_danger_kill *old  = &borg_danger_kills[i];
+        borg_kill               *kill = &borg_kills[i];
+
+        /* Clear the padding so the monsters can be compared as bytes */
+        memset(&now, 0, sizeof(now));
+        if (i < borg_kills_nxt && kill->r_idx) {
+            now.pos           = kill->pos;
+            now.r_idx         = kill->r_idx;
+            now.awake         = kill->awake;
+            now.confused      = kill->confused;
+            now.afraid        = kill->afraid;
+            now.stunned       = kill->stunned;
+            now.speed         = kill->speed;
+            now.ranged_attack = kill->ranged_attack;
+            now.power         = kill->power;
+            now.injury        = kill->injury;
+            now.level         = kill->level;
+            if (reach_known && old->r_idx && loc_eq(old->pos, now.pos))
+                now.reach = old->reach;
+            else
+                now.reach = borg_projectable_pure(
+                    now.pos.y, now.pos.x, borg.c.y, borg.c.x);
+        }
+        if (!memcmp(&now, old, sizeof(now)))
+            continue;
+
+        /* Player ghosts are dangerous everywhere */
+        if (now.r_idx >= z_info->r_max - 1 || old->r_idx >= z_info->r_max - 1)
+            borg_danger_forget();
+        if (old->r_idx)
+            borg_danger_forget_near(
+                old->pos.y, old->pos.x, old->pos.y, old->pos.x, 20);
+        if (now.r_idx)
+            borg_danger_forget_near(
+                now.pos.y, now.pos.x, now.pos.y, now.pos.x, 20);
+        *old = now;
+    }
+
+    borg_danger_kills_nxt     = borg_kills_nxt;
+    borg_danger_reach_c       = borg.c;
+    borg_danger_reach_changes = borg_danger_map_changes;
+}
+
+/*
+ * Find the stamp for the danger worked out in the current state, giving
+ * the state a new one if it has not been seen lately
+ */
+static void borg_danger_check_state(void)
+{
+    struct borg_danger_state now;
+    uint32_t                 h = 2166136261U;
+    int                      i, old = 0;
+
+    /* Clear the padding so the states can be compared as bytes */
+    memset(&now, 0, sizeof(now));
+    now.temp             = borg.temp;
+    now.fighting_unique  = borg_fighting_unique;
+    now.bored            = borg.time_this_panel > 1200 || borg_t > 25000;
+    now.light_out        = !borg_items[INVEN_LIGHT].timeout
+                    || of_has(borg_items[INVEN_LIGHT].flags, OF_NO_FUEL);
+    now.hungry           = borg.trait[BI_FOOD] <= 5;
+    now.low_fuel         = borg.trait[BI_AFUEL] <= 5;
+    now.low_mana         = borg.trait[BI_CURSP] < 15;
+    now.gold             = (borg.trait[BI_GOLD] >= 100)
+                + (borg.trait[BI_GOLD] > 100000);
+    now.attacking        = borg_attacking;
+    now.create_door      = borg_create_door;
+    now.on_glyph         = borg_on_glyph;
+    now.as_position      = borg_as_position;
+    now.morgoth_position = borg_morgoth_position;
+    now.sleep_spell      = borg_sleep_spell;
+    now.sleep_spell_ii   = borg_sleep_spell_ii;
+    now.slow_spell       = borg_slow_spell;
+    now.confuse_spell    = borg_confuse_spell;
+    now.fear_mon_spell   = borg_fear_mon_spell;
+    memcpy(now.book_idx, borg.book_idx, sizeof(now.book_idx));
+    for (i = 0; i < (int)N_ELEMENTS(borg_danger_traits); i++)
+        now.trait[i] = borg.trait[borg_danger_traits[i]];
+
+    /* Glyphs lessen the danger where they are */
+    for (i = 0; i < track_glyph.num; i++)
+        h = borg_danger_hash(h, track_glyph.x[i] | (track_glyph.y[i] << 16));
+    now.glyphs = h;
+
+    /* Which spells can be cast, as borg_spell_legal() sees it */
+    h = 2166136261U;
+    if (borg_magics) {
+        for (i = 0; i < player->class->magic.total_spells; i++)
+            h = borg_danger_hash(h, borg_magics[i].status);
+    }
+    now.spells = h;
+
+    /* Monsters about to be teleported away are ignored */
+    h = 2166136261U;
+    if (borg_tp_other_n) {
+        for (i = 0; i <= borg_tp_other_n && i < 255; i++)
+            h = borg_danger_hash(h, borg_tp_other_index[i]);
+        now.tp_other = borg_danger_hash(h, borg_tp_other_n);
+    }
+
+    /* Usually nothing has changed */
+    if (borg_danger_stamps[borg_danger_now]
+        && !memcmp(&now, &borg_danger_states[borg_danger_now], sizeof(now)))
+        return;
+
+    /* Look for the state among the recent ones, or replace the one used
+     * longest ago */
+    for (i = 0; i < BORG_DANGER_STATES; i++) {
+        if (borg_danger_stamps[i]
+            && !memcmp(&now, &borg_danger_states[i], sizeof(now)))
+            break;
+        if (!borg_danger_stamps[i]
+            || (borg_danger_stamps[old]
+                && borg_danger_used[i] < borg_danger_used[old]))
+            old = i;
+    }
+    if (i == BORG_DANGER_STATES) {
+        i                     = old;
+        borg_danger_states[i] = now;
+
+        /* Start again when the stamps run out */
+        if (++borg_danger_stamp == 0) {
+            memset(borg_danger_memo, 0, sizeof(borg_danger_memo));
+            borg_danger_forget();
+            borg_danger_stamp = 1;
+        }
+        borg_danger_stamps[i] = borg_danger_stamp;
+    }
+    borg_danger_now     = i;
+    borg_danger_used[i] = ++borg_danger_uses;
+}
+
 /*
  * Calculate base danger from a monster's physical attacks
  *
@@ -2824,7 +3159,8 @@ int borg_danger_one_kill(
  */
 int borg_danger(int y, int x, int c, bool average, bool full_damage)
 {
-    int i, p = 0;
+    int i, p = 0, q = 0;
+    struct borg_danger_memo *memo = NULL;
 
     struct loc l = loc(x, y);
     if (!square_in_bounds(cave, l))
@@ -2850,6 +3186,19 @@ int borg_danger(int y, int x, int c, bool average, bool full_damage)
 
     full_damage = true;
 
+    /* Use the danger from the monsters if it is known; a crushing spell
+     * depends on what the borg can see, so is always worked out */
+    if (!borg_crush_spell) {
+        borg_danger_check_kills();
+        borg_danger_check_state();
+        memo = &borg_danger_memo[average ? 1 : 0][y][x];
+        if (memo->stamp == borg_danger_stamps[borg_danger_now]
+            && memo->c == c) {
+            p += memo->p;
+            return (p > 2000 ? 2000 : p);
+        }
+    }
+
     /* Examine all the monsters */
     for (i = 1; i < borg_kills_nxt; i++) {
         borg_kill *kill = &borg_kills[i];
@@ -2859,8 +3208,16 @@ int borg_danger(int y, int x, int c, bool average, bool full_damage)
             continue;
 
         /* Collect danger from monster */
-        p += borg_danger_one_kill(y, x, c, i, average, full_damage);
+        q += borg_danger_one_kill(y, x, c, i, average, full_damage);
+    }
+
+    /* Remember it */
+    if (memo) {
+        memo->stamp = borg_danger_stamps[borg_danger_now];
+        memo->c     = c;
+        memo->p     = q;
     }
+    p += q;
 
     /* Return the danger */
     return (p > 2000 ? 2000 : p);
@@ -76,6 +76,16 @@ extern uint16_t borg_fear_monsters[AUTO_MAX_Y + 1][AUTO_MAX_X + 1];
  */
 extern bool borg_danger_wipe;
 
+/*
+ * Forget the danger to each grid
+ */
+extern void borg_danger_forget(void);
+
+/*
+ * Forget the danger to each grid if the map has changed
+ */
+extern void borg_danger_notice_map(void);
+
 /*
  * Calculate danger to a grid from a monster
  */
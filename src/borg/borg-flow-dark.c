@@ -250,7 +250,7 @@ static void borg_flow_direct(int y, int x)
 
     int shift;
 
-    int p, fear = 0;
+    int p, fear;
 
     borg_grid *ag;
 
@@ -258,6 +258,9 @@ static void borg_flow_direct(int y, int x)
     if (borg_data_icky->data[y][x])
         return;
 
+    /* How much danger to put up with */
+    fear = borg_flow_fear(avoidance * 1 / 10);
+
     /* Unknown */
     if (!borg_data_know->data[y][x]) {
         /* Mark as known */
@@ -266,28 +269,6 @@ static void borg_flow_direct(int y, int x)
         /* Get the danger */
         p = borg_danger(y, x, 1, true, false);
 
-        /* Increase bravery */
-        if (borg.trait[BI_MAXCLEVEL] == 50)
-            fear = avoidance * 5 / 10;
-        if (borg.trait[BI_MAXCLEVEL] != 50)
-            fear = avoidance * 3 / 10;
-        if (scaryguy_on_level)
-            fear = avoidance * 2;
-        if (unique_on_level && vault_on_level && borg.trait[BI_MAXCLEVEL] == 50)
-            fear = avoidance * 3;
-        if (scaryguy_on_level && borg.trait[BI_CLEVEL] <= 5)
-            fear = avoidance * 3;
-        if (borg.goal.ignoring)
-            fear = avoidance * 5;
-        if (borg_t - borg_began > 5000)
-            fear = avoidance * 25;
-        if (borg.trait[BI_FOOD] == 0)
-            fear = avoidance * 100;
-
-        /* Normal in town */
-        if (borg.trait[BI_CLEVEL] == 0)
-            fear = avoidance * 1 / 10;
-
         /* Mark dangerous grids as icky */
         if (p > fear) {
             /* Icky */
@@ -388,29 +369,6 @@ static void borg_flow_direct(int y, int x)
             /* Get the danger */
             p = borg_danger(y, x, 1, true, false);
 
-            /* Increase bravery */
-            if (borg.trait[BI_MAXCLEVEL] == 50)
-                fear = avoidance * 5 / 10;
-            if (borg.trait[BI_MAXCLEVEL] != 50)
-                fear = avoidance * 3 / 10;
-            if (scaryguy_on_level)
-                fear = avoidance * 2;
-            if (unique_on_level && vault_on_level
-                && borg.trait[BI_MAXCLEVEL] == 50)
-                fear = avoidance * 3;
-            if (scaryguy_on_level && borg.trait[BI_CLEVEL] <= 5)
-                fear = avoidance * 3;
-            if (borg.goal.ignoring)
-                fear = avoidance * 5;
-            if (borg_t - borg_began > 5000)
-                fear = avoidance * 25;
-            if (borg.trait[BI_FOOD] == 0)
-                fear = avoidance * 100;
-
-            /* Normal in town */
-            if (borg.trait[BI_CLEVEL] == 0)
-                fear = avoidance * 1 / 10;
-
             /* Avoid dangerous grids (forever) */
             if (p > fear) {
                 /* Mark as icky */
@@ -28,6 +28,7 @@
 #include "borg-prepared.h"
 #include "borg-store-sell.h"
 #include "borg-trait.h"
+#include "borg.h"
 
 /*
  * Track "stairs up"
@@ -39,6 +40,31 @@ struct borg_track track_less;
  */
 struct borg_track track_more;
 
+/*
+ * The distances to the stair last flowed from.  The same stair is often
+ * checked against many grids in one turn, and the distances only change
+ * with the map or with how much danger the borg will walk through.
+ */
+struct stair_flow {
+    int16_t turn;
+    int     stair, y, x;
+    int16_t avoidance;
+    int     shop;
+    bool    ignoring, desperate, lunal, munchkin, digging;
+};
+
+static struct stair_flow stair_flow;
+static bool              stair_flow_valid = false;
+static borg_data        *stair_flow_cost;
+
+/*
+ * Forget the distances to the stair last flowed from
+ */
+void borg_flow_stair_forget(void)
+{
+    stair_flow_valid = false;
+}
+
 /*
  * Do a Stair-Flow.  Look at how far away this grid is to my closest stair
  */
@@ -46,6 +72,8 @@ int borg_flow_cost_stair(int y, int x, int b_stair)
 {
     int cost = 255;
 
+    struct stair_flow key;
+
     /* Clear the flow codes */
     borg_flow_clear();
 
@@ -53,11 +81,35 @@ int borg_flow_cost_stair(int y, int x, int b_stair)
     if (b_stair == -1)
         return 0;
 
-    /* Enqueue the player's grid */
-    borg_flow_enqueue_grid(track_less.y[b_stair], track_less.x[b_stair]);
+    /* Describe this flow */
+    memset(&key, 0, sizeof(key));
+    key.turn      = borg_t;
+    key.stair     = b_stair;
+    key.y         = track_less.y[b_stair];
+    key.x         = track_less.x[b_stair];
+    key.avoidance = avoidance;
+    key.shop      = borg.goal.shop;
+    key.ignoring  = borg.goal.ignoring;
+    key.desperate = borg_desperate;
+    key.lunal     = borg.lunal_mode;
+    key.munchkin  = borg.munchkin_mode;
+    key.digging   = borg_digging;
+
+    if (stair_flow_valid && !memcmp(&key, &stair_flow, sizeof(key))) {
+        /* Reuse the last flow */
+        memcpy(borg_data_cost, stair_flow_cost, sizeof(borg_data));
+    } else {
+        /* Enqueue the player's grid */
+        borg_flow_enqueue_grid(key.y, key.x);
 
-    /* Spread, but do NOT optimize */
-    borg_flow_spread(250, false, false, false, b_stair, false);
+        /* Spread, but do NOT optimize */
+        borg_flow_spread(250, false, false, false, b_stair, false);
+
+        /* Remember it */
+        memcpy(stair_flow_cost, borg_data_cost, sizeof(borg_data));
+        stair_flow       = key;
+        stair_flow_valid = true;
+    }
 
     /* Distance from the grid to the stair */
     cost = borg_data_cost->data[y][x];
@@ -347,10 +399,18 @@ void borg_init_flow_stairs(void)
 
     /* Track "down" stairs */
     borg_init_track(&track_more, 16);
+
+    /* Distances to a stair */
+    stair_flow_cost  = mem_zalloc(sizeof(borg_data));
+    stair_flow_valid = false;
 }
 
 void borg_free_flow_stairs(void)
 {
+    mem_free(stair_flow_cost);
+    stair_flow_cost  = NULL;
+    stair_flow_valid = false;
+
     borg_free_track(&track_more);
     borg_free_track(&track_less);
 }
@@ -37,6 +37,11 @@ extern struct borg_track track_less;
  */
 extern struct borg_track track_more;
 
+/*
+ * Forget the distances to the stair last flowed from
+ */
+extern void borg_flow_stair_forget(void);
+
 /*
  * Do a Stair-Flow.  Look at how far away this grid is to my closest stair
  */
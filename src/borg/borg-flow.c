@@ -39,20 +39,36 @@
 #include "borg.h"
 
 /*
- * Use "flow" array as a queue
+ * The grids the current flow started from, in the order they were enqueued
  */
 
-int flow_head = 0;
-int flow_tail = 0;
+int16_t borg_flow_n = 0;
+
+uint8_t borg_flow_x[AUTO_FLOW_MAX];
+uint8_t borg_flow_y[AUTO_FLOW_MAX];
 
 /*
- * Maintain a circular queue of grids
+ * The grids waiting to be spread from are kept in a "bucket queue", with a
+ * list of grids for each flow cost.  A flow never goes back to a cheaper
+ * bucket than the one it is emptying, so the next grid is found by walking
+ * up the buckets, and steps could cost more than one without needing a heap.
+ *
+ * A grid is in at most one list, linked by its index (y * AUTO_MAX_X + x)
+ * through "flow_next" and "flow_prev".  A "flow_prev" of FLOW_UNQUEUED means
+ * the grid is not waiting at all.
  */
+#define FLOW_UNQUEUED -2
 
-int16_t borg_flow_n = 0;
+static int  flow_bucket[256];
+static int  flow_low = 0;
+static int *flow_next;
+static int *flow_prev;
 
-uint8_t borg_flow_x[AUTO_FLOW_MAX];
-uint8_t borg_flow_y[AUTO_FLOW_MAX];
+/*
+ * Grids next to a monster, worked out as needed during one "sneaky" flow
+ * (0 = not checked, 1 = clear, 2 = next to a monster)
+ */
+static borg_data *flow_sneak;
 
 /*
  * Some variables
@@ -178,6 +194,142 @@ bool borg_can_dig(bool check_fail, uint8_t feat)
     return false;
 }
 
+/*
+ * Add a grid to the flow at the given cost, which must not be below the
+ * cost of the grids being spread from.  A grid which is already waiting
+ * is moved to its new bucket.
+ */
+static void borg_flow_push(int y, int x, int cost)
+{
+    int g = y * AUTO_MAX_X + x;
+
+    /* Take it out of its old bucket */
+    if (flow_prev[g] != FLOW_UNQUEUED) {
+        if (flow_prev[g] < 0)
+            flow_bucket[borg_data_cost->data[y][x]] = flow_next[g];
+        else
+            flow_next[flow_prev[g]] = flow_next[g];
+        if (flow_next[g] >= 0)
+            flow_prev[flow_next[g]] = flow_prev[g];
+    }
+
+    /* Save the flow cost */
+    borg_data_cost->data[y][x] = cost;
+
+    /* Put it in the new one */
+    flow_prev[g] = -1;
+    flow_next[g] = flow_bucket[cost];
+    if (flow_next[g] >= 0)
+        flow_prev[flow_next[g]] = g;
+    flow_bucket[cost] = g;
+
+    /* Paranoia */
+    if (cost < flow_low)
+        flow_low = cost;
+}
+
+/*
+ * Take the cheapest grid waiting in the flow, returning false if there
+ * are none
+ */
+static bool borg_flow_pop(int *y, int *x)
+{
+    int g;
+
+    /* Find the cheapest bucket with anything in it */
+    while (flow_low < 255 && flow_bucket[flow_low] < 0)
+        flow_low++;
+    if (flow_low == 255)
+        return false;
+
+    /* Take the first grid */
+    g                     = flow_bucket[flow_low];
+    flow_bucket[flow_low] = flow_next[g];
+    if (flow_next[g] >= 0)
+        flow_prev[flow_next[g]] = -1;
+    flow_prev[g] = FLOW_UNQUEUED;
+
+    *y = g / AUTO_MAX_X;
+    *x = g % AUTO_MAX_X;
+    return true;
+}
+
+/*
+ * Forget any grids still waiting in the flow
+ */
+static void borg_flow_forget(void)
+{
+    int y, x;
+
+    while (borg_flow_pop(&y, &x))
+        /* Nothing */;
+    flow_low = 0;
+}
+
+/*
+ * Check if a grid is next to a monster, remembering the answer for the
+ * rest of the flow
+ */
+static bool borg_flow_near_kill(int y, int x)
+{
+    int i;
+
+    if (!flow_sneak->data[y][x]) {
+        /* Assume clear */
+        flow_sneak->data[y][x] = 1;
+
+        /* Scan the neighbors */
+        for (i = 0; i < 8; i++) {
+            int xx = x + ddx_ddd[i];
+            int yy = y + ddy_ddd[i];
+
+            /* only on legal grids */
+            if (!square_in_bounds_fully(cave, loc(xx, yy)))
+                continue;
+
+            if (borg_grids[yy][xx].kill) {
+                flow_sneak->data[y][x] = 2;
+                break;
+            }
+        }
+    }
+
+    return flow_sneak->data[y][x] == 2;
+}
+
+/*
+ * How much danger the borg will put up with on a grid it flows through,
+ * given how much it will put up with in town
+ */
+int borg_flow_fear(int town_fear)
+{
+    int fear = 0;
+
+    /* Increase bravery */
+    if (borg.trait[BI_MAXCLEVEL] == 50)
+        fear = avoidance * 5 / 10;
+    if (borg.trait[BI_MAXCLEVEL] != 50)
+        fear = avoidance * 3 / 10;
+    if (scaryguy_on_level)
+        fear = avoidance * 2;
+    if (unique_on_level && vault_on_level && borg.trait[BI_MAXCLEVEL] == 50)
+        fear = avoidance * 3;
+    if (scaryguy_on_level && borg.trait[BI_CLEVEL] <= 5)
+        fear = avoidance * 3;
+    if (borg.goal.ignoring)
+        fear = avoidance * 5;
+    if (borg_t - borg_began > 5000)
+        fear = avoidance * 25;
+    if (borg.trait[BI_FOOD] == 0)
+        fear = avoidance * 100;
+
+    /* Normal in town */
+    if (borg.trait[BI_CLEVEL] == 0)
+        fear = town_fear;
+
+    return fear;
+}
+
 /*
  * Clear the "flow" information
  */
@@ -194,13 +346,16 @@ void borg_flow_clear(void)
         /* Wipe the "icky" flags */
         memset(borg_data_icky, 0, sizeof(borg_data));
 
+        /* Check the danger maps against the map */
+        borg_danger_notice_map();
+
         /* Wipe complete */
         borg_danger_wipe = false;
     }
 
     /* Start over */
-    flow_head = 0;
-    flow_tail = 0;
+    borg_flow_forget();
+    borg_flow_n = 0;
 }
 
 /*
@@ -215,24 +370,19 @@ void borg_flow_clear(void)
  * a path which is at least 255 steps in length will thus appear
  * to be "unreachable", but this is not a major concern.
  *
- * We use the "flow" array as a "circular queue", and thus we must
- * be careful not to allow the "queue" to "overflow".  This could
- * only happen with a large number of distinct destination points,
- * each several units away from every other destination point, and
- * in a dungeon with no walls and no dangerous monsters.  But this
- * is technically possible, so we must check for it just in case.
- *
- * We do not need a "priority queue" because the cost from grid to
- * grid is always "one" and we process them in order.  If we did
- * use a priority queue, this function might become unusably slow,
- * unless we reactivated the "room building" code.
+ * The grids waiting to be spread from are kept in the bucket queue
+ * above, which has room for every grid, so it can never overflow.  The
+ * cost from grid to grid is always "one", so each bucket is emptied in
+ * turn, as the old circular queue was.
  *
  * We handle both "walls" and "danger" by marking every grid which
  * is "impassible", due to either walls, or danger, as "ICKY", and
  * marking every grid which has been "checked" as "KNOW", allowing
  * us to only check the wall/danger status of any grid once.  This
  * provides some important optimization, since many "flows" can be
- * done before the "ICKY" and "KNOW" flags must be reset.
+ * done before the "ICKY" and "KNOW" flags must be reset.  The danger
+ * the borg will put up with is the same for every grid, so it is only
+ * worked out once per flow.
  *
  * Note that the "borg_enqueue_grid()" function should refuse to
  * enqueue "dangerous" destination grids, but does not need to set
@@ -252,9 +402,6 @@ void borg_flow_clear(void)
  * and we can stop this function as soon as we find any usable path,
  * since it will always be as short a path as possible.
  *
- * We queue the "children" in reverse order, to allow any "diagonal"
- * neighbors to be processed first, since this may boost efficiency.
- *
  * Note that we should recalculate "danger", and reset all "flows"
  * if we notice that a wall has disappeared, and if one appears, we
  * must give it a maximal cost, and mark it as "icky", in case it
@@ -274,15 +421,16 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
     int stair_idx, bool sneak)
 {
     int  i;
-    int  n, o = 0;
+    int  n;
     int  x1, y1;
     int  x, y;
-    int  fear = 0;
-    int  ii;
-    int  yy, xx;
-    bool bad_sneak = false;
+    int  fear;
     int  origin_y, origin_x;
     bool twitchy = false;
+    bool check_danger;
+
+    /* The edges of the level, which are never flowed into */
+    int  w = cave->width - 1, h = cave->height - 1;
 
     /* Default starting points */
     origin_y = borg.c.y;
@@ -300,48 +448,39 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
         optimize = false;
     }
 
-    /* Now process the queue */
-    while (flow_head != flow_tail) {
-        /* Extract the next entry */
-        x1 = borg_flow_x[flow_tail];
-        y1 = borg_flow_y[flow_tail];
+    /* Only sneak when it is safe to */
+    sneak = sneak && !borg_desperate && !twitchy;
+    if (sneak)
+        memset(flow_sneak, 0, sizeof(borg_data));
 
-        /* Circular queue -- dequeue the next entry */
-        if (++flow_tail == AUTO_FLOW_MAX)
-            flow_tail = 0;
+    /* How much danger to put up with */
+    check_danger = !borg_desperate && !borg.lunal_mode && !borg.munchkin_mode
+                   && !borg_digging;
+    fear = borg_flow_fear(avoidance * 3 / 10);
 
+    /* Now process the queue */
+    while (borg_flow_pop(&y1, &x1)) {
         /* Cost (one per movement grid) */
         n = borg_data_cost->data[y1][x1] + 1;
 
-        /* New depth */
-        if (n > o) {
-            /* Optimize (if requested) */
-            if (optimize && (n > borg_data_cost->data[origin_y][origin_x]))
-                break;
+        /* Optimize (if requested) */
+        if (optimize && (n > borg_data_cost->data[origin_y][origin_x]))
+            break;
 
-            /* Limit depth */
-            if (n > depth)
-                break;
-
-            /* Save */
-            o = n;
-        }
+        /* Limit depth */
+        if (n > depth)
+            break;
 
         /* Queue the "children" */
         for (i = 0; i < 8; i++) {
-            int old_head;
-
             borg_grid *ag;
 
-            /* reset bad_sneak */
-            bad_sneak = false;
-
             /* Neighbor grid */
             x = x1 + ddx_ddd[i];
             y = y1 + ddy_ddd[i];
 
             /* only on legal grids */
-            if (!square_in_bounds_fully(cave, loc(x, y)))
+            if (x < 1 || y < 1 || x >= w || y >= h)
                 continue;
 
             /* Skip "reached" grids */
@@ -351,29 +490,8 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
             /* Access the grid */
             ag = &borg_grids[y][x];
 
-            if (sneak && !borg_desperate && !twitchy) {
-                /* Scan the neighbors */
-                for (ii = 0; ii < 8; ii++) {
-                    /* Neighbor grid */
-                    xx = x + ddx_ddd[ii];
-                    yy = y + ddy_ddd[ii];
-
-                    /* only on legal grids */
-                    if (!square_in_bounds_fully(cave, loc(xx, yy)))
-                        continue;
-
-                    /* Make sure no monster is on this grid, which is
-                     * adjacent to the grid on which, I am thinking about
-                     * stepping.
-                     */
-                    if (borg_grids[yy][xx].kill) {
-                        bad_sneak = true;
-                        break;
-                    }
-                }
-            }
             /* The grid I am thinking about is adjacent to a monster */
-            if (bad_sneak)
+            if (sneak && borg_flow_near_kill(y, x))
                 continue;
 
             /* Avoid "wall" grids (not doors) unless tunneling*/
@@ -450,72 +568,26 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
 
             /* Analyze every grid once */
             if (!borg_data_know->data[y][x]) {
-                int p;
-
                 /* Mark as known */
                 borg_data_know->data[y][x] = true;
 
-                if (!borg_desperate && !borg.lunal_mode && !borg.munchkin_mode
-                    && !borg_digging) {
-                    /* Get the danger */
-                    p = borg_danger(y, x, 1, true, false);
-
-                    /* Increase bravery */
-                    if (borg.trait[BI_MAXCLEVEL] == 50)
-                        fear = avoidance * 5 / 10;
-                    if (borg.trait[BI_MAXCLEVEL] != 50)
-                        fear = avoidance * 3 / 10;
-                    if (scaryguy_on_level)
-                        fear = avoidance * 2;
-                    if (unique_on_level && vault_on_level
-                        && borg.trait[BI_MAXCLEVEL] == 50)
-                        fear = avoidance * 3;
-                    if (scaryguy_on_level && borg.trait[BI_CLEVEL] <= 5)
-                        fear = avoidance * 3;
-                    if (borg.goal.ignoring)
-                        fear = avoidance * 5;
-                    if (borg_t - borg_began > 5000)
-                        fear = avoidance * 25;
-                    if (borg.trait[BI_FOOD] == 0)
-                        fear = avoidance * 100;
-
-                    /* Normal in town */
-                    if (borg.trait[BI_CLEVEL] == 0)
-                        fear = avoidance * 3 / 10;
-
-                    /* Dangerous grid */
-                    if (p > fear) {
-                        /* Mark as icky */
-                        borg_data_icky->data[y][x] = true;
-
-                        /* Ignore this grid */
-                        continue;
-                    }
+                /* Dangerous grid */
+                if (check_danger && borg_danger(y, x, 1, true, false) > fear) {
+                    /* Mark as icky */
+                    borg_data_icky->data[y][x] = true;
+
+                    /* Ignore this grid */
+                    continue;
                 }
             }
 
-            /* Save the flow cost */
-            borg_data_cost->data[y][x] = n;
-
             /* Enqueue that entry */
-            borg_flow_x[flow_head] = x;
-            borg_flow_y[flow_head] = y;
-
-            /* Circular queue -- memorize head */
-            old_head = flow_head;
-
-            /* Circular queue -- insert with wrap */
-            if (++flow_head == AUTO_FLOW_MAX)
-                flow_head = 0;
-
-            /* Circular queue -- handle overflow (badly) */
-            if (flow_head == flow_tail)
-                flow_head = old_head;
+            borg_flow_push(y, x, n);
         }
     }
 
     /* Forget the flow info */
-    flow_head = flow_tail = 0;
+    borg_flow_forget();
 }
 
 /*
@@ -523,8 +595,6 @@ void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunneling,
  */
 void borg_flow_enqueue_grid(int y, int x)
 {
-    int old_head;
-    int fear = 0;
     int p;
 
     /* Avoid icky grids */
@@ -541,31 +611,9 @@ void borg_flow_enqueue_grid(int y, int x)
         /* Get the danger */
         p = borg_danger(y, x, 1, true, false);
 
-        /* Increase bravery */
-        if (borg.trait[BI_MAXCLEVEL] == 50)
-            fear = avoidance * 5 / 10;
-        if (borg.trait[BI_MAXCLEVEL] != 50)
-            fear = avoidance * 3 / 10;
-        if (scaryguy_on_level)
-            fear = avoidance * 2;
-        if (unique_on_level && vault_on_level && borg.trait[BI_MAXCLEVEL] == 50)
-            fear = avoidance * 3;
-        if (scaryguy_on_level && borg.trait[BI_CLEVEL] <= 5)
-            fear = avoidance * 3;
-        if (borg.goal.ignoring)
-            fear = avoidance * 5;
-        if (borg_t - borg_began > 5000)
-            fear = avoidance * 25;
-        if (borg.trait[BI_FOOD] == 0)
-            fear = avoidance * 100;
-
-        /* Normal in town */
-        if (borg.trait[BI_CLEVEL] == 0)
-            fear = avoidance * 3 / 10;
-
         /* Dangerous grid */
-        if ((p > fear) && !borg_desperate && !borg.lunal_mode
-            && !borg.munchkin_mode && !borg_digging) {
+        if ((p > borg_flow_fear(avoidance * 3 / 10)) && !borg_desperate
+            && !borg.lunal_mode && !borg.munchkin_mode && !borg_digging) {
             /* Icky */
             borg_data_icky->data[y][x] = true;
 
@@ -578,23 +626,15 @@ void borg_flow_enqueue_grid(int y, int x)
     if (!borg_data_cost->data[y][x])
         return;
 
-    /* Save the flow cost (zero) */
-    borg_data_cost->data[y][x] = 0;
-
-    /* Enqueue that entry */
-    borg_flow_y[flow_head] = y;
-    borg_flow_x[flow_head] = x;
-
-    /* Circular queue -- memorize head */
-    old_head = flow_head;
-
-    /* Circular queue -- insert with wrap */
-    if (++flow_head == AUTO_FLOW_MAX)
-        flow_head = 0;
+    /* Remember where the flow started */
+    if (borg_flow_n < AUTO_FLOW_MAX) {
+        borg_flow_y[borg_flow_n] = y;
+        borg_flow_x[borg_flow_n] = x;
+        borg_flow_n++;
+    }
 
-    /* Circular queue -- handle overflow */
-    if (flow_head == flow_tail)
-        flow_head = old_head;
+    /* Enqueue that entry (at cost zero) */
+    borg_flow_push(y, x, 0);
 }
 
 /*
@@ -1265,6 +1305,18 @@ void borg_init_flow(void)
     /* Allocate */
     borg_data_icky = mem_zalloc(sizeof(borg_data));
 
+    /* Allocate */
+    flow_sneak = mem_zalloc(sizeof(borg_data));
+
+    /* Nothing is waiting to be spread from */
+    flow_next = mem_zalloc(AUTO_MAX_Y * AUTO_MAX_X * sizeof(int));
+    flow_prev = mem_zalloc(AUTO_MAX_Y * AUTO_MAX_X * sizeof(int));
+    for (x = 0; x < AUTO_MAX_Y * AUTO_MAX_X; x++)
+        flow_prev[x] = FLOW_UNQUEUED;
+    for (x = 0; x < 256; x++)
+        flow_bucket[x] = -1;
+    flow_low = 0;
+
     /* Prepare "borg_data_hard" */
     for (y = 0; y < AUTO_MAX_Y; y++) {
         for (x = 0; x < AUTO_MAX_X; x++) {
@@ -1297,6 +1349,12 @@ void borg_free_flow(void)
     borg_free_track(&track_door);
     borg_free_track(&track_step);
 
+    mem_free(flow_prev);
+    flow_prev = NULL;
+    mem_free(flow_next);
+    flow_next = NULL;
+    mem_free(flow_sneak);
+    flow_sneak = NULL;
     mem_free(borg_data_icky);
     borg_data_icky = NULL;
     mem_free(borg_data_know);
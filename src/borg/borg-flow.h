@@ -65,19 +65,12 @@ struct borg_data {
 #define AUTO_FLOW_MAX 1536
 
 /*
- * Maintain a set of grids (flow calculations)
+ * The grids the current flow started from
  */
 extern int16_t borg_flow_n;
 extern uint8_t borg_flow_y[AUTO_FLOW_MAX];
 extern uint8_t borg_flow_x[AUTO_FLOW_MAX];
 
-/*
- * Use "flow" array as a queue
- */
-
-extern int flow_head;
-extern int flow_tail;
-
 /*
  * Some variables
  */
@@ -143,6 +136,11 @@ extern const int16_t borg_ddy_ddd[24];
  */
 extern bool borg_can_dig(bool check_fail, uint8_t feat);
 
+/*
+ * How much danger the borg will put up with on a grid it flows through
+ */
+extern int borg_flow_fear(int town_fear);
+
 /*
  * Clear the "flow" information
  */
@@ -1535,6 +1535,9 @@ void borg_update(void)
     bool monster_in_vault = false;
     bool created_traps    = false;
 
+    /* The distances to the stairs are about to change */
+    borg_flow_stair_forget();
+
     /*** Process objects/monsters ***/
 
     /* Scan monsters */
@@ -2924,6 +2927,9 @@ void borg_update(void)
         borg_follow_kill(i);
     }
 
+    /* The map and the monsters are up to date */
+    borg_danger_notice_map();
+
     /* Update the fear_grid_monsters[][] with the monsters danger
      * This will provide a 'regional' fear from the accumulated
      * group of monsters.  One Orc won't be too dangerous, but 20
@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "generate.h"
 #include "init.h"
 #include "monster.h"
 #include "mon-predicate.h"
@@ -29,6 +30,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "trap.h"
+#include "z-queue.h"
 
 /**
  * This function takes a grid location and extracts information the
@@ -107,7 +109,7 @@ void map_info(struct loc grid, struct grid_data *g)
 	if (g->in_view) {
 		bool lit = square_islit(cave, grid);
 
-		if (sqinfo_has(square(cave, grid)->info, SQUARE_CLOSE_PLAYER)) {
+		if (sqinfo_has(square_info(cave, grid), SQUARE_CLOSE_PLAYER)) {
 			if (player_has(player, PF_UNLIGHT) &&
 					player->state.cur_light <= 1) {
 				g->lighting = (lit) ?
@@ -281,7 +283,8 @@ static void cave_light(struct point_set *ps)
 	/* Apply flag changes */
 	for (i = 0; i < ps->n; i++)	{
 		/* Perma-Light */
-		sqinfo_on(square(cave, ps->pts[i])->info, SQUARE_GLOW);
+		sqinfo_on(square_info(cave, ps->pts[i]), SQUARE_GLOW);
+		cave_light_changed(cave, ps->pts[i]);
 	}
 
 	/* Process the grids */
@@ -328,7 +331,8 @@ static void cave_unlight(struct point_set *ps)
 
 		/* Darken the grid... */
 		if (!square_isbright(cave, ps->pts[i])) {
-			sqinfo_off(square(cave, ps->pts[i])->info, SQUARE_GLOW);
+			sqinfo_off(square_info(cave, ps->pts[i]), SQUARE_GLOW);
+			cave_light_changed(cave, ps->pts[i]);
 		}
 
 		/* ...but dark-loving characters remember them */
@@ -418,6 +422,9 @@ void wiz_light(struct chunk *c, struct player *p, bool full)
 {
 	int i, y, x;
 
+	/* The permanent light changes everywhere */
+	cave_forget_light(c);
+
 	/* Scan all grids */
 	for (y = 1; y < c->height - 1; y++) {
 		for (x = 1; x < c->width - 1; x++) {
@@ -432,7 +439,7 @@ void wiz_light(struct chunk *c, struct player *p, bool full)
 					struct loc a_grid = loc_sum(grid, ddgrid_ddd[i]);
 
 					/* Perma-light the grid */
-					sqinfo_on(square(c, a_grid)->info, SQUARE_GLOW);
+					sqinfo_on(square_info(c, a_grid), SQUARE_GLOW);
 
 					/* Memorize normal features */
 					if (!square_isfloor(c, a_grid) || 
@@ -489,6 +496,9 @@ void wiz_dark(struct chunk *c, struct player *p, bool full)
 {
 	int i, y, x;
 
+	/* The permanent light changes everywhere */
+	cave_forget_light(c);
+
 	/* Scan all grids */
 	for (y = 1; y < c->height - 1; y++) {
 		for (x = 1; x < c->width - 1; x++) {
@@ -503,7 +513,7 @@ void wiz_dark(struct chunk *c, struct player *p, bool full)
 					struct loc a_grid = loc_sum(grid, ddgrid_ddd[i]);
 
 					/* Perma-darken the grid */
-					sqinfo_off(square(c, a_grid)->info, SQUARE_GLOW);
+					sqinfo_off(square_info(c, a_grid), SQUARE_GLOW);
 
 					/* Memorize normal features */
 					if (!square_isfloor(c, a_grid) || 
@@ -556,6 +566,9 @@ void cave_illuminate(struct chunk *c, bool daytime)
 {
 	int y, x, i;
 
+	/* The permanent light changes everywhere */
+	cave_forget_light(c);
+
 	/* Apply light or darkness */
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
@@ -578,10 +591,10 @@ void cave_illuminate(struct chunk *c, bool daytime)
 
 			/* Only interesting grids at night */
 			if (daytime || !square_isfloor(c, grid)) {
-				sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+				sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 				if(light) square_memorize(c, grid);
 			} else if (!square_isbright(c, grid)) {
-				sqinfo_off(square(c, grid)->info, SQUARE_GLOW);
+				sqinfo_off(square_info(c, grid), SQUARE_GLOW);
 				/* Like cave_unlight(), forget "boring" grids */
 				if (square_isfloor(c, grid))
 					square_forget(c, grid);
@@ -598,7 +611,7 @@ void cave_illuminate(struct chunk *c, bool daytime)
 				continue;
 			for (i = 0; i < 8; i++) {
 				struct loc a_grid = loc_sum(grid, ddgrid_ddd[i]);
-				sqinfo_on(square(c, a_grid)->info, SQUARE_GLOW);
+				sqinfo_on(square_info(c, a_grid), SQUARE_GLOW);
 				square_memorize(c, a_grid);
 			}
 		}
@@ -621,10 +634,11 @@ void cave_illuminate(struct chunk *c, bool daytime)
 void expose_to_sun(struct chunk *c, struct loc grid, bool daytime)
 {
 	if (daytime || !square_isfloor(c, grid)) {
-		sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+		sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 	} else if (!square_isbright(c, grid)) {
-		sqinfo_off(square(c, grid)->info, SQUARE_GLOW);
+		sqinfo_off(square_info(c, grid), SQUARE_GLOW);
 	}
+	cave_light_changed(c, grid);
 }
 
 /**
@@ -652,8 +666,212 @@ void cave_known(struct player *p)
 
 			/* Internal walls not known */
 			if (count < 8) {
+				int old_feat = p->cave->squares[y][x].feat;
+
 				p->cave->squares[y][x].feat = square(cave, grid)->feat;
+				cave_terrain_changed(p->cave, grid, old_feat);
 			}
 		}
 	}
 }
+
+/**
+ * Get the propagation queue for a chunk's noise field, allocating it the
+ * first time it is needed.  It is large enough to hold every grid once.
+ */
+static struct queue *flow_queue(struct chunk *c)
+{
+	if (!c->flow.queue) {
+		c->flow.queue = q_new(c->height * c->width);
+	}
+	return c->flow.queue;
+}
+
+/**
+ * Is the grid a source or recipient of noise in the current field?
+ */
+static bool flow_reached(struct chunk *c, struct loc grid)
+{
+	return loc_eq(grid, c->flow.centre) || c->noise.grids[grid.y][grid.x];
+}
+
+/**
+ * Spread noise outwards from the grids in the flow queue, giving each grid
+ * that is silent, or louder than it should be, the noise of its neighbour
+ * plus the step.  Grids are popped in order of increasing noise, so each
+ * is given its final value the first time it is reached.
+ */
+static void flow_spread(struct chunk *c)
+{
+	struct queue *queue = c->flow.queue;
+
+	while (q_len(queue) > 0) {
+		struct loc next;
+		int d, noise;
+
+		i_to_grid(q_pop_int(queue), c->width, &next);
+		noise = c->noise.grids[next.y][next.x] + c->flow.step;
+
+		for (d = 0; d < 8; d++) {
+			struct loc grid = loc_sum(next, ddgrid_ddd[d]);
+			uint16_t *old;
+
+			if (!square_in_bounds(c, grid)) continue;
+
+			/* Ignore features that don't transmit sound */
+			if (square_isnoflow(c, grid)) continue;
+
+			/* Skip the centre */
+			if (loc_eq(c->flow.centre, grid)) continue;
+
+			/* Skip grids that are already at least this quiet */
+			old = &c->noise.grids[grid.y][grid.x];
+			if (*old != 0 && *old <= noise) continue;
+
+			/* Save the noise and pass it on */
+			*old = noise;
+			q_push_int(queue, grid_to_i(grid, c->width));
+		}
+	}
+}
+
+/**
+ * Mark a grid which has just started carrying sound.  The noise field can
+ * only get quieter, and only by way of that grid, so it is enough to spread
+ * noise outwards from there.
+ */
+static void flow_repair_opened(struct chunk *c, struct loc grid)
+{
+	int d, best = 0;
+
+	/* The centre never changes; other grids take their loudest neighbour */
+	if (loc_eq(grid, c->flow.centre)) return;
+	if (square_isnoflow(c, grid)) return;
+	for (d = 0; d < 8; d++) {
+		struct loc adj = loc_sum(grid, ddgrid_ddd[d]);
+		int noise;
+
+		if (!square_in_bounds(c, adj) || !flow_reached(c, adj)) continue;
+		noise = c->noise.grids[adj.y][adj.x] + c->flow.step;
+		if (!best || noise < best) best = noise;
+	}
+
+	/* Nothing changes unless the grid is now closer to the centre */
+	if (!best) return;
+	if (c->noise.grids[grid.y][grid.x] &&
+		c->noise.grids[grid.y][grid.x] <= best) return;
+	c->noise.grids[grid.y][grid.x] = best;
+	q_push_int(flow_queue(c), grid_to_i(grid, c->width));
+	flow_spread(c);
+}
+
+/**
+ * Bring the noise field of a chunk up to date for noise made at centre.
+ *
+ * The noise at each grid is the number of steps needed to reach it from the
+ * centre, travelling only through grids that carry sound, times step.  The
+ * centre and grids that can't be reached have zero noise.
+ *
+ * Nothing is done if the centre, step and sound-carrying terrain are as they
+ * were for the last update.  Grids which have opened up since then are dealt
+ * with by spreading noise from them alone.  Anything else - the centre moving,
+ * the step changing, or grids being blocked - needs the field to be rebuilt.
+ */
+void cave_update_flow(struct chunk *c, struct loc centre, int step)
+{
+	struct flow_state *flow = &c->flow;
+	int y, i;
+
+	if (flow->valid && loc_eq(flow->centre, centre) && flow->step == step) {
+		for (i = 0; i < flow->n_opened; i++) {
+			flow_repair_opened(c, flow->opened[i]);
+		}
+		flow->n_opened = 0;
+		return;
+	}
+
+	/* Set all the grids to silence */
+	for (y = 1; y < c->height - 1; y++) {
+		memset(c->noise.grids[y] + 1, 0,
+			(c->width - 2) * sizeof(c->noise.grids[y][0]));
+	}
+
+	/* Propagate noise from the centre */
+	flow->centre = centre;
+	flow->step = step;
+	flow->n_opened = 0;
+	flow->valid = true;
+	c->noise.grids[centre.y][centre.x] = 0;
+	q_push_int(flow_queue(c), grid_to_i(centre, c->width));
+	flow_spread(c);
+}
+
+/**
+ * Force the next noise update for a chunk to rebuild the whole field
+ */
+void cave_forget_flow(struct chunk *c)
+{
+	c->flow.valid = false;
+	c->flow.n_opened = 0;
+}
+
+/**
+ * Note that a grid has changed whether or not it carries sound
+ */
+void cave_flow_terrain_changed(struct chunk *c, struct loc grid, bool blocked)
+{
+	if (!c->flow.valid) return;
+
+	/* Blocking a grid can make anywhere louder, so start again */
+	if (blocked || c->flow.n_opened == FLOW_OPENED_MAX) {
+		cave_forget_flow(c);
+		return;
+	}
+
+	c->flow.opened[c->flow.n_opened++] = grid;
+}
+
+/**
+ * Get the age of the player's scent at a grid; zero means no scent
+ */
+int cave_scent_age(struct chunk *c, struct loc grid)
+{
+	uint16_t laid = c->scent.grids[grid.y][grid.x];
+
+	return laid ? (uint16_t) (c->scent_turn - laid) : 0;
+}
+
+/**
+ * Lay scent of the given age at a grid; zero removes any scent
+ */
+void cave_lay_scent(struct chunk *c, struct loc grid, int age)
+{
+	c->scent.grids[grid.y][grid.x] = age ? c->scent_turn - age : 0;
+}
+
+/**
+ * Age all the scent in a chunk by one.
+ *
+ * As scent remembers when it was laid, this only has to advance the clock.
+ * In the rare case that the clock runs out, every grid is rebased onto a
+ * fresh clock, and scent too old for any monster to notice is dropped.
+ */
+void cave_age_scent(struct chunk *c)
+{
+	int y, x;
+
+	if (c->scent_turn < 0xffff) {
+		c->scent_turn++;
+		return;
+	}
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			int age = cave_scent_age(c, loc(x, y));
+
+			c->scent.grids[y][x] = (age && age < SCENT_AGE_MAX) ?
+				SCENT_AGE_MAX + SCENT_TURN_MIN - age : 0;
+		}
+	}
+	c->scent_turn = SCENT_AGE_MAX + SCENT_TURN_MIN + 1;
+}
@@ -423,7 +423,7 @@ bool square_ismemorybad(struct chunk *c, struct loc grid) {
  */
 bool square_ismark(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_MARK);
+	return sqinfo_has(square_info(c, grid), SQUARE_MARK);
 }
 
 /**
@@ -431,7 +431,7 @@ bool square_ismark(struct chunk *c, struct loc grid) {
  */
 bool square_isglow(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_GLOW);
+	return sqinfo_has(square_info(c, grid), SQUARE_GLOW);
 }
 
 /**
@@ -441,7 +441,7 @@ bool square_isglow(struct chunk *c, struct loc grid) {
  */
 bool square_isvault(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_VAULT);
+	return sqinfo_has(square_info(c, grid), SQUARE_VAULT);
 }
 
 /**
@@ -449,7 +449,7 @@ bool square_isvault(struct chunk *c, struct loc grid) {
  */
 bool square_isroom(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_ROOM);
+	return sqinfo_has(square_info(c, grid), SQUARE_ROOM);
 }
 
 /**
@@ -457,7 +457,7 @@ bool square_isroom(struct chunk *c, struct loc grid) {
  */
 bool square_isseen(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_SEEN);
+	return sqinfo_has(square_info(c, grid), SQUARE_SEEN);
 }
 
 /**
@@ -465,7 +465,7 @@ bool square_isseen(struct chunk *c, struct loc grid) {
  */
 bool square_isview(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_VIEW);
+	return sqinfo_has(square_info(c, grid), SQUARE_VIEW);
 }
 
 /**
@@ -473,7 +473,7 @@ bool square_isview(struct chunk *c, struct loc grid) {
  */
 bool square_wasseen(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_WASSEEN);
+	return sqinfo_has(square_info(c, grid), SQUARE_WASSEEN);
 }
 
 /**
@@ -481,7 +481,7 @@ bool square_wasseen(struct chunk *c, struct loc grid) {
  */
 bool square_isfeel(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_FEEL);
+	return sqinfo_has(square_info(c, grid), SQUARE_FEEL);
 }
 
 /**
@@ -489,7 +489,7 @@ bool square_isfeel(struct chunk *c, struct loc grid) {
  */
 bool square_istrap(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_TRAP);
+	return sqinfo_has(square_info(c, grid), SQUARE_TRAP);
 }
 
 /**
@@ -497,7 +497,7 @@ bool square_istrap(struct chunk *c, struct loc grid) {
  */
 bool square_isinvis(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_INVIS);
+	return sqinfo_has(square_info(c, grid), SQUARE_INVIS);
 }
 
 /**
@@ -505,7 +505,7 @@ bool square_isinvis(struct chunk *c, struct loc grid) {
  */
 bool square_iswall_inner(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_WALL_INNER);
+	return sqinfo_has(square_info(c, grid), SQUARE_WALL_INNER);
 }
 
 /**
@@ -513,7 +513,7 @@ bool square_iswall_inner(struct chunk *c, struct loc grid) {
  */
 bool square_iswall_outer(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_WALL_OUTER);
+	return sqinfo_has(square_info(c, grid), SQUARE_WALL_OUTER);
 }
 
 /**
@@ -521,7 +521,7 @@ bool square_iswall_outer(struct chunk *c, struct loc grid) {
  */
 bool square_iswall_solid(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_WALL_SOLID);
+	return sqinfo_has(square_info(c, grid), SQUARE_WALL_SOLID);
 }
 
 /**
@@ -529,7 +529,7 @@ bool square_iswall_solid(struct chunk *c, struct loc grid) {
  */
 bool square_ismon_restrict(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_MON_RESTRICT);
+	return sqinfo_has(square_info(c, grid), SQUARE_MON_RESTRICT);
 }
 
 /**
@@ -537,7 +537,7 @@ bool square_ismon_restrict(struct chunk *c, struct loc grid) {
  */
 bool square_isno_teleport(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_NO_TELEPORT);
+	return sqinfo_has(square_info(c, grid), SQUARE_NO_TELEPORT);
 }
 
 /**
@@ -545,7 +545,7 @@ bool square_isno_teleport(struct chunk *c, struct loc grid) {
  */
 bool square_isno_map(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_NO_MAP);
+	return sqinfo_has(square_info(c, grid), SQUARE_NO_MAP);
 }
 
 /**
@@ -553,7 +553,7 @@ bool square_isno_map(struct chunk *c, struct loc grid) {
  */
 bool square_isno_esp(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_NO_ESP);
+	return sqinfo_has(square_info(c, grid), SQUARE_NO_ESP);
 }
 
 /**
@@ -561,7 +561,7 @@ bool square_isno_esp(struct chunk *c, struct loc grid) {
  */
 bool square_isproject(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_PROJECT);
+	return sqinfo_has(square_info(c, grid), SQUARE_PROJECT);
 }
 
 /**
@@ -569,7 +569,7 @@ bool square_isproject(struct chunk *c, struct loc grid) {
  */
 bool square_isdtrap(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_DTRAP);
+	return sqinfo_has(square_info(c, grid), SQUARE_DTRAP);
 }
 
 /**
@@ -577,7 +577,7 @@ bool square_isdtrap(struct chunk *c, struct loc grid) {
  */
 bool square_isno_stairs(struct chunk *c, struct loc grid) {
 	assert(square_in_bounds(c, grid));
-	return sqinfo_has(square(c, grid)->info, SQUARE_NO_STAIRS);
+	return sqinfo_has(square_info(c, grid), SQUARE_NO_STAIRS);
 }
 
 
@@ -975,7 +975,16 @@ struct feature *square_feat(struct chunk *c, struct loc grid)
 int square_light(struct chunk *c, struct loc grid)
 {
 	assert(square_in_bounds(c, grid));
-	return square(c, grid)->light;
+	return c->light[grid.y * c->width + grid.x];
+}
+
+/**
+ * The SQUARE_* flags of a grid, which are kept for the whole chunk in c->info
+ */
+bitflag *square_info(struct chunk *c, struct loc grid)
+{
+	assert(square_in_bounds(c, grid));
+	return c->info + (grid.y * c->width + grid.x) * SQUARE_SIZE;
 }
 
 /**
@@ -1246,12 +1255,21 @@ void square_set_feat(struct chunk *c, struct loc grid, int feat)
 
 	/* Make the change */
 	c->squares[grid.y][grid.x].feat = feat;
+	cave_terrain_changed(c, grid, current_feat);
+
+	/* Keep the noise field in step with the sound-carrying terrain */
+	if (feat_is_no_flow(current_feat) != feat_is_no_flow(feat)) {
+		cave_flow_terrain_changed(c, grid, feat_is_no_flow(feat));
+	}
 
 	/* Light bright terrain */
 	if (feat_is_bright(feat)) {
-		sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+		sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 	}
 
+	/* Light near the grid may have changed */
+	cave_light_changed(c, grid);
+
 	/* Make the new terrain feel at home */
 	if (character_dungeon) {
 		/* Remove traps if necessary */
@@ -1262,9 +1280,9 @@ void square_set_feat(struct chunk *c, struct loc grid, int feat)
 		square_light_spot(c, grid);
 	} else {
 		/* Make sure no incorrect wall flags set for dungeon generation */
-		sqinfo_off(square(c, grid)->info, SQUARE_WALL_INNER);
-		sqinfo_off(square(c, grid)->info, SQUARE_WALL_OUTER);
-		sqinfo_off(square(c, grid)->info, SQUARE_WALL_SOLID);
+		sqinfo_off(square_info(c, grid), SQUARE_WALL_INNER);
+		sqinfo_off(square_info(c, grid), SQUARE_WALL_OUTER);
+		sqinfo_off(square_info(c, grid), SQUARE_WALL_SOLID);
 	}
 }
 
@@ -1273,8 +1291,12 @@ void square_set_feat(struct chunk *c, struct loc grid, int feat)
  */
 static void square_set_known_feat(struct chunk *c, struct loc grid, int feat)
 {
+	int old_feat;
+
 	if (c != cave) return;
+	old_feat = player->cave->squares[grid.y][grid.x].feat;
 	player->cave->squares[grid.y][grid.x].feat = feat;
+	cave_terrain_changed(player->cave, grid, old_feat);
 }
 
 /**
@@ -1282,7 +1304,10 @@ static void square_set_known_feat(struct chunk *c, struct loc grid, int feat)
  */
 void square_set_mon(struct chunk *c, struct loc grid, int midx)
 {
+	int old_midx = c->squares[grid.y][grid.x].mon;
+
 	c->squares[grid.y][grid.x].mon = midx;
+	cave_monster_changed(c, grid, old_midx);
 }
 
 /**
@@ -1583,9 +1608,9 @@ void square_forget(struct chunk *c, struct loc grid) {
 }
 
 void square_mark(struct chunk *c, struct loc grid) {
-	sqinfo_on(square(c, grid)->info, SQUARE_MARK);
+	sqinfo_on(square_info(c, grid), SQUARE_MARK);
 }
 
 void square_unmark(struct chunk *c, struct loc grid) {
-	sqinfo_off(square(c, grid)->info, SQUARE_MARK);
+	sqinfo_off(square_info(c, grid), SQUARE_MARK);
 }
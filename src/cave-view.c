@@ -25,6 +25,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "trap.h"
+#include "z-prof.h"
 
 /**
  * Approximate distance between two points.
@@ -47,42 +48,13 @@ int distance(struct loc grid1, struct loc grid2)
 
 
 /**
- * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
- * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
- *
- * This function returns true if a "line of sight" can be traced from the
- * center of the grid (x1,y1) to the center of the grid (x2,y2), with all
- * of the grids along this path (except for the endpoints) being non-wall
- * grids.  Actually, the "chess knight move" situation is handled by some
- * special case code which allows the grid diagonally next to the player
- * to be obstructed, because this yields better gameplay semantics.  This
- * algorithm is totally reflexive, except for "knight move" situations.
- *
- * Because this function uses (short) ints for all calculations, overflow
- * may occur if dx and dy exceed 90.
- *
- * Once all the degenerate cases are eliminated, we determine the "slope"
- * ("m"), and we use special "fixed point" mathematics in which we use a
- * special "fractional component" for one of the two location components
- * ("qy" or "qx"), which, along with the slope itself, are "scaled" by a
- * scale factor equal to "abs(dy*dx*2)" to keep the math simple.  Then we
- * simply travel from start to finish along the longer axis, starting at
- * the border between the first and second tiles (where the y offset is
- * thus half the slope), using slope and the fractional component to see
- * when motion along the shorter axis is necessary.  Since we assume that
- * vision is not blocked by "brushing" the corner of any grid, we must do
- * some special checks to avoid testing grids which are "brushed" but not
- * actually "entered".
- *
- * Angband three different "line of sight" type concepts, including this
- * function (which is used almost nowhere), the "project()" method (which
- * is used for determining the paths of projectables and spells and such),
- * and the "update_view()" concept (which is used to determine which grids
- * are "viewable" by the player, which is used for many things, such as
- * determining which grids are illuminated by the player's torch, and which
- * grids and monsters can be "seen" by the player, etc).
+ * Walk the line of sight from grid1 to grid2 for los(), calling clear() on
+ * each grid that could block it and stopping at the first that does.  This
+ * handles everything except adjacent grids and the "knight's move" cases.
  */
-bool los(struct chunk *c, struct loc grid1, struct loc grid2)
+static bool los_walk(struct chunk *c, struct loc grid1, struct loc grid2,
+		bool (*clear)(struct chunk *c, struct loc grid, void *data),
+		void *data)
 {
 	/* Delta */
 	int dx, dy;
@@ -113,18 +85,15 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	ay = ABS(dy);
 	ax = ABS(dx);
 
-	/* Handle adjacent (or identical) grids */
-	if ((ax < 2) && (ay < 2)) return (true);
-
 	/* Directly South/North */
 	if (!dx) {
 		/* South -- check for walls */
 		if (dy > 0) {
 			for (ty = grid1.y + 1; ty < grid2.y; ty++)
-				if (!square_isprojectable(c, loc(grid1.x, ty))) return (false);
+				if (!clear(c, loc(grid1.x, ty), data)) return (false);
 		} else { /* North -- check for walls */
 			for (ty = grid1.y - 1; ty > grid2.y; ty--)
-				if (!square_isprojectable(c, loc(grid1.x, ty))) return (false);
+				if (!clear(c, loc(grid1.x, ty), data)) return (false);
 		}
 
 		/* Assume los */
@@ -136,10 +105,10 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 		/* East -- check for walls */
 		if (dx > 0) {
 			for (tx = grid1.x + 1; tx < grid2.x; tx++)
-				if (!square_isprojectable(c, loc(tx, grid1.y))) return (false);
+				if (!clear(c, loc(tx, grid1.y), data)) return (false);
 		} else { /* West -- check for walls */
 			for (tx = grid1.x - 1; tx > grid2.x; tx--)
-				if (!square_isprojectable(c, loc(tx, grid1.y))) return (false);
+				if (!clear(c, loc(tx, grid1.y), data)) return (false);
 		}
 
 		/* Assume los */
@@ -151,15 +120,6 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	sx = (dx < 0) ? -1 : 1;
 	sy = (dy < 0) ? -1 : 1;
 
-	/* Vertical and horizontal "knights" */
-	if ((ax == 1) && (ay == 2) &&
-		square_isprojectable(c, loc(grid1.x, grid1.y + sy))) {
-		return (true);
-	} else if ((ay == 1) && (ax == 2) &&
-			   square_isprojectable(c, loc(grid1.x + sx, grid1.y))) {
-		return (true);
-	}
-
 	/* Calculate scale factor div 2 */
 	f2 = (ax * ay);
 
@@ -186,7 +146,7 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 		/* Note (below) the case (qy == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (grid2.x - tx) {
-			if (!square_isprojectable(c, loc(tx, ty)))
+			if (!clear(c, loc(tx, ty), data))
 				return (false);
 
 			qy += m;
@@ -195,7 +155,7 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 				tx += sx;
 			} else if (qy > f2) {
 				ty += sy;
-				if (!square_isprojectable(c, loc(tx, ty)))
+				if (!clear(c, loc(tx, ty), data))
 					return (false);
 				qy -= f1;
 				tx += sx;
@@ -222,7 +182,7 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 		/* Note (below) the case (qx == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (grid2.y - ty) {
-			if (!square_isprojectable(c, loc(tx, ty)))
+			if (!clear(c, loc(tx, ty), data))
 				return (false);
 
 			qx += m;
@@ -231,7 +191,7 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 				ty += sy;
 			} else if (qx > f2) {
 				tx += sx;
-				if (!square_isprojectable(c, loc(tx, ty)))
+				if (!clear(c, loc(tx, ty), data))
 					return (false);
 				qx -= f1;
 				ty += sy;
@@ -247,6 +207,71 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	return (true);
 }
 
+/**
+ * Help los():  whether a grid along the line of sight lets it through.
+ */
+static bool los_clear(struct chunk *c, struct loc grid, void *data)
+{
+	return square_isprojectable(c, grid);
+}
+
+/**
+ * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
+ * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
+ *
+ * This function returns true if a "line of sight" can be traced from the
+ * center of the grid (x1,y1) to the center of the grid (x2,y2), with all
+ * of the grids along this path (except for the endpoints) being non-wall
+ * grids.  Actually, the "chess knight move" situation is handled by some
+ * special case code which allows the grid diagonally next to the player
+ * to be obstructed, because this yields better gameplay semantics.  This
+ * algorithm is totally reflexive, except for "knight move" situations.
+ *
+ * Because this function uses (short) ints for all calculations, overflow
+ * may occur if dx and dy exceed 90.
+ *
+ * Once all the degenerate cases are eliminated, we determine the "slope"
+ * ("m"), and we use special "fixed point" mathematics in which we use a
+ * special "fractional component" for one of the two location components
+ * ("qy" or "qx"), which, along with the slope itself, are "scaled" by a
+ * scale factor equal to "abs(dy*dx*2)" to keep the math simple.  Then we
+ * simply travel from start to finish along the longer axis, starting at
+ * the border between the first and second tiles (where the y offset is
+ * thus half the slope), using slope and the fractional component to see
+ * when motion along the shorter axis is necessary.  Since we assume that
+ * vision is not blocked by "brushing" the corner of any grid, we must do
+ * some special checks to avoid testing grids which are "brushed" but not
+ * actually "entered".
+ *
+ * Angband three different "line of sight" type concepts, including this
+ * function (which is used almost nowhere), the "project()" method (which
+ * is used for determining the paths of projectables and spells and such),
+ * and the "update_view()" concept (which is used to determine which grids
+ * are "viewable" by the player, which is used for many things, such as
+ * determining which grids are illuminated by the player's torch, and which
+ * grids and monsters can be "seen" by the player, etc).
+ */
+bool los(struct chunk *c, struct loc grid1, struct loc grid2)
+{
+	int dx = grid2.x - grid1.x, dy = grid2.y - grid1.y;
+	int ax = ABS(dx), ay = ABS(dy);
+	int sx = (dx < 0) ? -1 : 1, sy = (dy < 0) ? -1 : 1;
+
+	/* Handle adjacent (or identical) grids */
+	if ((ax < 2) && (ay < 2)) return (true);
+
+	/* Vertical and horizontal "knights" */
+	if ((ax == 1) && (ay == 2) &&
+		square_isprojectable(c, loc(grid1.x, grid1.y + sy))) {
+		return (true);
+	} else if ((ay == 1) && (ax == 2) &&
+			   square_isprojectable(c, loc(grid1.x + sx, grid1.y))) {
+		return (true);
+	}
+
+	return los_walk(c, grid1, grid2, los_clear, NULL);
+}
+
 /**
  * The comments below are still predominantly true, and have been left
  * (slightly modified for accuracy) for historical and nostalgic reasons.
@@ -429,21 +454,168 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
  */
 
 
+/**
+ * Sight lines used by update_view().  For each offset from the player within
+ * radius grids in each direction, these are the offsets of the grids that
+ * los() would test, in the order it tests them, so the view can be worked
+ * out without redoing the line arithmetic for every grid every time.
+ */
+static struct {
+	int radius;
+	int *first;			/* Start of each offset's line in path */
+	struct loc *path;
+} sight_lines;
+
+/**
+ * Help sight_lines_init():  record a grid on a line of sight
+ */
+static bool sight_line_record(struct chunk *c, struct loc grid, void *data)
+{
+	int *n = data;
+
+	if (sight_lines.path) sight_lines.path[*n] = grid;
+	(*n)++;
+	return true;
+}
+
+/**
+ * Set up the sight lines for a given radius; this is done in two passes, one
+ * to count the grids and one to record them
+ */
+static void sight_lines_init(int radius)
+{
+	int side = 2 * radius + 1, pass, i;
+
+	mem_free(sight_lines.first);
+	mem_free(sight_lines.path);
+	sight_lines.path = NULL;
+	sight_lines.first = mem_zalloc((side * side + 1) * sizeof(int));
+	sight_lines.radius = radius;
+	for (pass = 0; pass < 2; pass++) {
+		int n = 0;
+
+		for (i = 0; i < side * side; i++) {
+			struct loc grid = loc(i % side - radius, i / side - radius);
+
+			sight_lines.first[i] = n;
+			(void) los_walk(NULL, loc(0, 0), grid, sight_line_record, &n);
+		}
+		sight_lines.first[i] = n;
+		if (!pass) sight_lines.path = mem_zalloc(n * sizeof(struct loc));
+	}
+}
+
+static void sight_lines_cleanup(void)
+{
+	mem_free(sight_lines.first);
+	mem_free(sight_lines.path);
+	sight_lines.first = NULL;
+	sight_lines.path = NULL;
+	sight_lines.radius = 0;
+}
+
+static void view_init(void)
+{
+	sight_lines_init(z_info->max_sight);
+}
+
+struct init_module view_module = {
+	.name = "view",
+	.init = view_init,
+	.cleanup = sight_lines_cleanup
+};
+
+/**
+ * Get the grids los() would test, in order, going from a grid to the one at
+ * offset from it; adjacent grids and "knight's moves" are left to the caller,
+ * as los() handles them specially.  Return the number of grids, or -1 if the
+ * offset is beyond the sight lines.
+ */
+int sight_line(struct loc offset, const struct loc **path)
+{
+	int r = sight_lines.radius, i;
+
+	if (!sight_lines.first || ABS(offset.x) > r || ABS(offset.y) > r)
+		return -1;
+	i = (offset.y + r) * (2 * r + 1) + offset.x + r;
+	*path = sight_lines.path + sight_lines.first[i];
+	return sight_lines.first[i + 1] - sight_lines.first[i];
+}
+
+/**
+ * Equivalent to los(c, p->grid, grid) for grids within the sight lines'
+ * radius of the player
+ */
+static bool view_los(struct chunk *c, struct player *p, struct loc grid)
+{
+	int dx = grid.x - p->grid.x, dy = grid.y - p->grid.y;
+	int ax = ABS(dx), ay = ABS(dy);
+	int side = 2 * sight_lines.radius + 1;
+	int i = (dy + sight_lines.radius) * side + dx + sight_lines.radius, j;
+
+	/* Handle adjacent grids and "knights" as los() does */
+	if ((ax < 2) && (ay < 2)) return true;
+	if ((ax == 1) && (ay == 2) && square_isprojectable(c,
+			loc(p->grid.x, p->grid.y + ((dy < 0) ? -1 : 1)))) {
+		return true;
+	} else if ((ay == 1) && (ax == 2) && square_isprojectable(c,
+			loc(p->grid.x + ((dx < 0) ? -1 : 1), p->grid.y))) {
+		return true;
+	}
+
+	for (j = sight_lines.first[i]; j < sight_lines.first[i + 1]; j++) {
+		if (!square_isprojectable(c, loc_sum(p->grid, sight_lines.path[j])))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Get the grids which can be in view of the player when at centre; this is
+ * the whole chunk when centre is not given
+ */
+static void view_bounds(struct chunk *c, const struct loc *centre,
+		struct loc *top_left, struct loc *bottom_right)
+{
+	if (centre) {
+		int r = z_info->max_sight;
+
+		top_left->x = MAX(centre->x - r, 0);
+		top_left->y = MAX(centre->y - r, 0);
+		bottom_right->x = MIN(centre->x + r, c->width - 1);
+		bottom_right->y = MIN(centre->y + r, c->height - 1);
+	} else {
+		*top_left = loc(0, 0);
+		*bottom_right = loc(c->width - 1, c->height - 1);
+	}
+}
+
 /**
  * Mark the currently seen grids, then wipe in preparation for recalculating
  */
-static void mark_wasseen(struct chunk *c)
+static void mark_wasseen(struct chunk *c, struct loc top_left,
+		struct loc bottom_right)
 {
+	bitflag clear[SQUARE_SIZE];
+	int seen = FLAG_OFFSET(SQUARE_SEEN), wasseen = FLAG_OFFSET(SQUARE_WASSEEN);
 	int x, y;
-	/* Save the old "view" grids for later */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
-			struct loc grid = loc(x, y);
-			if (square_isseen(c, grid))
-				sqinfo_on(square(c, grid)->info, SQUARE_WASSEEN);
-			sqinfo_off(square(c, grid)->info, SQUARE_VIEW);
-			sqinfo_off(square(c, grid)->info, SQUARE_SEEN);
-			sqinfo_off(square(c, grid)->info, SQUARE_CLOSE_PLAYER);
+	size_t n;
+
+	sqinfo_wipe(clear);
+	sqinfo_on(clear, SQUARE_VIEW);
+	sqinfo_on(clear, SQUARE_SEEN);
+	sqinfo_on(clear, SQUARE_CLOSE_PLAYER);
+
+	/* Save the old "view" grids for later, working along the flag rows */
+	for (y = top_left.y; y <= bottom_right.y; y++) {
+		bitflag *info = c->info + (y * c->width + top_left.x) * SQUARE_SIZE;
+
+		for (x = top_left.x; x <= bottom_right.x; x++) {
+			if (info[seen] & FLAG_BINARY(SQUARE_SEEN))
+				info[wasseen] |= FLAG_BINARY(SQUARE_WASSEEN);
+			for (n = 0; n < SQUARE_SIZE; n++)
+				info[n] &= ~clear[n];
+			info += SQUARE_SIZE;
 		}
 	}
 }
@@ -605,22 +777,26 @@ static bool glow_can_light_wall(struct chunk *c, struct player *p,
  * Help calc_lighting():  add in the effect of a light source.
  * \param c Is the chunk to use.
  * \param p Is the player to use.
- * \param sgrid Is the location of the light source.
- * \param radius Is the radius, in grids, of the light source.
- * \param inten Is the intensity of the light source.
+ * \param src Is the light source.
+ * \param tl Is the top left corner of the grids to light.
+ * \param br Is the bottom right corner of the grids to light.
  * This is a brute force approach.  Some computation probably could be saved by
  * propagating the light out from the source and terminating paths when they
  * reach a wall.
  */
-static void add_light(struct chunk *c, struct player *p, struct loc sgrid,
-		int radius, int inten)
+static void add_light(struct chunk *c, struct player *p,
+		const struct light_source *src, struct loc tl, struct loc br)
 {
-	int y;
+	struct loc sgrid = src->grid;
+	int radius = src->radius, inten = src->inten;
+	int y, top = MAX(-radius, tl.y - sgrid.y);
+	int bottom = MIN(radius, br.y - sgrid.y);
 
-	for (y = -radius; y <= radius; y++) {
-		int x;
+	for (y = top; y <= bottom; y++) {
+		int x, left = MAX(-radius, tl.x - sgrid.x);
+		int right = MIN(radius, br.x - sgrid.x);
 
-		for (x = -radius; x <= radius; x++) {
+		for (x = left; x <= right; x++) {
 			struct loc grid = loc_sum(sgrid, loc(x, y));
 			int dist = distance(sgrid, grid);
 			if (!square_in_bounds(c, grid)) continue;
@@ -636,11 +812,11 @@ static void add_light(struct chunk *c, struct player *p, struct loc sgrid,
 			/* Adjust the light level */
 			if (inten > 0) {
 				/* Light getting less further away */
-				c->squares[grid.y][grid.x].light +=
+				c->light[grid.y * c->width + grid.x] +=
 					inten - dist;
 			} else {
 				/* Light getting greater further away */
-				c->squares[grid.y][grid.x].light +=
+				c->light[grid.y * c->width + grid.x] +=
 					inten + dist;
 			}
 		}
@@ -648,55 +824,178 @@ static void add_light(struct chunk *c, struct player *p, struct loc sgrid,
 }
 
 /**
- * Calculate light level for every grid in view - stolen from Sil
+ * Most separate areas calc_lighting() will relight before it gives up and
+ * relights the whole level
  */
-static void calc_lighting(struct chunk *c, struct player *p)
+#define RELIGHT_AREAS_MAX 64
+
+/**
+ * The areas of a level which need relighting
+ */
+struct relight {
+	bool all;
+	int n;
+	struct loc tl[RELIGHT_AREAS_MAX];
+	struct loc br[RELIGHT_AREAS_MAX];
+};
+
+/**
+ * Help calc_lighting():  add the rectangle from tl to br, clipped to the
+ * level, to the areas to relight.
+ */
+static void relight_add(struct chunk *c, struct relight *r, struct loc tl,
+		struct loc br)
+{
+	int i;
+
+	tl.x = MAX(tl.x, 0);
+	tl.y = MAX(tl.y, 0);
+	br.x = MIN(br.x, c->width - 1);
+	br.y = MIN(br.y, c->height - 1);
+	if (r->all || tl.x > br.x || tl.y > br.y) return;
+
+	/* Skip areas that are already covered */
+	for (i = 0; i < r->n; i++) {
+		if (tl.x >= r->tl[i].x && tl.y >= r->tl[i].y &&
+				br.x <= r->br[i].x && br.y <= r->br[i].y) return;
+	}
+	if (r->n == RELIGHT_AREAS_MAX) {
+		r->all = true;
+		return;
+	}
+	r->tl[r->n] = tl;
+	r->br[r->n] = br;
+	r->n++;
+}
+
+/**
+ * Help calc_lighting():  add the grids a light source reaches to the areas
+ * to relight.
+ */
+static void relight_add_source(struct chunk *c, struct relight *r,
+		const struct light_source *src)
+{
+	struct loc reach = loc(src->radius, src->radius);
+
+	if (!src->inten) return;
+	relight_add(c, r, loc_diff(src->grid, reach), loc_sum(src->grid, reach));
+}
+
+/**
+ * Help calc_lighting():  check whether a light source reaches any grid of a
+ * rectangle.
+ */
+static bool source_reaches(const struct light_source *src, struct loc tl,
+		struct loc br)
+{
+	return src->inten && src->grid.x + src->radius >= tl.x &&
+		src->grid.x - src->radius <= br.x &&
+		src->grid.y + src->radius >= tl.y &&
+		src->grid.y - src->radius <= br.y;
+}
+
+/**
+ * Help calc_lighting():  work out the light levels from scratch for the
+ * grids from tl to br.
+ */
+static void relight_area(struct chunk *c, struct player *p, struct loc tl,
+		struct loc br)
 {
+	struct light_state *state = &c->lighting;
 	int dir, k, x, y;
-	int light = p->state.cur_light, radius = ABS(light) - 1;
-	int old_light = square_light(c, p->grid);
 
 	/* Starting values based on permanent light */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
+	for (y = tl.y; y <= br.y; y++) {
+		int *row = c->light + y * c->width;
+
+		for (x = tl.x; x <= br.x; x++) {
 			struct loc grid = loc(x, y);
 
+			row[x] = 0;
 			if (square_isglow(c, grid) &&
 					(square_allowslos(c, grid) ||
 					glow_can_light_wall(c, p, grid))) {
-				c->squares[y][x].light = 1;
-			} else {
-				c->squares[y][x].light = 0;
+				row[x] += 1;
 			}
 
 			/* Squares with bright terrain have intensity 2 */
 			if (square_isbright(c, grid)) {
-				c->squares[y][x].light += 2;
-				for (dir = 0; dir < 8; dir++) {
-					struct loc adj_grid = loc_sum(grid, ddgrid_ddd[dir]);
-					if (!square_in_bounds(c, adj_grid)) continue;
-					/*
-					 * Only brighten a wall if the player
-					 * is in position to view the face
-					 * that's lit up.
-					 */
-					if (!square_allowslos(c, adj_grid) &&
-							!source_can_light_wall(
-							c, p, grid, adj_grid))
-							continue;
-					c->squares[adj_grid.y][adj_grid.x].light += 1;
-				}
+				row[x] += 2;
 			}
 		}
 	}
 
+	/* Bright terrain, in the area or next to it, lights its neighbours */
+	for (y = MAX(tl.y - 1, 0); y <= MIN(br.y + 1, c->height - 1); y++) {
+		for (x = MAX(tl.x - 1, 0); x <= MIN(br.x + 1, c->width - 1); x++) {
+			struct loc grid = loc(x, y);
+
+			if (!square_isbright(c, grid)) continue;
+			for (dir = 0; dir < 8; dir++) {
+				struct loc adj_grid = loc_sum(grid, ddgrid_ddd[dir]);
+				if (adj_grid.x < tl.x || adj_grid.x > br.x ||
+						adj_grid.y < tl.y || adj_grid.y > br.y)
+					continue;
+				/*
+				 * Only brighten a wall if the player is in
+				 * position to view the face that's lit up.
+				 */
+				if (!square_allowslos(c, adj_grid) &&
+						!source_can_light_wall(c, p, grid,
+						adj_grid))
+					continue;
+				c->light[adj_grid.y * c->width + adj_grid.x] += 1;
+			}
+		}
+	}
+
+	/* Add the light of the player and the monsters */
+	for (k = 0; k < state->n_sources; k++) {
+		if (source_reaches(&state->sources[k], tl, br)) {
+			add_light(c, p, &state->sources[k], tl, br);
+		}
+	}
+
+	state->relit += (br.y - tl.y + 1) * (br.x - tl.x + 1);
+}
+
+/**
+ * Calculate light level for every grid in view - stolen from Sil
+ *
+ * The light levels are kept between calls, and only the grids which may have
+ * changed are relit:  those a light source reached or now reaches if it has
+ * moved or changed, those near any changed terrain or permanent light, and
+ * the rows and columns where the player's movement may have changed which
+ * faces of the walls can be seen.
+ */
+static void calc_lighting(struct chunk *c, struct player *p)
+{
+	struct light_state *state = &c->lighting;
+	struct light_source *swap;
+	struct relight r;
+	int light = p->state.cur_light;
+	int old_light = square_light(c, p->grid);
+	int n_sources = cave_monster_max(c), i, k;
+
+	if (!state->sources) {
+		state->sources = mem_zalloc(z_info->level_monster_max *
+			sizeof(*state->sources));
+		state->next = mem_zalloc(z_info->level_monster_max *
+			sizeof(*state->next));
+	}
+
 	/* Light around the player */
-	add_light(c, p, p->grid, radius, light);
+	state->next[0].grid = p->grid;
+	state->next[0].radius = ABS(light) - 1;
+	state->next[0].inten = light;
 
-	/* Scan monster list and add monster light or darkness */
-	for (k = 1; k < cave_monster_max(c); k++) {
+	/* Scan monster list for monster light or darkness */
+	for (k = 1; k < n_sources; k++) {
 		/* Check the k'th monster */
 		struct monster *mon = cave_monster(c, k);
+		struct light_source *src = &state->next[k];
+
+		src->inten = 0;
 
 		/* Skip dead monsters */
 		if (!mon->race) continue;
@@ -706,24 +1005,102 @@ static void calc_lighting(struct chunk *c, struct player *p)
 
 		/* Get light info for this monster */
 		light = mon->race->light;
-		radius = ABS(light) - 1;
-
-		/* Skip monsters not affecting light */
-		if (!light) continue;
+		src->grid = mon->grid;
+		src->radius = ABS(light) - 1;
 
 		/* Skip if the player can't see it. */
-		if (distance(p->grid, mon->grid) - radius > z_info->max_sight)
+		if (distance(p->grid, mon->grid) - src->radius >
+				z_info->max_sight)
 			continue;
 
-		add_light(c, p, mon->grid, radius, light);
+		src->inten = light;
 	}
 
+	/* Find what needs relighting */
+	memset(&r, 0, sizeof(r));
+	r.all = !state->valid;
+	for (k = 0; k < MAX(n_sources, state->n_sources); k++) {
+		struct light_source none = { { 0, 0 }, 0, 0 };
+		struct light_source *old = (k < state->n_sources) ?
+			&state->sources[k] : &none;
+		struct light_source *new = (k < n_sources) ?
+			&state->next[k] : &none;
+
+		if (!old->inten && !new->inten) continue;
+		if (old->inten == new->inten && old->radius == new->radius &&
+				loc_eq(old->grid, new->grid)) continue;
+		relight_add_source(c, &r, old);
+		relight_add_source(c, &r, new);
+	}
+	for (i = 0; i < state->n_changed; i++) {
+		struct loc grid = state->changed[i];
+
+		relight_add(c, &r, loc_diff(grid, loc(1, 1)),
+			loc_sum(grid, loc(1, 1)));
+		for (k = 0; k < n_sources; k++) {
+			if (source_reaches(&state->next[k], grid, grid)) {
+				relight_add_source(c, &r, &state->next[k]);
+			}
+		}
+	}
+	if (!loc_eq(state->centre, p->grid)) {
+		struct loc old = state->centre;
+
+		relight_add(c, &r, loc(MIN(old.x, p->grid.x), 0),
+			loc(MAX(old.x, p->grid.x), c->height - 1));
+		relight_add(c, &r, loc(0, MIN(old.y, p->grid.y)),
+			loc(c->width - 1, MAX(old.y, p->grid.y)));
+	}
+
+	/* Switch to the new sources, and relight */
+	swap = state->sources;
+	state->sources = state->next;
+	state->next = swap;
+	state->n_sources = n_sources;
+	state->relit = 0;
+	if (r.all) {
+		relight_area(c, p, loc(0, 0), loc(c->width - 1, c->height - 1));
+	} else {
+		for (i = 0; i < r.n; i++) {
+			relight_area(c, p, r.tl[i], r.br[i]);
+		}
+	}
+	state->relit_total += state->relit;
+	state->updates++;
+	state->centre = p->grid;
+	state->n_changed = 0;
+	state->valid = true;
+
 	/* Update light level indicator */
 	if (square_light(c, p->grid) != old_light) {
 		p->upkeep->redraw |= PR_LIGHT;
 	}
 }
 
+/**
+ * Note that the terrain or permanent light of a grid has changed, so the light
+ * around it must be worked out again.
+ */
+void cave_light_changed(struct chunk *c, struct loc grid)
+{
+	struct light_state *state = &c->lighting;
+
+	if (!state->valid) return;
+	if (state->n_changed == LIGHT_CHANGED_MAX) {
+		state->valid = false;
+		return;
+	}
+	state->changed[state->n_changed++] = grid;
+}
+
+/**
+ * Make the next update_view() relight the whole level
+ */
+void cave_forget_light(struct chunk *c)
+{
+	c->lighting.valid = false;
+}
+
 /**
  * Make a square part of the current view
  */
@@ -737,10 +1114,10 @@ static void become_viewable(struct chunk *c, struct loc grid, struct player *p,
 	if (square_isview(c, grid)) return;
 
 	/* Add the grid to the view, make seen if it's close enough to the player */
-	sqinfo_on(square(c, grid)->info, SQUARE_VIEW);
+	sqinfo_on(square_info(c, grid), SQUARE_VIEW);
 	if (close) {
-		sqinfo_on(square(c, grid)->info, SQUARE_SEEN);
-		sqinfo_on(square(c, grid)->info, SQUARE_CLOSE_PLAYER);
+		sqinfo_on(square_info(c, grid), SQUARE_SEEN);
+		sqinfo_on(square_info(c, grid), SQUARE_CLOSE_PLAYER);
 	}
 
 	/* Mark lit grids, and walls near to them, as seen */
@@ -750,10 +1127,10 @@ static void become_viewable(struct chunk *c, struct loc grid, struct player *p,
 			int xc = (x < p->grid.x) ? (x + 1) : (x > p->grid.x) ? (x - 1) : x;
 			int yc = (y < p->grid.y) ? (y + 1) : (y > p->grid.y) ? (y - 1) : y;
 			if (square_islit(c, loc(xc, yc))) {
-				sqinfo_on(square(c, grid)->info, SQUARE_SEEN);
+				sqinfo_on(square_info(c, grid), SQUARE_SEEN);
 			}
 		} else {
-			sqinfo_on(square(c, grid)->info, SQUARE_SEEN);
+			sqinfo_on(square_info(c, grid), SQUARE_SEEN);
 		}
 	}
 }
@@ -824,7 +1201,7 @@ static void update_view_one(struct chunk *c, struct loc grid, struct player *p)
 		}
 	}
 
-	if (los(c, p->grid, loc(xc, yc)))
+	if (view_los(c, p, loc(xc, yc)))
 		become_viewable(c, grid, p, close);
 }
 
@@ -835,8 +1212,8 @@ static void update_one(struct chunk *c, struct loc grid, struct player *p)
 {
 	/* Remove view if blind, check visible squares for traps */
 	if (p->timed[TMD_BLIND]) {
-		sqinfo_off(square(c, grid)->info, SQUARE_SEEN);
-		sqinfo_off(square(c, grid)->info, SQUARE_CLOSE_PLAYER);
+		sqinfo_off(square_info(c, grid), SQUARE_SEEN);
+		sqinfo_off(square_info(c, grid), SQUARE_CLOSE_PLAYER);
 	} else if (square_isseen(c, grid)) {
 		square_reveal_trap(c, grid, false, true);
 	}
@@ -845,7 +1222,7 @@ static void update_one(struct chunk *c, struct loc grid, struct player *p)
 	if (square_isseen(c, grid) && !square_wasseen(c, grid)) {
 		if (square_isfeel(c, grid)) {
 			c->feeling_squares++;
-			sqinfo_off(square(c, grid)->info, SQUARE_FEEL);
+			sqinfo_off(square_info(c, grid), SQUARE_FEEL);
 			/* Don't display feeling if it will display for the new level */
 			if ((c->feeling_squares == z_info->feeling_need) &&
 				!p->upkeep->only_partial) {
@@ -862,28 +1239,42 @@ static void update_one(struct chunk *c, struct loc grid, struct player *p)
 	if (!square_isseen(c, grid) && square_wasseen(c, grid))
 		square_light_spot(c, grid);
 
-	sqinfo_off(square(c, grid)->info, SQUARE_WASSEEN);
+	sqinfo_off(square_info(c, grid), SQUARE_WASSEEN);
 }
 
 /**
  * Update the player's current view
+ *
+ * Only grids within max_sight grids of the player, in each direction, can be
+ * in view, so only those and the ones around where the last view was taken
+ * need to be looked at.
  */
 void update_view(struct chunk *c, struct player *p)
 {
+	struct loc old_tl, old_br, new_tl, new_br;
 	int x, y;
 
+	PROF_BEGIN(PROF_UPDATE_VIEW);
+	if (sight_lines.radius != z_info->max_sight) {
+		sight_lines_init(z_info->max_sight);
+	}
+	view_bounds(c, c->view_valid ? &c->view_centre : NULL, &old_tl, &old_br);
+	view_bounds(c, &p->grid, &new_tl, &new_br);
+
 	/* Record the current view */
-	mark_wasseen(c);
+	mark_wasseen(c, old_tl, old_br);
 
 	/* Calculate light levels */
+	PROF_BEGIN(PROF_CALC_LIGHTING);
 	calc_lighting(c, p);
+	PROF_END(PROF_CALC_LIGHTING);
 
 	/* Assume we can view the player grid */
-	sqinfo_on(square(c, p->grid)->info, SQUARE_VIEW);
+	sqinfo_on(square_info(c, p->grid), SQUARE_VIEW);
 	if (p->state.cur_light > 0 || square_islit(c, p->grid) ||
 		player_has(p, PF_UNLIGHT)) {
-		sqinfo_on(square(c, p->grid)->info, SQUARE_SEEN);
-		sqinfo_on(square(c, p->grid)->info, SQUARE_CLOSE_PLAYER);
+		sqinfo_on(square_info(c, p->grid), SQUARE_SEEN);
+		sqinfo_on(square_info(c, p->grid), SQUARE_CLOSE_PLAYER);
 	}
 	/*
 	 * If the player is blind and in terrain that was remembered to be
@@ -897,14 +1288,25 @@ void update_view(struct chunk *c, struct player *p)
 	}
 
 	/* Squares we have LOS to get marked as in the view, and perhaps seen */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	for (y = new_tl.y; y <= new_br.y; y++)
+		for (x = new_tl.x; x <= new_br.x; x++)
 			update_view_one(c, loc(x, y), p);
 
-	/* Update each grid */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	/* Update each grid that was or is now in view, visiting each once */
+	for (y = old_tl.y; y <= old_br.y; y++)
+		for (x = old_tl.x; x <= old_br.x; x++)
+			update_one(c, loc(x, y), p);
+	for (y = new_tl.y; y <= new_br.y; y++) {
+		for (x = new_tl.x; x <= new_br.x; x++) {
+			if (y >= old_tl.y && y <= old_br.y && x >= old_tl.x
+					&& x <= old_br.x) continue;
 			update_one(c, loc(x, y), p);
+		}
+	}
+
+	c->view_centre = p->grid;
+	c->view_valid = true;
+	PROF_END(PROF_UPDATE_VIEW);
 }
 
 
@@ -32,6 +32,7 @@
 #include "object.h"
 #include "player-timed.h"
 #include "trap.h"
+#include "z-queue.h"
 
 struct feature *f_info;
 struct chunk *cave = NULL;
@@ -342,21 +343,26 @@ const char *get_feat_code_name(int idx)
  * Allocate a new chunk of the world
  */
 struct chunk *cave_new(int height, int width) {
-	int y, x;
+	int y;
 
 	struct chunk *c = mem_zalloc(sizeof *c);
 	c->height = height;
 	c->width = width;
 	c->feat_count = mem_zalloc((FEAT_MAX + 1) * sizeof(int));
 
+	/*
+	 * The squares, their flags and their light levels each live in one
+	 * block for the whole chunk, stored row by row, so passes over the
+	 * map walk through memory in order.
+	 */
 	c->squares = mem_zalloc(c->height * sizeof(struct square*));
+	c->squares[0] = mem_zalloc(c->height * c->width * sizeof(struct square));
+	c->info = mem_zalloc(c->height * c->width * SQUARE_SIZE * sizeof(bitflag));
+	c->light = mem_zalloc(c->height * c->width * sizeof(int));
 	c->noise.grids = mem_zalloc(c->height * sizeof(uint16_t*));
 	c->scent.grids = mem_zalloc(c->height * sizeof(uint16_t*));
 	for (y = 0; y < c->height; y++) {
-		c->squares[y] = mem_zalloc(c->width * sizeof(struct square));
-		for (x = 0; x < c->width; x++) {
-			c->squares[y][x].info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-		}
+		c->squares[y] = c->squares[0] + y * c->width;
 		c->noise.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
 		c->scent.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
 	}
@@ -371,6 +377,7 @@ struct chunk *cave_new(int height, int width) {
 	c->monster_groups = mem_zalloc(z_info->level_monster_max *
 								   sizeof(struct monster_group*));
 
+	c->scent_turn = SCENT_TURN_MIN;
 	c->turn = turn;
 	return c;
 }
@@ -407,20 +414,33 @@ void cave_free(struct chunk *c) {
 
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			mem_free(c->squares[y][x].info);
 			if (c->squares[y][x].trap)
 				square_free_trap(c, loc(x, y));
 			if (c->squares[y][x].obj)
 				object_pile_free(c, p_c, c->squares[y][x].obj);
 		}
-		mem_free(c->squares[y]);
 		mem_free(c->noise.grids[y]);
 		mem_free(c->scent.grids[y]);
 	}
+	mem_free(c->squares[0]);
 	mem_free(c->squares);
+	mem_free(c->info);
+	mem_free(c->light);
+	mem_free(c->lighting.sources);
+	mem_free(c->lighting.next);
 	mem_free(c->noise.grids);
 	mem_free(c->scent.grids);
-
+	if (c->flow.queue)
+		q_free(c->flow.queue);
+
+	mem_free(c->terrain.grids);
+	mem_free(c->terrain.pos);
+	mem_free(c->terrain.start);
+	mem_free(c->monster_blocks.first);
+	mem_free(c->monster_blocks.next);
+	mem_free(c->monster_blocks.prev);
+	mem_free(c->monster_blocks.at);
+	mem_free(c->monster_blocks.found);
 	mem_free(c->feat_count);
 	mem_free(c->objects);
 	mem_free(c->monsters);
@@ -431,6 +451,291 @@ void cave_free(struct chunk *c) {
 }
 
 
+/**
+ * Group the grids of a chunk by terrain
+ */
+static void cave_index_terrain(struct chunk *c)
+{
+	struct terrain_index *t = &c->terrain;
+	int n = c->height * c->width, i, f;
+
+	if (!t->grids) {
+		t->grids = mem_alloc(n * sizeof(*t->grids));
+		t->pos = mem_alloc(n * sizeof(*t->pos));
+		t->start = mem_alloc((FEAT_MAX + 1) * sizeof(*t->start));
+	}
+	memset(t->start, 0, (FEAT_MAX + 1) * sizeof(*t->start));
+
+	/* Count the grids of each feature, then place them */
+	for (i = 0; i < n; i++) {
+		f = c->squares[0][i].feat;
+		assert(f < FEAT_MAX);
+		t->start[f + 1]++;
+	}
+	for (f = 1; f <= FEAT_MAX; f++) {
+		t->start[f] += t->start[f - 1];
+	}
+	for (i = 0; i < n; i++) {
+		f = c->squares[0][i].feat;
+		t->pos[i] = t->start[f]++;
+		t->grids[t->pos[i]] = i;
+	}
+	for (f = FEAT_MAX; f > 0; f--) {
+		t->start[f] = t->start[f - 1];
+	}
+	t->start[0] = 0;
+	t->valid = true;
+}
+
+/**
+ * Get the grids of a chunk with the given feature.
+ *
+ * \param c is the chunk.
+ * \param feat is the feature.
+ * \param grids is set to the grid indices (y * width + x) of the grids with
+ * that feature, which stay good until the terrain changes.
+ * \return the number of grids with that feature.
+ */
+int cave_terrain_grids(struct chunk *c, int feat, const int **grids)
+{
+	assert(feat >= 0 && feat < FEAT_MAX);
+	if (!c->terrain.valid) cave_index_terrain(c);
+	*grids = c->terrain.grids + c->terrain.start[feat];
+	return c->terrain.start[feat + 1] - c->terrain.start[feat];
+}
+
+/**
+ * Move a grid of a chunk to the group for its new terrain, by passing it
+ * along the ends of the groups in between.
+ *
+ * \param c is the chunk.
+ * \param grid is the grid whose terrain has changed.
+ * \param old_feat is the terrain it had before.
+ */
+void cave_terrain_changed(struct chunk *c, struct loc grid, int old_feat)
+{
+	struct terrain_index *t = &c->terrain;
+	int i = grid.y * c->width + grid.x;
+	int feat = square(c, grid)->feat;
+	int p, f;
+
+	if (!t->valid || feat == old_feat) return;
+	p = t->pos[i];
+	if (old_feat < feat) {
+		for (f = old_feat; f < feat; f++) {
+			int last = --t->start[f + 1];
+
+			t->grids[p] = t->grids[last];
+			t->pos[t->grids[p]] = p;
+			t->grids[last] = i;
+			p = last;
+		}
+	} else {
+		for (f = old_feat; f > feat; f--) {
+			int first = t->start[f]++;
+
+			t->grids[p] = t->grids[first];
+			t->pos[t->grids[p]] = p;
+			t->grids[first] = i;
+			p = first;
+		}
+	}
+	t->grids[p] = i;
+	t->pos[i] = p;
+}
+
+/**
+ * Forget the grouping of a chunk's grids by terrain, for when the terrain
+ * is changed other than by square_set_feat()
+ */
+void cave_forget_terrain(struct chunk *c)
+{
+	c->terrain.valid = false;
+}
+
+/**
+ * Get the block of the monster index holding a grid index
+ */
+static int monster_block(struct chunk *c, int i)
+{
+	int blocks_wide = (c->width + MONSTER_BLOCK - 1) / MONSTER_BLOCK;
+
+	return (i / c->width / MONSTER_BLOCK) * blocks_wide
+		+ (i % c->width) / MONSTER_BLOCK;
+}
+
+/**
+ * List a monster in the block holding grid index i
+ */
+static void monster_index_add(struct chunk *c, int midx, int i)
+{
+	struct monster_index *m = &c->monster_blocks;
+	int b = monster_block(c, i);
+
+	m->at[midx] = i;
+	m->prev[midx] = 0;
+	m->next[midx] = m->first[b];
+	if (m->first[b]) m->prev[m->first[b]] = midx;
+	m->first[b] = midx;
+}
+
+/**
+ * Take a monster out of the list for its block
+ */
+static void monster_index_remove(struct chunk *c, int midx)
+{
+	struct monster_index *m = &c->monster_blocks;
+
+	if (m->prev[midx]) {
+		m->next[m->prev[midx]] = m->next[midx];
+	} else {
+		m->first[monster_block(c, m->at[midx])] = m->next[midx];
+	}
+	if (m->next[midx]) m->prev[m->next[midx]] = m->prev[midx];
+	m->at[midx] = -1;
+}
+
+/**
+ * Group the monsters of a chunk by block
+ */
+static void cave_index_monsters(struct chunk *c)
+{
+	struct monster_index *m = &c->monster_blocks;
+	int blocks = ((c->height + MONSTER_BLOCK - 1) / MONSTER_BLOCK)
+		* ((c->width + MONSTER_BLOCK - 1) / MONSTER_BLOCK);
+	int n = c->height * c->width, i;
+
+	if (!m->first) {
+		m->first = mem_alloc(blocks * sizeof(*m->first));
+		m->next = mem_alloc(z_info->level_monster_max * sizeof(*m->next));
+		m->prev = mem_alloc(z_info->level_monster_max * sizeof(*m->prev));
+		m->at = mem_alloc(z_info->level_monster_max * sizeof(*m->at));
+		m->found = mem_alloc(z_info->level_monster_max * sizeof(*m->found));
+	}
+	memset(m->first, 0, blocks * sizeof(*m->first));
+	for (i = 0; i < z_info->level_monster_max; i++) {
+		m->at[i] = -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		int midx = c->squares[0][i].mon;
+
+		if (midx > 0) monster_index_add(c, midx, i);
+	}
+	m->valid = true;
+}
+
+static int cmp_grid_index(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+/**
+ * Get the monsters of a chunk in a rectangle of grids.
+ *
+ * \param c is the chunk.
+ * \param top_left is the top left corner of the rectangle.
+ * \param bottom_right is the bottom right corner, also part of the rectangle.
+ * \param midx is set to the indices of the monsters found, in the order a
+ * scan of the grids row by row would find them; they stay good until the
+ * next search.
+ * \return the number of monsters found.
+ */
+int cave_monsters_in(struct chunk *c, struct loc top_left,
+	struct loc bottom_right, const int **midx)
+{
+	struct monster_index *m = &c->monster_blocks;
+	int blocks_wide = (c->width + MONSTER_BLOCK - 1) / MONSTER_BLOCK;
+	int x0 = MAX(top_left.x, 0), y0 = MAX(top_left.y, 0);
+	int x1 = MIN(bottom_right.x, c->width - 1);
+	int y1 = MIN(bottom_right.y, c->height - 1);
+	int n = 0, bx, by, i;
+
+	if (!m->valid) cave_index_monsters(c);
+	*midx = m->found;
+	if (x0 > x1 || y0 > y1) return 0;
+
+	/* Collect the grids of the monsters in the rectangle */
+	for (by = y0 / MONSTER_BLOCK; by <= y1 / MONSTER_BLOCK; by++) {
+		for (bx = x0 / MONSTER_BLOCK; bx <= x1 / MONSTER_BLOCK; bx++) {
+			int k;
+
+			for (k = m->first[by * blocks_wide + bx]; k; k = m->next[k]) {
+				int x = m->at[k] % c->width, y = m->at[k] / c->width;
+
+				if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+					m->found[n++] = m->at[k];
+				}
+			}
+		}
+	}
+
+	/* Put them in grid order, then turn them back into monsters */
+	if (n > 1) sort(m->found, n, sizeof(*m->found), cmp_grid_index);
+	for (i = 0; i < n; i++) {
+		m->found[i] = c->squares[0][m->found[i]].mon;
+	}
+	return n;
+}
+
+/**
+ * Get the monsters of a chunk within a distance of a grid.
+ *
+ * \param c is the chunk.
+ * \param grid is the centre of the search.
+ * \param radius is the greatest distance() from grid a monster may be.
+ * \param midx is set to the indices of the monsters found, in grid order as
+ * for cave_monsters_in(); they stay good until the next search.
+ * \return the number of monsters found.
+ */
+int cave_monsters_near(struct chunk *c, struct loc grid, int radius,
+	const int **midx)
+{
+	int n = cave_monsters_in(c, loc(grid.x - radius, grid.y - radius),
+		loc(grid.x + radius, grid.y + radius), midx);
+	int *found = c->monster_blocks.found;
+	int i, kept = 0;
+
+	for (i = 0; i < n; i++) {
+		if (distance(grid, c->monsters[found[i]].grid) <= radius) {
+			found[kept++] = found[i];
+		}
+	}
+	return kept;
+}
+
+/**
+ * Move the monster index entries for a grid whose monster has changed.  When
+ * two monsters swap places, the first move finds the second monster still
+ * listed at its own grid, so it is left alone until the second move.
+ *
+ * \param c is the chunk.
+ * \param grid is the grid whose monster has changed.
+ * \param old_midx is the monster (or player, or nothing) it had before.
+ */
+void cave_monster_changed(struct chunk *c, struct loc grid, int old_midx)
+{
+	struct monster_index *m = &c->monster_blocks;
+	int i = grid.y * c->width + grid.x;
+	int midx = square(c, grid)->mon;
+
+	if (!m->valid || midx == old_midx) return;
+	if (old_midx > 0 && m->at[old_midx] == i) monster_index_remove(c, old_midx);
+	if (midx > 0) {
+		if (m->at[midx] >= 0) monster_index_remove(c, midx);
+		monster_index_add(c, midx, i);
+	}
+}
+
+/**
+ * Forget the grouping of a chunk's monsters by block, for when monsters
+ * are placed other than by square_set_mon()
+ */
+void cave_forget_monsters(struct chunk *c)
+{
+	c->monster_blocks.valid = false;
+}
+
 /**
  * Enter an object in the list of objects for the current level/chunk.  This
  * function is robust against listing of duplicates or non-objects
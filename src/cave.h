@@ -25,6 +25,7 @@
 struct player;
 struct monster;
 struct monster_group;
+struct queue;
 
 extern const int16_t ddd[9];
 extern const int16_t ddx[10];
@@ -160,8 +161,6 @@ struct grid_data {
 
 struct square {
 	uint8_t feat;
-	bitflag *info;
-	int light;
 	int16_t mon;
 	struct object *obj;
 	struct trap *trap;
@@ -171,6 +170,65 @@ struct heatmap {
 	uint16_t **grids;
 };
 
+/**
+ * Range of the scent clock.  Scent is recorded as the time it was laid, with
+ * zero meaning no scent, so the clock starts high enough that fresh scent is
+ * never zero; when it runs out, any ages past SCENT_AGE_MAX are forgotten.
+ */
+#define SCENT_TURN_MIN 16
+#define SCENT_AGE_MAX 0x7fff
+
+/**
+ * Most grids which can start carrying sound between noise updates before the
+ * noise field is rebuilt rather than repaired
+ */
+#define FLOW_OPENED_MAX 16
+
+/**
+ * Bookkeeping for the noise field, so it need only be changed when the
+ * player, the noise increment or the sound-carrying terrain has changed
+ */
+struct flow_state {
+	bool valid;				/* Field matches centre, step and terrain */
+	struct loc centre;		/* Grid the noise was propagated from */
+	int step;				/* Noise added for each grid travelled */
+	int n_opened;			/* Number of grids in opened */
+	struct loc opened[FLOW_OPENED_MAX];	/* Grids now carrying sound */
+	struct queue *queue;	/* Propagation queue, kept between updates */
+};
+
+/**
+ * Most grids whose terrain or permanent light can change between light
+ * updates before the whole level is relit
+ */
+#define LIGHT_CHANGED_MAX 32
+
+/**
+ * A light source as it was added into the light levels
+ */
+struct light_source {
+	struct loc grid;
+	int radius;
+	int inten;				/* Zero if there is no source */
+};
+
+/**
+ * Bookkeeping for the light levels, so that only the grids near a change
+ * need to be relit
+ */
+struct light_state {
+	bool valid;				/* Light levels match centre and sources */
+	struct loc centre;		/* Player grid the light was worked out for */
+	int n_sources;			/* Sources used; the player, then each monster */
+	struct light_source *sources;
+	struct light_source *next;	/* Space for working out the new sources */
+	int n_changed;			/* Number of grids in changed */
+	struct loc changed[LIGHT_CHANGED_MAX];	/* Grids with new terrain or glow */
+	uint32_t updates;		/* Times the light has been brought up to date */
+	uint32_t relit;			/* Grids relit by the last update */
+	uint32_t relit_total;	/* Grids relit by all updates */
+};
+
 struct connector {
 	struct loc grid;
 	uint8_t feat;
@@ -178,6 +236,38 @@ struct connector {
 	struct connector *next;
 };
 
+/**
+ * The grids of a chunk grouped by terrain, so a search for a grid need only
+ * look at the terrain which could suit it.  The grids with feature, f, are
+ * grids[start[f]] up to, but not including, grids[start[f + 1]]; pos gives
+ * the place of each grid in grids.  It is made when first needed, and kept
+ * up to date by square_set_feat() after that.
+ */
+struct terrain_index {
+	bool valid;
+	int *grids;				/* Grid indices (y * width + x) */
+	int *start;				/* FEAT_MAX + 1 group starts */
+	int *pos;				/* Place of each grid in grids */
+};
+
+/**
+ * The monsters of a chunk grouped by blocks of MONSTER_BLOCK x MONSTER_BLOCK
+ * grids, so a search near a grid need only look at the blocks around it.
+ * Each block's monsters are a list through next and prev, starting at
+ * first[block]; at gives the grid each monster is listed at.  It is made
+ * when first needed, and kept up to date by square_set_mon() after that.
+ */
+#define MONSTER_BLOCK	8
+
+struct monster_index {
+	bool valid;
+	int *first;				/* First monster in each block, or 0 */
+	int *next;				/* Next monster in the same block, or 0 */
+	int *prev;				/* Previous monster in the same block, or 0 */
+	int *at;				/* Grid index (y * width + x), or -1 */
+	int *found;				/* Result of the last search */
+};
+
 struct chunk {
 	char *name;
 	int32_t turn;
@@ -194,10 +284,19 @@ struct chunk {
 	uint16_t feeling_squares; /* How many feeling squares the player has visited */
 	int *feat_count;
 
-	struct square **squares;
+	struct square **squares;	/* Row pointers into one block of squares */
+	bitflag *info;			/* SQUARE_SIZE flag bytes per grid, row by row */
+	int *light;				/* Light level of each grid, row by row */
 	struct heatmap noise;
 	struct heatmap scent;
+	uint16_t scent_turn;	/* Scent clock, advanced by cave_age_scent() */
+	struct flow_state flow;
 	struct loc decoy;
+	struct loc view_centre;	/* Player grid for the last update_view() */
+	bool view_valid;		/* View flags are only set near view_centre */
+	struct light_state lighting;
+	struct terrain_index terrain;
+	struct monster_index monster_blocks;
 
 	struct object **objects;
 	uint16_t obj_max;
@@ -230,7 +329,10 @@ extern uint16_t chunk_list_max;
 /* cave-view.c */
 int distance(struct loc grid1, struct loc grid2);
 bool los(struct chunk *c, struct loc grid1, struct loc grid2);
+int sight_line(struct loc offset, const struct loc **path);
 void update_view(struct chunk *c, struct player *p);
+void cave_light_changed(struct chunk *c, struct loc grid);
+void cave_forget_light(struct chunk *c);
 bool no_light(const struct player *p);
 
 /* cave-map.c */
@@ -242,8 +344,12 @@ void wiz_light(struct chunk *c, struct player *p, bool full);
 void wiz_dark(struct chunk *c, struct player *p, bool full);
 void cave_illuminate(struct chunk *c, bool daytime);
 void expose_to_sun(struct chunk *c, struct loc grid, bool daytime);
-void cave_update_flow(struct chunk *c);
+void cave_update_flow(struct chunk *c, struct loc centre, int step);
 void cave_forget_flow(struct chunk *c);
+void cave_flow_terrain_changed(struct chunk *c, struct loc grid, bool blocked);
+int cave_scent_age(struct chunk *c, struct loc grid);
+void cave_lay_scent(struct chunk *c, struct loc grid, int age);
+void cave_age_scent(struct chunk *c);
 
 /* cave-square.c */
 /**
@@ -366,6 +472,7 @@ bool square_allows_summon(struct chunk *c, struct loc grid);
 const struct square *square(struct chunk *c, struct loc grid);
 struct feature *square_feat(struct chunk *c, struct loc grid);
 int square_light(struct chunk *c, struct loc grid);
+bitflag *square_info(struct chunk *c, struct loc grid);
 struct monster *square_monster(struct chunk *c, struct loc grid);
 struct object *square_object(struct chunk *c, struct loc grid);
 struct trap *square_trap(struct chunk *c, struct loc grid);
@@ -433,6 +540,15 @@ const char *get_feat_code_name(int idx);
 struct chunk *cave_new(int height, int width);
 void cave_connectors_free(struct connector *join);
 void cave_free(struct chunk *c);
+int cave_terrain_grids(struct chunk *c, int feat, const int **grids);
+void cave_terrain_changed(struct chunk *c, struct loc grid, int old_feat);
+void cave_forget_terrain(struct chunk *c);
+int cave_monsters_in(struct chunk *c, struct loc top_left,
+	struct loc bottom_right, const int **midx);
+int cave_monsters_near(struct chunk *c, struct loc grid, int radius,
+	const int **midx);
+void cave_monster_changed(struct chunk *c, struct loc grid, int old_midx);
+void cave_forget_monsters(struct chunk *c);
 void list_object(struct chunk *c, struct object *obj);
 void delist_object(struct chunk *c, struct object *obj);
 void object_lists_check_integrity(struct chunk *c, struct chunk *c_k);
@@ -1460,7 +1460,7 @@ static void wiz_hack_map_peek_noise(struct chunk *c, void *closure,
 static void wiz_hack_map_peek_scent(struct chunk *c, void *closure,
 	struct loc grid, bool *show, uint8_t *color)
 {
-	if (c->scent.grids[grid.y][grid.x] == *((int*)closure)) {
+	if (cave_scent_age(c, grid) == *((int*)closure)) {
 		*show = true;
 		*color = COLOUR_YELLOW;
 	} else {
@@ -2085,7 +2085,7 @@ static void wiz_hack_map_query_square_flag(struct chunk *c, void *closure,
 	int flag = *((int*)closure);
 
 	/* With a flag, test for that.  Otherwise, test if grid is known. */
-	if ((flag && sqinfo_has(square(c, grid)->info, flag)) ||
+	if ((flag && sqinfo_has(square_info(c, grid), flag)) ||
 			(!flag && square_isknown(c, grid))) {
 		*show = true;
 		*color = (square_ispassable(c, grid)) ?
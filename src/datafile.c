@@ -20,6 +20,7 @@
  */
 
 #include "angband.h"
+#include "buildid.h"
 #include "datafile.h"
 #include "game-world.h"
 #include "init.h"
@@ -31,6 +32,11 @@
  */
 static char *archive_user_pfx = NULL;
 
+/**
+ * Whether parse_file() may use, and keep, the cached records of datafiles
+ */
+bool use_parse_cache = true;
+
 const char *parser_error_str[PARSE_ERROR_MAX] = {
 	#define PARSE_ERROR(a, b) b,
 	#include "list-parser-errors.h"
@@ -77,6 +83,175 @@ errr parse_file_quit_not_found(struct parser *p, const char *filename) {
 	return parse_err;
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Cached records of parsed datafiles
+ *
+ * Parsing a datafile leaves a record of its lines, already split up and
+ * converted (see parser_record()), in the cache directory under the user
+ * directory.  The next time the same text is parsed by the same sort of
+ * parser, the record is replayed instead.  That only saves reading and
+ * converting the text; the parser's hooks are run just as before, so all they
+ * build is the same.  A record which doesn't match is ignored and replaced;
+ * as the user directory is shared by every build of the game, that includes
+ * a record made by another version.
+ * ------------------------------------------------------------------------ */
+
+static const char datafile_cache_magic[4] = { 'A', 'n', 'g', 'C' };
+
+struct datafile_cache_head {
+	char magic[4];
+	uint32_t build;		/**< hash of the version which made the record */
+	uint32_t source_size;
+	uint32_t source_hash;
+	uint32_t signature;
+	uint32_t record_size;
+	uint32_t record_hash;
+};
+
+/**
+ * Add bytes to an FNV-1a hash
+ */
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t len)
+{
+	const uint8_t *b = data;
+
+	while (len--) {
+		hash ^= *b++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+#define HASH_START 2166136261u
+
+/**
+ * Note the size and hash of the text of an open datafile
+ */
+static bool hash_source(ang_file *fh, struct datafile_cache_head *head)
+{
+	char buf[4096];
+	int n;
+
+	head->source_size = 0;
+	head->source_hash = HASH_START;
+	while ((n = file_read(fh, buf, sizeof(buf))) > 0) {
+		head->source_size += n;
+		head->source_hash = hash_bytes(head->source_hash, buf, n);
+	}
+	return n == 0;
+}
+
+/**
+ * Read the record for a datafile from the cache, if it matches the head.
+ * The returned record must be freed with mem_free().
+ */
+static uint8_t *cache_load(const char *cache,
+		const struct datafile_cache_head *want, size_t *len)
+{
+	struct datafile_cache_head head;
+	ang_file *fh;
+	uint8_t *record = NULL;
+	size_t size;
+
+	/* Only trust the record's size once it is known to fit in the file */
+	if (!file_size(cache, &size) || size < sizeof(head)) return NULL;
+	fh = file_open(cache, MODE_READ, FTYPE_RAW);
+	if (!fh) return NULL;
+	if (file_read(fh, (char *)&head, sizeof(head)) == sizeof(head) &&
+			!memcmp(head.magic, datafile_cache_magic,
+			sizeof(head.magic)) &&
+			head.build == want->build &&
+			head.record_size <= size - sizeof(head) &&
+			head.source_size == want->source_size &&
+			head.source_hash == want->source_hash &&
+			head.signature == want->signature) {
+		record = mem_alloc(head.record_size + 1);
+		if (file_read(fh, (char *)record, head.record_size + 1) !=
+				(int)head.record_size ||
+				hash_bytes(HASH_START, record, head.record_size) !=
+				head.record_hash) {
+			mem_free(record);
+			record = NULL;
+		}
+		*len = head.record_size;
+	}
+	file_close(fh);
+	return record;
+}
+
+/**
+ * Write the record for a datafile to the cache, replacing it all at once so
+ * that others reading it never see half a record
+ */
+static void cache_save(const char *cache_dir, const char *cache,
+		struct datafile_cache_head *head, const uint8_t *record,
+		size_t len)
+{
+	char temp[1024];
+	ang_file *fh;
+	bool written;
+
+	if (!dir_create(cache_dir)) return;
+	file_get_tempfile(temp, sizeof(temp), cache, "new");
+	fh = file_open(temp, MODE_WRITE, FTYPE_RAW);
+	if (!fh) return;
+
+	memcpy(head->magic, datafile_cache_magic, sizeof(head->magic));
+	head->record_size = len;
+	head->record_hash = hash_bytes(HASH_START, record, len);
+	written = file_write(fh, (const char *)head, sizeof(*head)) &&
+		file_write(fh, (const char *)record, len);
+	file_close(fh);
+
+	/* Some systems won't move a file over another */
+	if (written && !file_move(temp, cache)) {
+		file_delete(cache);
+		written = file_move(temp, cache);
+	}
+	if (!written) file_delete(temp);
+}
+
+/**
+ * Errors found so far while parsing a file
+ */
+struct parse_errors {
+	errr first;
+	unsigned int line;
+	unsigned int col;
+	char msg[1024];
+	int count;
+	int max;
+};
+
+/**
+ * Report an error from parsing a line of a file, and return true if there
+ * have been too many to go on
+ */
+static bool parse_error(struct parser *p, const char *path,
+		struct parse_errors *e)
+{
+	struct parser_state s;
+
+	parser_getstate(p, &s);
+	if (!e->first) {
+		e->first = s.error;
+		e->line = s.line;
+		e->col = s.col;
+		my_strcpy(e->msg, s.msg, sizeof(e->msg));
+	}
+	plog_fmt("Parse error in %s line %d column %d: %s: %s",
+		path, s.line, s.col, s.msg,
+		parser_error_str[s.error]);
+	if (e->max) {
+		if (e->count >= e->max - 1) {
+			return true;
+		}
+		++e->count;
+	}
+	return false;
+}
+
 /**
  * The basic file parsing function.
  *
@@ -87,11 +262,17 @@ errr parse_file_quit_not_found(struct parser *p, const char *filename) {
 errr parse_file(struct parser *p, const char *filename) {
 	char path[1024];
 	char buf[1024];
-	char firstmsg[1024] = "";
+	char cache_dir[1024];
+	char cache[1024];
+	struct datafile_cache_head head;
+	struct parse_errors errors;
+	uint8_t *record;
+	size_t len;
 	ang_file *fh;
-	errr firste = 0;
-	unsigned int firstl = 0, firstc = 0;
-	int maxe = get_parser_error_limit(), counte = 0;
+	bool hashed;
+
+	memset(&errors, 0, sizeof(errors));
+	errors.max = get_parser_error_limit();
 
 	/* The player can put a customised file in the user directory */
 	path_build(path, sizeof(path), ANGBAND_DIR_USER, format("%s.txt",
@@ -109,36 +290,52 @@ errr parse_file(struct parser *p, const char *filename) {
 	if (!fh)
 		return PARSE_ERROR_NO_FILE_FOUND;
 
-	/* Parse it */
-	while (file_getl(fh, buf, sizeof(buf))) {
-		errr r = parser_parse(p, buf);
-
-		if (r) {
-			struct parser_state s;
-
-			parser_getstate(p, &s);
-			if (!firste) {
-				firste = r;
-				firstl = s.line;
-				firstc = s.col;
-				my_strcpy(firstmsg, s.msg, sizeof(firstmsg));
+	/* Replay the record of the file if it's in the cache */
+	hashed = use_parse_cache && hash_source(fh, &head);
+	file_close(fh);
+	head.build = hash_bytes(HASH_START, buildver, strlen(buildver));
+	head.signature = parser_signature(p);
+	path_build(cache_dir, sizeof(cache_dir), ANGBAND_DIR_USER, "cache");
+	path_build(cache, sizeof(cache), cache_dir, format("%s.dat", filename));
+	record = hashed ? cache_load(cache, &head, &len) : NULL;
+	if (record) {
+		const uint8_t *pos = record;
+
+		while (pos < record + len) {
+			if (parser_replay(p, &pos, record + len) &&
+					parse_error(p, path, &errors)) {
+				break;
 			}
-			plog_fmt("Parse error in %s line %d column %d: %s: %s",
-				path, s.line, s.col, s.msg,
-				parser_error_str[s.error]);
-			if (maxe) {
-				if (counte >= maxe - 1) {
-					break;
-				}
-				++counte;
+		}
+		mem_free(record);
+	} else {
+		fh = file_open(path, MODE_READ, FTYPE_TEXT);
+		if (!fh)
+			return PARSE_ERROR_NO_FILE_FOUND;
+
+		/* Parse it */
+		parser_record(p, hashed);
+		while (file_getl(fh, buf, sizeof(buf))) {
+			if (parser_parse(p, buf) && parse_error(p, path, &errors)) {
+				break;
 			}
 		}
+		file_close(fh);
+
+		/* Keep the record for next time */
+		if (hashed && !errors.first) {
+			const uint8_t *made = parser_get_record(p, &len);
+
+			cache_save(cache_dir, cache, &head, made, len);
+		}
+		parser_record(p, false);
 	}
-	file_close(fh);
-	if (firste) {
-		parser_setstate(p, firste, firstl, firstc, firstmsg);
+
+	if (errors.first) {
+		parser_setstate(p, errors.first, errors.line, errors.col,
+			errors.msg);
 	}
-	return firste;
+	return errors.first;
 }
 
 void cleanup_parser(struct file_parser *fp)
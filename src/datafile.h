@@ -31,6 +31,7 @@ struct file_parser {
 };
 
 extern const char *parser_error_str[PARSE_ERROR_MAX];
+extern bool use_parse_cache;
 
 errr run_parser(struct file_parser *fp);
 errr parse_file_quit_not_found(struct parser *p, const char *filename);
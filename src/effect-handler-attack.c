@@ -1195,14 +1195,15 @@ bool effect_handler_DESTRUCTION(effect_handler_context_t *context)
 			if (k > r) continue;
 
 			/* Lose room and vault */
-			sqinfo_off(square(cave, grid)->info, SQUARE_ROOM);
-			sqinfo_off(square(cave, grid)->info, SQUARE_VAULT);
+			sqinfo_off(square_info(cave, grid), SQUARE_ROOM);
+			sqinfo_off(square_info(cave, grid), SQUARE_VAULT);
 
 			/* Forget completely */
 			if (!square_isbright(cave, grid)) {
-				sqinfo_off(square(cave, grid)->info, SQUARE_GLOW);
+				sqinfo_off(square_info(cave, grid), SQUARE_GLOW);
+				cave_light_changed(cave, grid);
 			}
-			sqinfo_off(square(cave, grid)->info, SQUARE_SEEN);
+			sqinfo_off(square_info(cave, grid), SQUARE_SEEN);
 			square_forget(cave, grid);
 			square_light_spot(cave, grid);
 
@@ -1347,14 +1348,15 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 			if (distance(centre, grid) > r) continue;
 
 			/* Lose room and vault */
-			sqinfo_off(square(cave, grid)->info, SQUARE_ROOM);
-			sqinfo_off(square(cave, grid)->info, SQUARE_VAULT);
+			sqinfo_off(square_info(cave, grid), SQUARE_ROOM);
+			sqinfo_off(square_info(cave, grid), SQUARE_VAULT);
 
 			/* Forget completely */
 			if (!square_isbright(cave, grid)) {
-				sqinfo_off(square(cave, grid)->info, SQUARE_GLOW);
+				sqinfo_off(square_info(cave, grid), SQUARE_GLOW);
+				cave_light_changed(cave, grid);
 			}
-			sqinfo_off(square(cave, grid)->info, SQUARE_SEEN);
+			sqinfo_off(square_info(cave, grid), SQUARE_SEEN);
 			square_forget(cave, grid);
 			square_light_spot(cave, grid);
 
@@ -1373,7 +1373,7 @@ bool effect_handler_DETECT_TRAPS(effect_handler_context_t *context)
 				}
 			}
 			/* Mark as trap-detected */
-			sqinfo_on(square(cave, loc(x, y))->info, SQUARE_DTRAP);
+			sqinfo_on(square_info(cave, loc(x, y)), SQUARE_DTRAP);
 		}
 	}
 
@@ -2673,7 +2673,7 @@ bool effect_handler_TELEPORT(effect_handler_context_t *context)
 	}
 
 	/* Clear any projection marker to prevent double processing */
-	sqinfo_off(square(cave, spots->grid)->info, SQUARE_PROJECT);
+	sqinfo_off(square_info(cave, spots->grid), SQUARE_PROJECT);
 
 	/* Clear monster target if it's no longer visible */
 	if (!target_able(target_get_monster())) {
@@ -2820,7 +2820,7 @@ bool effect_handler_TELEPORT_TO(effect_handler_context_t *context)
 	}
 
 	/* Clear any projection marker to prevent double processing */
-	sqinfo_off(square(cave, land)->info, SQUARE_PROJECT);
+	sqinfo_off(square_info(cave, land), SQUARE_PROJECT);
 
 	/* Lots of updates after monster_swap */
 	handle_stuff(player);
@@ -37,7 +37,7 @@
 #include "source.h"
 #include "target.h"
 #include "trap.h"
-#include "z-queue.h"
+#include "z-prof.h"
 
 uint16_t daycount = 0;
 uint32_t seed_randart;		/* Consistent random artifacts */
@@ -383,64 +383,15 @@ static void decrease_timeouts(void)
  * values, thereby homing in on the player even though twisty tunnels and
  * mazes.  Monsters have a hearing value, which is the largest sound value
  * they can detect.
+ *
+ * The field is kept with the level, and is only recomputed as far as the
+ * player or the terrain has changed it; see cave_update_flow().
  */
 static void make_noise(struct player *p)
 {
-	struct loc next = p->grid;
-	int y, x, d;
-	int noise = 0;
 	int noise_increment = p->timed[TMD_COVERTRACKS] ? 4 : 1;
-    struct queue *queue = q_new(cave->height * cave->width);
-
-	/* Set all the grids to silence */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			cave->noise.grids[y][x] = 0;
-		}
-	}
-
-	/* Player makes noise */
-	cave->noise.grids[next.y][next.x] = noise;
-	q_push_int(queue, grid_to_i(next, cave->width));
-	noise += noise_increment;
-
-	/* Propagate noise */
-	while (q_len(queue) > 0) {
-		/* Get the next grid */
-		i_to_grid(q_pop_int(queue), cave->width, &next);
-
-		/* If we've reached the current noise level, put it back and step */
-		if (cave->noise.grids[next.y][next.x] == noise) {
-			q_push_int(queue, grid_to_i(next, cave->width));
-			noise += noise_increment;
-			continue;
-		}
-
-		/* Assign noise to the children and enqueue them */
-		for (d = 0; d < 8; d++)	{
-			/* Child location */
-			struct loc grid = loc_sum(next, ddgrid_ddd[d]);
-
-			if (!square_in_bounds(cave, grid)) continue;
 
-			/* Ignore features that don't transmit sound */
-			if (square_isnoflow(cave, grid)) continue;
-
-			/* Skip grids that already have noise */
-			if (cave->noise.grids[grid.y][grid.x] != 0) continue;
-
-			/* Skip the player grid */
-			if (loc_eq(p->grid, grid)) continue;
-
-			/* Save the noise */
-			cave->noise.grids[grid.y][grid.x] = noise;
-
-			/* Enqueue that entry */
-			q_push_int(queue, grid_to_i(grid, cave->width));
-		}
-	}
-
-	q_free(queue);
+	cave_update_flow(cave, p->grid, noise_increment);
 }
 
 /**
@@ -456,6 +407,9 @@ static void make_noise(struct player *p)
  * value which indicates the oldest scent they can detect.  Grids where the
  * player has never been will have scent 0.  The player's grid will also have
  * scent 0, but this is OK as no monster will ever be smelling it.
+ *
+ * Scent is stored as the time it was laid (see cave_scent_age()), so aging
+ * it costs nothing however big the level is.
  */
 static void update_scent(void)
 {
@@ -469,13 +423,7 @@ static void update_scent(void)
 	};
 
 	/* Update scent for all grids */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			if (cave->scent.grids[y][x] > 0) {
-				cave->scent.grids[y][x]++;
-			}
-		}
-	}
+	cave_age_scent(cave);
 
 	/* Scentless player */
 	if (player->timed[TMD_COVERTRACKS]) return;
@@ -510,7 +458,7 @@ static void update_scent(void)
 				}
 
 				/* Adjacent to a closer grid, so valid */
-				if (cave->scent.grids[adj.y][adj.x] == new_scent - 1) {
+				if (cave_scent_age(cave, adj) == new_scent - 1) {
 					add_scent = true;
 				}
 			}
@@ -521,7 +469,7 @@ static void update_scent(void)
 			}
 
 			/* Mark the scent */
-			cave->scent.grids[scent.y][scent.x] = new_scent;
+			cave_lay_scent(cave, scent, new_scent);
 		}
 	}
 }
@@ -730,8 +678,12 @@ void process_world(struct chunk *c)
 
 	/* Update noise and scent (not if resting) */
 	if (!player_is_resting(player)) {
+		PROF_BEGIN(PROF_MAKE_NOISE);
 		make_noise(player);
+		PROF_END(PROF_MAKE_NOISE);
+		PROF_BEGIN(PROF_UPDATE_SCENT);
 		update_scent();
+		PROF_END(PROF_UPDATE_SCENT);
 	}
 
 
@@ -87,7 +87,7 @@ static bool square_is_granite_with_flag(struct chunk *c, struct loc grid,
 										int flag)
 {
 	if (square(c, grid)->feat != FEAT_GRANITE) return false;
-	if (!sqinfo_has(square(c, grid)->info, flag)) return false;
+	if (!sqinfo_has(square_info(c, grid), flag)) return false;
 
 	return true;
 }
@@ -546,8 +546,8 @@ static void build_tunnel(struct chunk *c, struct loc grid1, struct loc grid2)
 		}
 
 		/* Avoid obstacles */
-		if ((square_isperm(c, tmp_grid) && !sqinfo_has(square(c,
-				tmp_grid)->info, SQUARE_WALL_INNER)) ||
+		if ((square_isperm(c, tmp_grid) && !sqinfo_has(square_info(c,
+				tmp_grid), SQUARE_WALL_INNER)) ||
 				square_is_granite_with_flag(c, tmp_grid,
 				SQUARE_WALL_SOLID)) {
 			continue;
@@ -1434,7 +1434,7 @@ static struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool sof
 			struct loc diag = next_grid(grid, DIR_SE);
 			sets[k_local] = k_local;
 			square_set_feat(c, diag, FEAT_FLOOR);
-			if (lit) sqinfo_on(square(c, diag)->info, SQUARE_GLOW);
+			if (lit) sqinfo_on(square_info(c, diag), SQUARE_GLOW);
 		}
 	}
 
@@ -1465,7 +1465,7 @@ static struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool sof
 			int sb = sets[b];
 			square_set_feat(c, next_grid(grid, DIR_SE), FEAT_FLOOR);
 			if (lit) {
-				sqinfo_on(square(c, next_grid(grid, DIR_SE))->info, SQUARE_GLOW);
+				sqinfo_on(square_info(c, next_grid(grid, DIR_SE)), SQUARE_GLOW);
 			}
 			for (k = 0; k < n; k++) {
 				if (sets[k] == sb) sets[k] = sa;
@@ -2553,7 +2553,7 @@ static void town_gen_layout(struct chunk *c, struct player *p)
 		/* Turn off room illumination flag */
 		for (grid.y = 1; grid.y < c->height - 1; grid.y++) {
 			for (grid.x = 1; grid.x < c->width - 1; grid.x++) {
-				sqinfo_off(square(c, grid)->info, SQUARE_ROOM);
+				sqinfo_off(square_info(c, grid), SQUARE_ROOM);
 			}
 		}
 
@@ -54,7 +54,7 @@ struct chunk *chunk_write(struct chunk *c)
 		for (x = 0; x < new->width; x++) {
 			/* Terrain */
 			new->squares[y][x].feat = square(c, loc(x, y))->feat;
-			sqinfo_copy(square(new, loc(x, y))->info, square(c, loc(x, y))->info);
+			sqinfo_copy(square_info(new, loc(x, y)), square_info(c, loc(x, y)));
 		}
 	}
 
@@ -369,8 +369,8 @@ bool chunk_copy(struct chunk *dest, struct player *p, struct chunk *source,
 			/* Terrain */
 			dest->squares[dest_grid.y][dest_grid.x].feat =
 				square(source, grid)->feat;
-			sqinfo_copy(square(dest, dest_grid)->info,
-						square(source, grid)->info);
+			sqinfo_copy(square_info(dest, dest_grid),
+						square_info(source, grid));
 
 			/* Dungeon objects */
 			if (square_object(source, grid)) {
@@ -407,6 +407,10 @@ bool chunk_copy(struct chunk *dest, struct player *p, struct chunk *source,
 		}
 	}
 
+	/* The terrain and monsters are written directly */
+	cave_forget_terrain(dest);
+	cave_forget_monsters(dest);
+
 	/* Monsters */
 	dest->mon_max += source->mon_max;
 	dest->mon_cnt += source->mon_cnt;
@@ -150,9 +150,9 @@ static void generate_room(struct chunk *c, int y1, int x1, int y2, int x2,
 	struct loc grid;
 	for (grid.y = y1; grid.y <= y2; grid.y++)
 		for (grid.x = x1; grid.x <= x2; grid.x++) {
-			sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
+			sqinfo_on(square_info(c, grid), SQUARE_ROOM);
 			if (light)
-				sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+				sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 		}
 }
 
@@ -170,7 +170,7 @@ void generate_mark(struct chunk *c, int y1, int x1, int y2, int x2, int flag)
 	struct loc grid;
 	for (grid.y = y1; grid.y <= y2; grid.y++) {
 		for (grid.x = x1; grid.x <= x2; grid.x++) {
-			sqinfo_on(square(c, grid)->info, flag);
+			sqinfo_on(square_info(c, grid), flag);
 		}
 	}
 }
@@ -255,10 +255,10 @@ static void fill_xrange(struct chunk *c, int y, int x1, int x2, int feat,
 	for (x = x1; x <= x2; x++) {
 		struct loc grid = loc(x, y);
 		square_set_feat(c, grid, feat);
-		sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
-		if (flag) sqinfo_on(square(c, grid)->info, flag);
+		sqinfo_on(square_info(c, grid), SQUARE_ROOM);
+		if (flag) sqinfo_on(square_info(c, grid), flag);
 		if (light)
-			sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+			sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 	}
 }
 
@@ -279,10 +279,10 @@ static void fill_yrange(struct chunk *c, int x, int y1, int y2, int feat,
 	for (y = y1; y <= y2; y++) {
 		struct loc grid = loc(x, y);
 		square_set_feat(c, grid, feat);
-		sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
-		if (flag) sqinfo_on(square(c, grid)->info, flag);
+		sqinfo_on(square_info(c, grid), SQUARE_ROOM);
+		if (flag) sqinfo_on(square_info(c, grid), flag);
 		if (light)
-			sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+			sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 	}
 }
 
@@ -814,15 +814,15 @@ extern bool generate_starburst_room(struct chunk *c, int y1, int x1, int y2,
 							square_set_feat(c, grid, feat);
 
 							if (feat_is_floor(feat)) {
-								sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
+								sqinfo_on(square_info(c, grid), SQUARE_ROOM);
 							} else {
-								sqinfo_off(square(c, grid)->info, SQUARE_ROOM);
+								sqinfo_off(square_info(c, grid), SQUARE_ROOM);
 							}
 
 							if (light) {
-								sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+								sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 							} else if (!square_isbright(c, grid)) {
-								sqinfo_off(square(c, grid)->info, SQUARE_GLOW);
+								sqinfo_off(square_info(c, grid), SQUARE_GLOW);
 							}
 						}
 
@@ -842,7 +842,7 @@ extern bool generate_starburst_room(struct chunk *c, int y1, int x1, int y2,
 
 							/* Light grid. */
 							if (light)
-								sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+								sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 						}
 					}
 
@@ -870,12 +870,12 @@ extern bool generate_starburst_room(struct chunk *c, int y1, int x1, int y2,
 						struct loc grid1 = loc_sum(grid, ddgrid_ddd[d]);
 
 						/* Join to room, forbid stairs */
-						sqinfo_on(square(c, grid1)->info, SQUARE_ROOM);
-						sqinfo_on(square(c, grid1)->info, SQUARE_NO_STAIRS);
+						sqinfo_on(square_info(c, grid1), SQUARE_ROOM);
+						sqinfo_on(square_info(c, grid1), SQUARE_NO_STAIRS);
 
 						/* Illuminate if requested. */
 						if (light)
-							sqinfo_on(square(c, grid1)->info, SQUARE_GLOW);
+							sqinfo_on(square_info(c, grid1), SQUARE_GLOW);
 
 						/* Look for dungeon granite. */
 						if (square(c, grid1)->feat == FEAT_GRANITE) {
@@ -1246,9 +1246,9 @@ static bool build_room_template(struct chunk *c, struct loc centre, int ymax,
 			}
 
 			/* Part of a room */
-			sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
+			sqinfo_on(square_info(c, grid), SQUARE_ROOM);
 			if (light)
-				sqinfo_on(square(c, grid)->info, SQUARE_GLOW);
+				sqinfo_on(square_info(c, grid), SQUARE_GLOW);
 		}
 	}
 	/*
@@ -1269,7 +1269,7 @@ static bool build_room_template(struct chunk *c, struct loc centre, int ymax,
 				/* Check consistency with first pass. */
 				assert(square_isroom(c, grid) &&
 					square_isgranite(c, grid) &&
-					sqinfo_has(square(c, grid)->info,
+					sqinfo_has(square_info(c, grid),
 					SQUARE_WALL_SOLID));
 				/*
 				 * Convert to SQUARE_WALL_INNER if it does not
@@ -1277,9 +1277,9 @@ static bool build_room_template(struct chunk *c, struct loc centre, int ymax,
 				 */
 				if (count_neighbors(NULL, c, grid,
 						square_isroom, false) == 8) {
-					sqinfo_off(square(c, grid)->info,
+					sqinfo_off(square_info(c, grid),
 						SQUARE_WALL_SOLID);
-					sqinfo_on(square(c, grid)->info,
+					sqinfo_on(square_info(c, grid),
 						SQUARE_WALL_INNER);
 				}
 				break;
@@ -1502,8 +1502,8 @@ bool build_vault(struct chunk *c, struct loc centre, struct vault *v)
 			}
 
 			/* Part of a vault */
-			sqinfo_on(square(c, grid)->info, SQUARE_ROOM);
-			if (icky) sqinfo_on(square(c, grid)->info, SQUARE_VAULT);
+			sqinfo_on(square_info(c, grid), SQUARE_ROOM);
+			if (icky) sqinfo_on(square_info(c, grid), SQUARE_VAULT);
 		}
 	}
 
@@ -1660,7 +1660,7 @@ bool build_vault(struct chunk *c, struct loc centre, struct vault *v)
 					assert(square_isroom(c, grid) &&
 						square_isvault(c, grid) &&
 						square_isgranite(c, grid) &&
-						sqinfo_has(square(c, grid)->info, SQUARE_WALL_SOLID));
+						sqinfo_has(square_info(c, grid), SQUARE_WALL_SOLID));
 					/*
 					 * Convert to SQUARE_WALL_INNER if it
 					 * does not touch the outside of the
@@ -1668,9 +1668,9 @@ bool build_vault(struct chunk *c, struct loc centre, struct vault *v)
 					 */
 					if (count_neighbors(NULL, c, grid,
 							square_isroom, false) == 8) {
-						sqinfo_off(square(c, grid)->info,
+						sqinfo_off(square_info(c, grid),
 							SQUARE_WALL_SOLID);
-						sqinfo_on(square(c, grid)->info,
+						sqinfo_on(square_info(c, grid),
 							SQUARE_WALL_INNER);
 					}
 					break;
@@ -1687,7 +1687,7 @@ bool build_vault(struct chunk *c, struct loc centre, struct vault *v)
 					 */
 					if (count_neighbors(NULL, c, grid,
 							square_isroom, false) == 8) {
-						sqinfo_on(square(c, grid)->info,
+						sqinfo_on(square_info(c, grid),
 							SQUARE_WALL_INNER);
 					}
 					break;
@@ -2067,29 +2067,29 @@ bool build_simple(struct chunk *c, struct loc centre, int rating)
 		 */
 		if (!offy) {
 			if (!offx) {
-				sqinfo_off(square(c, loc(x1 - 1, y1 - 1))->info,
+				sqinfo_off(square_info(c, loc(x1 - 1, y1 - 1)),
 					SQUARE_ROOM);
-				sqinfo_off(square(c, loc(x1 - 1, y1 - 1))->info,
+				sqinfo_off(square_info(c, loc(x1 - 1, y1 - 1)),
 					SQUARE_WALL_OUTER);
 			}
 			if ((x2 - x1 - offx) % 2 == 0) {
-				sqinfo_off(square(c, loc(x2 + 1, y1 - 1))->info,
+				sqinfo_off(square_info(c, loc(x2 + 1, y1 - 1)),
 					SQUARE_ROOM);
-				sqinfo_off(square(c, loc(x2 + 1, y1 - 1))->info,
+				sqinfo_off(square_info(c, loc(x2 + 1, y1 - 1)),
 					SQUARE_WALL_OUTER);
 			}
 		}
 		if ((y2 - y1 - offy) % 2 == 0) {
 			if (!offx) {
-				sqinfo_off(square(c, loc(x1 - 1, y2 + 1))->info,
+				sqinfo_off(square_info(c, loc(x1 - 1, y2 + 1)),
 					SQUARE_ROOM);
-				sqinfo_off(square(c, loc(x1 - 1, y2 + 1))->info,
+				sqinfo_off(square_info(c, loc(x1 - 1, y2 + 1)),
 					SQUARE_WALL_OUTER);
 			}
 			if ((x2 - x1 - offx) % 2 == 0) {
-				sqinfo_off(square(c, loc(x2 + 1, y2 + 1))->info,
+				sqinfo_off(square_info(c, loc(x2 + 1, y2 + 1)),
 					SQUARE_ROOM);
-				sqinfo_off(square(c, loc(x2 + 1, y2 + 1))->info,
+				sqinfo_off(square_info(c, loc(x2 + 1, y2 + 1)),
 					SQUARE_WALL_OUTER);
 			}
 		}
@@ -3462,11 +3462,11 @@ bool build_room_of_chambers(struct chunk *c, struct loc centre, int rating)
 					if (!square_in_bounds(c, grid1)) continue;
 
 					/* Turn into room, forbid stairs. */
-					sqinfo_on(square(c, grid1)->info, SQUARE_ROOM);
-					sqinfo_on(square(c, grid1)->info, SQUARE_NO_STAIRS);
+					sqinfo_on(square_info(c, grid1), SQUARE_ROOM);
+					sqinfo_on(square_info(c, grid1), SQUARE_NO_STAIRS);
 
 					/* Illuminate if requested. */
-					if (light) sqinfo_on(square(c, grid1)->info, SQUARE_GLOW);
+					if (light) sqinfo_on(square_info(c, grid1), SQUARE_GLOW);
 				}
 			}
 		}
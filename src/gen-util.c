@@ -252,8 +252,103 @@ bool cave_find_in_range(struct chunk *c, struct loc *grid,
 }
 
 
+/**
+ * Number of grids picked at random by cave_find() before it checks all the
+ * grids with suitable terrain
+ */
+#define CAVE_FIND_TRIES 32
+
+static bool feat_is_arrivable(int feat)
+{
+	return feat_is_floor(feat) || tf_has(f_info[feat].flags, TF_STAIR);
+}
+
+static bool feat_is_upstairs(int feat)
+{
+	return tf_has(f_info[feat].flags, TF_UPSTAIR);
+}
+
+static bool feat_is_downstairs(int feat)
+{
+	return tf_has(f_info[feat].flags, TF_DOWNSTAIR);
+}
+
+/**
+ * Predicates which can only hold on grids whose terrain passes a test, so
+ * cave_find() need only look at those grids
+ */
+static const struct {
+	square_predicate pred;
+	bool (*feat_ok)(int feat);
+} cave_find_terrain[] = {
+	{ square_isempty, feat_is_floor },
+	{ square_isopen, feat_is_floor },
+	{ square_isfloor, feat_is_floor },
+	{ square_allows_summon, feat_is_floor },
+	{ square_suits_stairs_well, feat_is_floor },
+	{ square_suits_stairs_ok, feat_is_floor },
+	{ square_isarrivable, feat_is_arrivable },
+	{ square_canputitem, feat_is_object_holding },
+	{ square_isobjectholding, feat_is_object_holding },
+	{ square_isupstairs, feat_is_upstairs },
+	{ square_isdownstairs, feat_is_downstairs },
+};
+
+/**
+ * Locate a square satisfying the given predicate among those whose terrain
+ * passes the given test.  Any of the suitable squares is equally likely.
+ */
+static bool cave_find_by_terrain(struct chunk *c, struct loc *grid,
+		square_predicate pred, bool (*feat_ok)(int feat))
+{
+	const int *grids[FEAT_MAX];
+	int counts[FEAT_MAX];
+	int total = 0, tries, f, k, n, *order;
+	bool found = false;
+
+	for (f = 0; f < FEAT_MAX; f++) {
+		counts[f] = feat_ok(f) ? cave_terrain_grids(c, f, &grids[f]) : 0;
+		total += counts[f];
+	}
+	if (!total) return false;
+
+	/* Pick grids at random; usually one will soon do */
+	for (tries = 0; tries < CAVE_FIND_TRIES; tries++) {
+		k = randint0(total);
+		for (f = 0; k >= counts[f]; f++) {
+			k -= counts[f];
+		}
+		*grid = loc(grids[f][k] % c->width, grids[f][k] / c->width);
+		if (pred(c, *grid)) return true;
+	}
+
+	/* Otherwise try them all, in random order */
+	order = mem_alloc(total * sizeof(*order));
+	for (f = 0, n = 0; f < FEAT_MAX; f++) {
+		if (counts[f]) {
+			memcpy(order + n, grids[f], counts[f] * sizeof(*order));
+			n += counts[f];
+		}
+	}
+	for (n = 0; !found && n < total; n++) {
+		int j = randint0(total - n) + n;
+
+		k = order[j];
+		order[j] = order[n];
+		order[n] = k;
+		*grid = loc(k % c->width, k / c->width);
+		found = pred(c, *grid);
+	}
+	mem_free(order);
+	return found;
+}
+
 /**
  * Locate a square in the dungeon which satisfies the given predicate.
+ *
+ * The common predicates only look at the squares with suitable terrain, which
+ * the chunk keeps track of; any square satisfying the predicate is equally
+ * likely to be found either way.
  * \param c current chunk
  * \param grid found grid
  * \param pred square_predicate specifying what we're looking for
@@ -263,6 +358,14 @@ bool cave_find(struct chunk *c, struct loc *grid, square_predicate pred)
 {
 	struct loc top_left = loc(0, 0);
 	struct loc bottom_right = loc(c->width - 1, c->height - 1);
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(cave_find_terrain); i++) {
+		if (cave_find_terrain[i].pred == pred) {
+			return cave_find_by_terrain(c, grid, pred,
+				cave_find_terrain[i].feat_ok);
+		}
+	}
 	return cave_find_in_range(c, grid, top_left, bottom_right, pred);
 }
 
@@ -349,6 +452,38 @@ void rand_dir(struct loc *offset)
 }
 
 
+/**
+ * Number of walls around the player's starting grid, for square_suits_start()
+ */
+static int start_walls;
+
+/**
+ * Predicates for find_start(), which keep away from the edge of the chunk
+ */
+static bool square_suits_start_well(struct chunk *c, struct loc grid)
+{
+	return square_in_bounds_fully(c, grid) &&
+		square_suits_stairs_well(c, grid);
+}
+
+static bool square_suits_start_ok(struct chunk *c, struct loc grid)
+{
+	return square_in_bounds_fully(c, grid) &&
+		square_suits_stairs_ok(c, grid);
+}
+
+static bool square_suits_start(struct chunk *c, struct loc grid)
+{
+	if (!square_in_bounds_fully(c, grid) || !square_isempty(c, grid)
+			|| square_isvault(c, grid)
+			|| square_isno_stairs(c, grid)) {
+		return false;
+	}
+	return square_num_walls_adjacent(c, grid) +
+		square_num_walls_diagonal(c, grid) == start_walls;
+}
+
+
 /**
  * Locate a valid starting point for the player in a chunk
  * \param c is the chunk of interest
@@ -358,48 +493,21 @@ void rand_dir(struct loc *offset)
  */
 static bool find_start(struct chunk *c, struct loc *grid)
 {
-	int *state = cave_find_init(loc(1, 1),
-		loc(c->width - 2, c->height - 2));
-	bool found = false;
-
 	/* Find the best possible place */
-	while (!found && cave_find_get_grid(grid, state)) {
-		found = square_suits_stairs_well(c, *grid);
-	}
-
-	if (!found) {
-		cave_find_reset(state);
-		while (!found && cave_find_get_grid(grid, state)) {
-			found = square_suits_stairs_ok(c, *grid);
-		}
+	if (cave_find_by_terrain(c, grid, square_suits_start_well, feat_is_floor)
+			|| cave_find_by_terrain(c, grid, square_suits_start_ok,
+			feat_is_floor)) {
+		return true;
 	}
 
-	if (!found) {
-		int walls = 6;
-
-		/* Gradually reduce number of walls if having trouble */
-		while (!found && walls >= 0) {
-			cave_find_reset(state);
-			while (!found && cave_find_get_grid(grid, state)) {
-				int total_walls;
-
-				if (!square_isempty(c, *grid)
-						|| square_isvault(c, *grid)
-						|| square_isno_stairs(c, *grid)) {
-					continue;
-				}
-				total_walls =
-					square_num_walls_adjacent(c, *grid) +
-					square_num_walls_diagonal(c, *grid);
-				found = (total_walls == walls);
-			}
-			walls--;
+	/* Gradually reduce number of walls if having trouble */
+	for (start_walls = 6; start_walls >= 0; start_walls--) {
+		if (cave_find_by_terrain(c, grid, square_suits_start,
+				feat_is_floor)) {
+			return true;
 		}
 	}
-
-	mem_free(state);
-
-	return found;
+	return false;
 }
 
 
@@ -756,6 +864,29 @@ int alloc_objects(struct chunk *c, int set, int typ, int num, int depth,
 }
 
 
+/**
+ * Where alloc_object() may place things, for square_suits_alloc()
+ */
+static int alloc_set;
+
+/**
+ * True if the square is empty, away from the edge, and in a corridor or a
+ * room as alloc_set allows.
+ */
+static bool square_suits_alloc(struct chunk *c, struct loc grid)
+{
+	/*
+	 * If we're ok with a corridor and we're in one, we're done.
+	 * If we are ok with a room and we're in one, we're done
+	 */
+	bool matched = ((alloc_set & SET_CORR) && !square_isroom(c, grid))
+		|| ((alloc_set & SET_ROOM) && square_isroom(c, grid));
+
+	return matched && square_in_bounds_fully(c, grid) &&
+		square_isempty(c, grid);
+}
+
+
 /**
  * Allocates a single random object in the dungeon.
  * \param c the current chunk
@@ -769,46 +900,35 @@ int alloc_objects(struct chunk *c, int set, int typ, int num, int depth,
  */
 bool alloc_object(struct chunk *c, int set, int typ, int depth, uint8_t origin)
 {
-	bool placed = false;
-	int *state = cave_find_init(loc(1, 1),
-		loc(c->width - 2, c->height - 2));
 	struct loc grid;
 
-	while (!placed && cave_find_get_grid(&grid, state)) {
-		/*
-		 * If we're ok with a corridor and we're in one, we're done.
-		 * If we are ok with a room and we're in one, we're done
-		 */
-		bool matched = ((set & SET_CORR) && !square_isroom(c, grid))
-			|| ((set & SET_ROOM) && square_isroom(c, grid));
-		if (square_isempty(c, grid) && matched) {
-			/* Place something */
-			switch (typ) {
-			case TYP_RUBBLE:
-				place_rubble(c, grid);
-				break;
-			case TYP_TRAP:
-				place_trap(c, grid, -1, depth);
-				break;
-			case TYP_GOLD:
-				place_gold(c, grid, depth, origin);
-				break;
-			case TYP_OBJECT:
-				place_object(c, grid, depth, false, false, origin, 0);
-				break;
-			case TYP_GOOD:
-				place_object(c, grid, depth, true, false, origin, 0);
-				break;
-			case TYP_GREAT:
-				place_object(c, grid, depth, true, true, origin, 0);
-				break;
-			}
-			placed = true;
-		}
+	alloc_set = set;
+	if (!cave_find_by_terrain(c, &grid, square_suits_alloc, feat_is_floor)) {
+		return false;
 	}
 
-	mem_free(state);
-	return placed;
+	/* Place something */
+	switch (typ) {
+	case TYP_RUBBLE:
+		place_rubble(c, grid);
+		break;
+	case TYP_TRAP:
+		place_trap(c, grid, -1, depth);
+		break;
+	case TYP_GOLD:
+		place_gold(c, grid, depth, origin);
+		break;
+	case TYP_OBJECT:
+		place_object(c, grid, depth, false, false, origin, 0);
+		break;
+	case TYP_GOOD:
+		place_object(c, grid, depth, true, false, origin, 0);
+		break;
+	case TYP_GREAT:
+		place_object(c, grid, depth, true, true, origin, 0);
+		break;
+	}
+	return true;
 }
 
 /**
@@ -46,6 +46,7 @@
 #include "player-quest.h"
 #include "player-util.h"
 #include "trap.h"
+#include "z-prof.h"
 #include "z-queue.h"
 #include "z-type.h"
 
@@ -692,7 +693,7 @@ static void place_feeling(struct chunk *c)
 				continue;
 
 			/* Set the cave square appropriately */
-			sqinfo_on(square(c, grid)->info, SQUARE_FEEL);
+			sqinfo_on(square_info(c, grid), SQUARE_FEEL);
 			
 			break;
 		}
@@ -1090,6 +1091,8 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 	int i, tries = 0;
 	struct chunk *chunk = NULL;
 
+	PROF_BEGIN(PROF_CAVE_GENERATE);
+
 	/* Arena levels handled separately */
 	if (p->upkeep->arena_level) {
 		/* Generate level */
@@ -1109,6 +1112,7 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 		wiz_light(chunk, p, false);
 		chunk->turn = turn;
 
+		PROF_END(PROF_CAVE_GENERATE);
 		return chunk;
 	}
 
@@ -1195,10 +1199,10 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 			for (x = 0; x < chunk->width; x++) {
 				struct loc grid = loc(x, y);
 
-				sqinfo_off(square(chunk, grid)->info, SQUARE_WALL_INNER);
-				sqinfo_off(square(chunk, grid)->info, SQUARE_WALL_OUTER);
-				sqinfo_off(square(chunk, grid)->info, SQUARE_WALL_SOLID);
-				sqinfo_off(square(chunk, grid)->info, SQUARE_MON_RESTRICT);
+				sqinfo_off(square_info(chunk, grid), SQUARE_WALL_INNER);
+				sqinfo_off(square_info(chunk, grid), SQUARE_WALL_OUTER);
+				sqinfo_off(square_info(chunk, grid), SQUARE_WALL_SOLID);
+				sqinfo_off(square_info(chunk, grid), SQUARE_MON_RESTRICT);
 
 				if (square_isstairs(chunk, grid)) {
 					size_t n;
@@ -1207,7 +1211,7 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 					new->feat = square_feat(chunk, grid)->fidx;
 					new->info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
 					for (n = 0; n < SQUARE_SIZE; n++) {
-						new->info[n] = square(chunk, grid)->info[n];
+						new->info[n] = square_info(chunk, grid)[n];
 					}
 					new->next = chunk->join;
 					chunk->join = new;
@@ -1259,6 +1263,7 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 
 	chunk->turn = turn;
 
+	PROF_END(PROF_CAVE_GENERATE);
 	return chunk;
 }
 
@@ -69,6 +69,7 @@
 #include "ui-entry.h"
 #include "ui-entry-init.h"
 #include "ui-visuals.h"
+#include "z-prof.h"
 
 bool play_again = false;
 
@@ -4475,6 +4476,8 @@ static struct init_module arrays_module = {
 
 extern struct init_module z_quark_module;
 extern struct init_module generate_module;
+extern struct init_module view_module;
+extern struct init_module project_module;
 extern struct init_module rune_module;
 extern struct init_module obj_make_module;
 extern struct init_module ignore_module;
@@ -4493,6 +4496,8 @@ static struct init_module *modules[] = {
 	&arrays_module,
 	&player_module,
 	&generate_module,
+	&view_module,
+	&project_module,
 	&rune_module,
 	&obj_make_module,
 	&ignore_module,
@@ -4552,6 +4557,16 @@ void cleanup_angband(void)
 {
 	int i;
 
+#ifdef ALLOW_PROFILING
+	/* Write out the hot path timings */
+	if (ANGBAND_DIR_USER) {
+		char buf[1024];
+
+		path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "profile.csv");
+		(void)prof_write_csv(buf);
+	}
+#endif
+
 	/* Free the chunk list */
 	for (i = 0; i < chunk_list_max; i++) {
 		wipe_mon_list(chunk_list[i], player);
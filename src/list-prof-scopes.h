@@ -0,0 +1,20 @@
+/**
+ * \file list-prof-scopes.h
+ * \brief hot paths timed when built with ALLOW_PROFILING
+ *
+ * The scopes nest (update_view runs inside update_stuff, which runs inside
+ * handle_stuff), so their times overlap; see z-prof.h.
+ */
+
+/*  symbol		name */
+PROF(PROCESS_MONSTERS,	"process_monsters")
+PROF(MONSTER_TURN,	"monster_turn")
+PROF(UPDATE_VIEW,	"update_view")
+PROF(CALC_LIGHTING,	"calc_lighting")
+PROF(MAKE_NOISE,	"make_noise")
+PROF(UPDATE_SCENT,	"update_scent")
+PROF(HANDLE_STUFF,	"handle_stuff")
+PROF(UPDATE_STUFF,	"update_stuff")
+PROF(TERM_FRESH,	"Term_fresh")
+PROF(PROJECT,		"project")
+PROF(CAVE_GENERATE,	"cave_generate")
@@ -1308,7 +1308,7 @@ static int rd_dungeon_aux(struct chunk **c)
 	c1 = cave_new(height, width);
 	c1->name = string_make(name);
 
-    /* Run length decoding of cave->squares[y][x].info */
+    /* Run length decoding of the square flags */
 	for (n = 0; n < square_size; n++) {
 		/* Load the dungeon data */
 		for (x = y = 0; y < c1->height; ) {
@@ -1319,7 +1319,7 @@ static int rd_dungeon_aux(struct chunk **c)
 			/* Apply the RLE info */
 			for (i = count; i > 0; i--) {
 				/* Extract "info" */
-				c1->squares[y][x].info[n] = tmp8u;
+				square_info(c1, loc(x, y))[n] = tmp8u;
 
 				/* Advance/Wrap */
 				if (++x >= c1->width) {
@@ -120,6 +120,32 @@ static rect_t rect(int x, int y, int cx, int cy)
     return r;
 }
 
+/**
+ * A span of text or blanks to be drawn at the end of a Term_fresh() pass
+ */
+struct gcu_span {
+	int x, y, n;
+	int mode;               /* Curses attributes to draw with */
+	int text;               /* Start of the characters in the batch text,
+	                         * or -1 if the span is all blanks */
+	bool to_eol;            /* The blanks run to the end of the line */
+};
+
+/**
+ * The output of a Term_fresh() pass, held back until it is over
+ */
+struct gcu_batch {
+	struct gcu_span *spans;
+	int count, alloc;
+	wchar_t *text;
+	int len, text_alloc;
+};
+
+/**
+ * Longest gap of blanks between two spans to draw in the color before it
+ */
+#define GCU_GAP_MAX 4
+
 /**
  * Information about a term
  */
@@ -127,6 +153,7 @@ typedef struct term_data {
 	term t;                 /* All term info */
 	rect_t r;
 	WINDOW *win;            /* Pointer to the curses window */
+	struct gcu_batch batch; /* Output waiting for the end of the pass */
 } term_data;
 
 /* Max number of windows on screen */
@@ -172,6 +199,13 @@ static int colortable[BASIC_COLORS];
  */
 static int same_colortable[BASIC_COLORS];
 
+/**
+ * The colors last given to init_color(), so they are only sent to the
+ * terminal again when they change
+ */
+static short sent_colors[BASIC_COLORS][3];
+static bool sent_colors_valid = false;
+
 /* Screen info: use one big Term 0, or other subwindows? */
 static bool bold_extended = false;
 static bool use_default_background = false;
@@ -282,6 +316,11 @@ static errr Term_xtra_gcu_alive(int v) {
 		/* Go to normal keymap mode */
 		keymap_norm();
 
+#ifdef A_COLOR
+		/* Whatever runs meanwhile may change the terminal's colors */
+		sent_colors_valid = false;
+#endif
+
 		/* Restore modes */
 		nocbreak();
 		echo();
@@ -623,6 +662,11 @@ static void Term_nuke_gcu(term *t) {
 	/* Delete this window */
 	delwin(td->win);
 
+	/* Forget its output */
+	mem_free(td->batch.spans);
+	mem_free(td->batch.text);
+	memset(&td->batch, 0, sizeof(td->batch));
+
 	/* Count nuke's, handle last */
 	if (--active != 0) return;
 
@@ -1014,16 +1058,26 @@ static void handle_extended_color_tables(void) {
 				 * Scale components to a range of 0 - 1000 per
 				 * init_color()'s documentation.
 				 */
-				init_color(i,
-					(angband_color_table[i][1] * 1001) / 256,
-					(angband_color_table[i][2] * 1001) / 256,
-					(angband_color_table[i][3] * 1001) / 256);
+				short r = (angband_color_table[i][1] * 1001) / 256;
+				short g = (angband_color_table[i][2] * 1001) / 256;
+				short b = (angband_color_table[i][3] * 1001) / 256;
+
+				/* Each change is a message to the terminal */
+				if (!sent_colors_valid || sent_colors[i][0] != r
+						|| sent_colors[i][1] != g
+						|| sent_colors[i][2] != b) {
+					init_color(i, r, g, b);
+					sent_colors[i][0] = r;
+					sent_colors[i][1] = g;
+					sent_colors[i][2] = b;
+				}
 				init_pair(i + 1, i, bg_color);
 				colortable[i] = COLOR_PAIR(i + 1) | isbold;
 				init_pair(BASIC_COLORS + i, i, i);
 				same_colortable[i] =
 					COLOR_PAIR(BASIC_COLORS + i) | isbold;
 			}
+			sent_colors_valid = true;
 		}
 
 		for (i = 0; i < term_count; ++i) {
@@ -1050,12 +1104,164 @@ static void handle_extended_color_tables(void) {
 }
 
 
+/**
+ * Hold back a span of output until the end of the Term_fresh() pass;
+ * s is NULL for blanks
+ */
+static void gcu_batch_add(term_data *td, int x, int y, int n, int mode,
+		const wchar_t *s, bool to_eol)
+{
+	struct gcu_batch *b = &td->batch;
+	struct gcu_span *sp;
+	int i;
+
+	if (b->count == b->alloc) {
+		b->alloc = b->alloc ? 2 * b->alloc : 64;
+		b->spans = mem_realloc(b->spans, b->alloc * sizeof(*b->spans));
+	}
+	sp = &b->spans[b->count++];
+	sp->x = x;
+	sp->y = y;
+	sp->n = n;
+	sp->mode = mode;
+	sp->text = -1;
+	sp->to_eol = to_eol;
+
+	/* Text which is only spaces counts as blanks */
+	if (!s) return;
+	for (i = 0; i < n && s[i] == L' '; i++) ;
+	if (i == n) return;
+
+	if (b->len + n > b->text_alloc) {
+		while (b->len + n > b->text_alloc)
+			b->text_alloc = b->text_alloc ? 2 * b->text_alloc : 1024;
+		b->text = mem_realloc(b->text, b->text_alloc * sizeof(*b->text));
+	}
+	memcpy(b->text + b->len, s, n * sizeof(*s));
+	sp->text = b->len;
+	b->len += n;
+}
+
+#ifdef A_COLOR
+/**
+ * Check whether blanks look the same drawn with either of two sets of
+ * attributes; only the background shows, unless the colors are swapped or
+ * there is more than boldness to the attributes
+ */
+static bool gcu_blank_alike(int mode, int other)
+{
+	short fg, bg, other_fg, other_bg;
+
+	if ((mode | other) & A_ATTRIBUTES & ~(A_COLOR | A_BOLD)) return false;
+	pair_content(PAIR_NUMBER(mode), &fg, &bg);
+	pair_content(PAIR_NUMBER(other), &other_fg, &other_bg);
+	return bg == other_bg;
+}
+#endif
+
+/**
+ * Pick the attributes for a span of blanks.  If the cell beside it looks
+ * the same behind a blank, take its attributes, so curses can carry on
+ * from that cell without a change of color.
+ */
+static int gcu_blank_mode(term_data *td, const struct gcu_span *sp)
+{
+#ifdef A_COLOR
+	if (can_use_color) {
+		int side;
+
+		if (sp->x > 0) {
+			side = mvwinch(td->win, sp->y, sp->x - 1) & A_ATTRIBUTES;
+			if (gcu_blank_alike(sp->mode, side)) return side;
+		}
+		if (sp->x + sp->n < td->t.wid) {
+			side = mvwinch(td->win, sp->y, sp->x + sp->n) & A_ATTRIBUTES;
+			if (gcu_blank_alike(sp->mode, side)) return side;
+		}
+	}
+#endif
+
+	return sp->mode;
+}
+
+/**
+ * Draw the output held back from a Term_fresh() pass.
+ *
+ * The spans of a pass never overlap, so they can go into the window in any
+ * order; curses then sends the changed cells in screen order, moving the
+ * cursor and changing colors as little as it can, in one write.  What it
+ * cannot do is see that blanks look the same in any color with the same
+ * background, so it changes colors for them.  Drawing the text first lets
+ * each span of blanks, and each short gap of blanks between two spans,
+ * take the color of a neighbour instead, which saves a pair of color
+ * changes each time.
+ */
+static void gcu_batch_flush(term_data *td)
+{
+	struct gcu_batch *b = &td->batch;
+	int i;
+
+	if (!b->count) return;
+
+	for (i = 0; i < b->count; i++) {
+		const struct gcu_span *sp = &b->spans[i];
+
+		if (sp->text < 0) continue;
+		wattrset(td->win, sp->mode);
+		mvwaddnwstr(td->win, sp->y, sp->x, b->text + sp->text, sp->n);
+	}
+
+	for (i = 0; i < b->count; i++) {
+		const struct gcu_span *sp = &b->spans[i];
+
+		if (sp->text >= 0) continue;
+		if (sp->to_eol) {
+			/* Clear to end of line */
+			wmove(td->win, sp->y, sp->x);
+			wclrtoeol(td->win);
+		} else {
+			wattrset(td->win, gcu_blank_mode(td, sp));
+			mvwhline(td->win, sp->y, sp->x, ' ', sp->n);
+		}
+	}
+
+#ifdef A_COLOR
+	for (i = 0; can_use_color && i + 1 < b->count; i++) {
+		const struct gcu_span *sp = &b->spans[i];
+		int x = sp->x + sp->n, gap = b->spans[i + 1].x - x, mode, j;
+
+		/* Only gaps short enough that curses would rather redraw them */
+		if (b->spans[i + 1].y != sp->y || gap < 1 || gap > GCU_GAP_MAX)
+			continue;
+		mode = mvwinch(td->win, sp->y, x - 1) & A_ATTRIBUTES;
+		for (j = 0; j < gap; j++) {
+			chtype c = mvwinch(td->win, sp->y, x + j);
+
+			if ((c & A_CHARTEXT) != ' '
+					|| (c & A_ATTRIBUTES) == (chtype) mode
+					|| !gcu_blank_alike(mode, c & A_ATTRIBUTES)) break;
+		}
+		if (j < gap) continue;
+		wattrset(td->win, mode);
+		mvwhline(td->win, sp->y, x, ' ', gap);
+	}
+#endif
+
+	wattrset(td->win, A_NORMAL);
+	b->count = 0;
+	b->len = 0;
+}
+
+
 /**
  * Handle a "special request"
  */
 static errr Term_xtra_gcu(int n, int v) {
 	term_data *td = (term_data *)(Term->data);
 
+	/* Finish any pass in progress first */
+	gcu_batch_flush(td);
+
 	/* Analyze the request */
 	switch (n) {
 		/* Clear screen */
@@ -1100,6 +1306,7 @@ static errr Term_xtra_gcu(int n, int v) {
  */
 static errr Term_curs_gcu(int x, int y) {
 	term_data *td = (term_data *)(Term->data);
+	gcu_batch_flush(td);
 	wmove(td->win, y, x);
 	return 0;
 }
@@ -1111,23 +1318,16 @@ static errr Term_curs_gcu(int x, int y) {
  */
 static errr Term_wipe_gcu(int x, int y, int n) {
 	term_data *td = (term_data *)(Term->data);
+	int mode = A_NORMAL;
 
-	wmove(td->win, y, x);
-
-	if (x + n >= td->t.wid) {
-		/* Clear to end of line */
-		wclrtoeol(td->win);
-	} else {
-		/* Clear some characters */
-		if (can_use_color) {
-			wattrset(td->win, colortable[COLOUR_DARK] | A_NORMAL);
-		}
-		whline(td->win, ' ', n);
-		if (can_use_color) {
-			wattrset(td->win, A_NORMAL);
-		}
+	/* Clear some characters */
+	if (can_use_color) {
+		mode = colortable[COLOUR_DARK] | A_NORMAL;
 	}
 
+	/* Or clear to end of line */
+	gcu_batch_add(td, x, y, n, mode, NULL, x + n >= td->t.wid);
+
 	return 0;
 }
 
@@ -1137,6 +1337,7 @@ static errr Term_wipe_gcu(int x, int y, int n) {
  */
 static errr Term_text_gcu(int x, int y, int n, int a, const wchar_t *s) {
 	term_data *td = (term_data *)(Term->data);
+	int mode = A_NORMAL;
 
 #ifdef A_COLOR
 	if (can_use_color) {
@@ -1157,22 +1358,16 @@ static errr Term_text_gcu(int x, int y, int n, int a, const wchar_t *s) {
 		}
 
 		/* the following check for A_BRIGHT is to avoid #1813 */
-		int mode;
 		if (reversed && (color & A_BRIGHT))
 			mode = (color & ~A_BRIGHT) | A_BLINK | A_REVERSE;
 		else if (reversed)
 			mode = color | A_REVERSE;
 		else
 			mode = color | A_NORMAL;
-
-		wattrset(td->win, mode);
-		mvwaddnwstr(td->win, y, x, s, n);
-		wattrset(td->win, A_NORMAL);
-		return 0;
 	}
 #endif
 
-	mvwaddnwstr(td->win, y, x, s, n);
+	gcu_batch_add(td, x, y, n, mode, s, false);
 	return 0;
 }
 
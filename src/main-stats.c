@@ -44,6 +44,11 @@
 #include "store.h"
 #include <stddef.h>
 #include <time.h>
+#ifdef UNIX
+#include <errno.h>
+#include <poll.h>
+#include <sys/wait.h>
+#endif
 
 #define OBJ_FEEL_MAX	 11
 #define MON_FEEL_MAX 	 10
@@ -140,6 +145,9 @@ static const char *chosen_race = NULL;
 static int randarts = 0;
 static int no_selling = 0;
 static uint32_t num_runs = 1;
+static int num_workers = 1;
+static bool have_seed = false;
+static uint32_t run_seed = 0;
 static bool quiet = false;
 static int nextkey = 0;
 static int running_stats = 0;
@@ -500,18 +508,22 @@ static void generate_player_for_stats(void)
 	player->history = get_history(player->race->history);
 }
 
-static void initialize_character(void)
+/**
+ * Set up the character for the given run.  Each run has its own seed, so
+ * runs made at the same time, or by different workers, differ, and a given
+ * run comes out the same whichever worker makes it.
+ */
+static void initialize_character(uint32_t run)
 {
-	uint32_t seed;
+	int i;
 
 	if (!quiet) {
 		printf(" [I  ]\b\b\b\b\b\b");
 		fflush(stdout);
 	}
 
-	seed = (time(NULL));
 	Rand_quick = false;
-	Rand_state_init(seed);
+	Rand_state_init(run_seed + run);
 
 	player_init(player);
 	generate_player_for_stats();
@@ -523,6 +535,10 @@ static void initialize_character(void)
 		do_randart(seed_randart, false);
 	}
 
+	/* Start from no shopkeepers, as the first run did */
+	for (i = 0; i < z_info->store_max; i++) {
+		stores[i].owner = NULL;
+	}
 	store_reset();
 	flavor_init();
 	player->upkeep->playing = true;
@@ -1720,6 +1736,14 @@ static void progress_bar(uint32_t run, time_t start) {
 
 static void stats_cleanup_angband_run(void)
 {
+	struct chunk *town = chunk_find_name("Town");
+
+	/* Forget the town, so the next run builds its own as the first did */
+	if (town) {
+		chunk_list_remove("Town");
+		cave_free(town);
+	}
+
 	if (character_dungeon) {
 		wipe_mon_list(cave, player);
 		if (player->cave) {
@@ -1736,11 +1760,321 @@ static void stats_cleanup_angband_run(void)
 	player->history = NULL;
 }
 
+/**
+ * Write what has been seen so far to the database, giving up if that fails.
+ */
+static void stats_checkpoint(uint32_t run)
+{
+	int err = stats_write_db(run);
+
+	if (err) {
+		stats_db_close();
+		quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
+	}
+}
+
+static struct artifact *a_info_save = NULL;
+static struct artifact_upkeep *aup_info_save = NULL;
+
+/**
+ * Make one run through the dungeon, adding what was seen to level_data.
+ */
+static void stats_one_run(uint32_t run)
+{
+	unsigned int i;
+
+	if (randarts) {
+		for (i = 0; i < z_info->a_max; i++) {
+			memcpy(&a_info[i], &a_info_save[i],
+				sizeof(struct artifact));
+			memcpy(&aup_info[i], &aup_info_save[i],
+				sizeof(struct artifact_upkeep));
+		}
+	}
+
+	initialize_character(run);
+	unkill_uniques();
+	reset_artifacts();
+	descend_dungeon();
+	stats_cleanup_angband_run();
+}
+
+#ifdef UNIX
+
+/**
+ * State for sending the counts in level_data from a worker to the reducer,
+ * or adding what a worker sent to the reducer's own counts.  Only the
+ * counts which aren't zero are sent, each as its place in the order
+ * stats_walk_counts() visits them and its value; the last is followed by
+ * UINT32_MAX.  Before that, a worker sends STATS_RUN_DONE as each of its runs
+ * finishes, so the reducer can keep the progress bar moving.
+ */
+#define STATS_RUN_DONE	(UINT32_MAX - 1)
+
+struct stats_transfer {
+	FILE *f;
+	uint32_t pos;		/**< place of the first count being visited */
+	uint32_t next_pos;	/**< place of the next count read */
+	uint64_t next_value;	/**< value of the next count read */
+	bool ok;
+};
+
+typedef void (*stats_count_visitor)(void *counts, int n, bool wide,
+	struct stats_transfer *st);
+
+/**
+ * Call visit on each array of counts in level_data, always in the same
+ * order.  wide is true for arrays of long long, false for arrays of uint32_t.
+ */
+static void stats_walk_counts(stats_count_visitor visit,
+		struct stats_transfer *st)
+{
+	int level, i, j, k;
+
+	for (level = 1; level < LEVEL_MAX; level++) {
+		struct level_data *ld = &level_data[level];
+
+		visit(ld->monsters, z_info->r_max, false, st);
+		visit(ld->obj_feelings, OBJ_FEEL_MAX, false, st);
+		visit(ld->mon_feelings, MON_FEEL_MAX, false, st);
+		visit(ld->gold, ORIGIN_STATS, true, st);
+		for (i = 0; i < ORIGIN_STATS; i++) {
+			visit(ld->artifacts[i], z_info->a_max, false, st);
+			visit(ld->consumables[i], consumable_count + 1, false,
+				st);
+			for (j = 0; j < wearable_count + 1; j++) {
+				struct wearables_data *w = &ld->wearables[i][j];
+
+				visit(&w->count, 1, false, st);
+				visit(w->dice, TOP_DICE * TOP_SIDES, false, st);
+				visit(w->ac, TOP_AC, false, st);
+				visit(w->hit, TOP_PLUS, false, st);
+				visit(w->dam, TOP_PLUS, false, st);
+				visit(w->egos, z_info->e_max, false, st);
+				visit(w->flags, OF_MAX, false, st);
+				for (k = 0; k < TOP_MOD; k++) {
+					visit(w->modifiers[k], OBJ_MOD_MAX + 1,
+						false, st);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Send the counts which aren't zero, and clear them for the next batch.
+ */
+static void stats_send_counts(void *counts, int n, bool wide,
+		struct stats_transfer *st)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		uint64_t value;
+		uint32_t pos = st->pos + i;
+
+		if (wide) {
+			value = (uint64_t)((long long *)counts)[i];
+			if (!value) continue;
+			((long long *)counts)[i] = 0;
+		} else {
+			value = ((uint32_t *)counts)[i];
+			if (!value) continue;
+			((uint32_t *)counts)[i] = 0;
+		}
+		if (fwrite(&pos, sizeof(pos), 1, st->f) != 1 ||
+				fwrite(&value, sizeof(value), 1, st->f) != 1) {
+			st->ok = false;
+		}
+	}
+	st->pos += n;
+}
+
+static void stats_read_pos(struct stats_transfer *st)
+{
+	if (fread(&st->next_pos, sizeof(st->next_pos), 1, st->f) != 1) {
+		st->next_pos = UINT32_MAX;
+		st->ok = false;
+	}
+}
+
+static void stats_read_value(struct stats_transfer *st)
+{
+	if (st->next_pos != UINT32_MAX &&
+			fread(&st->next_value, sizeof(st->next_value), 1,
+			st->f) != 1) {
+		st->next_pos = UINT32_MAX;
+		st->ok = false;
+	}
+}
+
+static void stats_read_count(struct stats_transfer *st)
+{
+	stats_read_pos(st);
+	stats_read_value(st);
+}
+
+/**
+ * Add the counts a worker sent to the reducer's own.
+ */
+static void stats_add_counts(void *counts, int n, bool wide,
+		struct stats_transfer *st)
+{
+	while (st->next_pos < st->pos + n) {
+		int i = st->next_pos - st->pos;
+
+		if (wide) {
+			((long long *)counts)[i] += (long long)st->next_value;
+		} else {
+			((uint32_t *)counts)[i] += (uint32_t)st->next_value;
+		}
+		stats_read_count(st);
+	}
+	st->pos += n;
+}
+
+/**
+ * Make the runs of worker w, of num_workers, telling f as each is done and
+ * sending the counts to it after each batch of RUNS_PER_CHECKPOINT runs.
+ * This never returns.
+ */
+static void stats_worker(int w, FILE *f)
+{
+	uint32_t first, run, done = STATS_RUN_DONE, end = UINT32_MAX;
+	bool ok = true;
+
+	quiet = true;
+	for (first = 1; first <= num_runs; first += RUNS_PER_CHECKPOINT) {
+		uint32_t last = MIN(first + RUNS_PER_CHECKPOINT - 1, num_runs);
+		struct stats_transfer st = { f, 0, 0, 0, true };
+
+		for (run = first + w; run <= last; run += num_workers) {
+			stats_one_run(run);
+			if (fwrite(&done, sizeof(done), 1, f) != 1 || fflush(f)) {
+				ok = false;
+			}
+		}
+		stats_walk_counts(stats_send_counts, &st);
+		if (fwrite(&end, sizeof(end), 1, f) != 1) st.ok = false;
+		if (fflush(f)) st.ok = false;
+		ok = ok && st.ok;
+	}
+	if (fclose(f)) ok = false;
+	_exit(ok ? 0 : 1);
+}
+
+/**
+ * Split the runs between num_workers forked processes, and add what they
+ * see to level_data, a batch at a time.  The workers are started before
+ * anything is counted, so they share level_data's memory until they write
+ * to it, and each worker's runs are seeded by run number, so the totals
+ * only depend on the seed.
+ */
+static void stats_run_workers(time_t start)
+{
+	pid_t *pids = mem_zalloc(num_workers * sizeof(*pids));
+	FILE **pipes = mem_zalloc(num_workers * sizeof(*pipes));
+	struct pollfd *polls = mem_zalloc(num_workers * sizeof(*polls));
+	uint32_t first, done = 0;
+	bool ok = true;
+	int w;
+
+	fflush(stdout);
+	for (w = 0; w < num_workers; w++) {
+		int fds[2];
+
+		if (pipe(fds)) quit("Couldn't create a pipe for a worker!");
+		pids[w] = fork();
+		if (pids[w] < 0) quit("Couldn't start a worker!");
+		if (pids[w] == 0) {
+			FILE *f;
+			int i;
+
+			for (i = 0; i < w; i++) {
+				fclose(pipes[i]);
+			}
+			close(fds[0]);
+			f = fdopen(fds[1], "wb");
+			if (!f) _exit(1);
+			stats_worker(w, f);
+		}
+		close(fds[1]);
+		pipes[w] = fdopen(fds[0], "rb");
+		if (!pipes[w]) quit("Couldn't read from a worker!");
+
+		/* Unbuffered, so poll() sees everything not yet read */
+		setvbuf(pipes[w], NULL, _IONBF, 0);
+	}
+
+	if (!quiet) progress_bar(0, start);
+	for (first = 1; ok && first <= num_runs; first += RUNS_PER_CHECKPOINT) {
+		uint32_t last = MIN(first + RUNS_PER_CHECKPOINT - 1, num_runs);
+		int busy = num_workers;
+
+		for (w = 0; w < num_workers; w++) {
+			polls[w].fd = fileno(pipes[w]);
+			polls[w].events = POLLIN;
+		}
+
+		/* Count runs as they finish, and reduce each worker's batch */
+		while (ok && busy) {
+			if (poll(polls, num_workers, -1) < 0) {
+				if (errno != EINTR) ok = false;
+				continue;
+			}
+			for (w = 0; w < num_workers; w++) {
+				struct stats_transfer st = { pipes[w], 0, 0, 0, true };
+
+				if (polls[w].fd < 0 || !polls[w].revents) continue;
+				stats_read_pos(&st);
+				if (st.ok && st.next_pos == STATS_RUN_DONE) {
+					done++;
+					if (!quiet) {
+						progress_bar(done, start);
+					} else if (done % 1000 == 0) {
+						printf("Finished %d runs.\n", done);
+						fflush(stdout);
+					}
+					continue;
+				}
+				stats_read_value(&st);
+				stats_walk_counts(stats_add_counts, &st);
+				if (st.next_pos != UINT32_MAX) st.ok = false;
+				ok = ok && st.ok;
+				polls[w].fd = -1;
+				busy--;
+			}
+		}
+		if (done != last) ok = false;
+
+		if (ok && last % RUNS_PER_CHECKPOINT == 0) {
+			stats_checkpoint(last);
+		}
+	}
+
+	for (w = 0; w < num_workers; w++) {
+		int status;
+
+		fclose(pipes[w]);
+		if (waitpid(pids[w], &status, 0) != pids[w] ||
+				!WIFEXITED(status) || WEXITSTATUS(status)) {
+			ok = false;
+		}
+	}
+	mem_free(polls);
+	mem_free(pipes);
+	mem_free(pids);
+	if (!ok) {
+		stats_db_close();
+		quit("A worker failed!");
+	}
+}
+
+#endif /* UNIX */
+
 static errr run_stats(void)
 {
 	uint32_t run;
-	struct artifact *a_info_save = NULL;
-	struct artifact_upkeep *aup_info_save = NULL;
 	unsigned int i;
 	int err;
 	bool status; 
@@ -1763,44 +2097,36 @@ static errr run_stats(void)
 				sizeof(struct artifact_upkeep));
 		}
 	}
+	if (!have_seed) run_seed = (uint32_t)time(NULL);
 
 	if (!quiet) printf("Creating the database and dumping info...\n");
 	status = stats_prep_db();
 	if (!status) quit("Couldn't prepare database!");
 
 	if (!quiet) {
-		printf("Beginning %d runs...\n", num_runs);
+		if (num_workers > 1) {
+			printf("Beginning %d runs in %d processes...\n", num_runs,
+				num_workers);
+		} else {
+			printf("Beginning %d runs...\n", num_runs);
+		}
 		fflush(stdout);
 	}
 
 	start = time(NULL);
+#ifdef UNIX
+	if (num_workers > 1) {
+		stats_run_workers(start);
+		run = num_runs + 1;
+	} else
+#endif
 	for (run = 1; run <= num_runs; run++) {
 		if (!quiet) progress_bar(run - 1, start);
 
-		if (randarts) {
-			for (i = 0; i < z_info->a_max; i++) {
-				memcpy(&a_info[i], &a_info_save[i],
-					sizeof(struct artifact));
-				memcpy(&aup_info[i], &aup_info_save[i],
-					sizeof(struct artifact_upkeep));
-			}
-		}
-
-		initialize_character();
-		unkill_uniques();
-		reset_artifacts();
-		descend_dungeon();
-		stats_cleanup_angband_run();
+		stats_one_run(run);
 
 		/* Checkpoint every so many runs */
-		if (run % RUNS_PER_CHECKPOINT == 0) {
-			err = stats_write_db(run);
-			if (err) {
-				stats_db_close();
-				quit_fmt("Problems writing to database!  sqlite3 errno %d.",
-						 err);
-			}
-		}
+		if (run % RUNS_PER_CHECKPOINT == 0) stats_checkpoint(run);
 
 		if (quiet && run % 1000 == 0) {
 			printf("Finished %d runs.\n", run);
@@ -1950,12 +2276,12 @@ static void term_data_link(int i) {
 	angband_term[i] = t;
 }
 
-const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -C(class name) -R(race name)";
+const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -C(class name) -R(race name) -j(# of processes) -S(seed)";
 
 /**
  * Usage:
  *
- * angband -mstats -- [-q] [-r] [-nNNNN] [-s]
+ * angband -mstats -- [-q] [-r] [-nNNNN] [-s] [-jNN] [-SNNNN]
  *
  *   -q      Quiet mode (turn off progress messages)
  *   -r      Turn on randarts
@@ -1965,6 +2291,9 @@ const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs
  *           the player's class is the first class in lib/gamedata/class.txt.
  *   -Rname  Use name, case-insensitive, as the player's race.  When not set,
  *           the player's race is the first race in lib/gamedata/p_race.txt.
+ *   -jNN    Split the runs between NN processes (default: 1; only on Unix)
+ *   -SNNNN  Seed run N with NNNN + N, so the totals can be reproduced, with
+ *           any number of processes.  When not set, the seed is the time.
  */
 
 errr init_stats(int argc, char *argv[]) {
@@ -1988,6 +2317,21 @@ errr init_stats(int argc, char *argv[]) {
 			no_selling = 1;
 			continue;
 		}
+		if (prefix(argv[i], "-j")) {
+			num_workers = MAX(atoi(&argv[i][2]), 1);
+#ifndef UNIX
+			if (num_workers > 1) {
+				printf("init-stats: -j is only supported on Unix\n");
+				num_workers = 1;
+			}
+#endif
+			continue;
+		}
+		if (prefix(argv[i], "-S")) {
+			run_seed = (uint32_t)strtoul(&argv[i][2], NULL, 10);
+			have_seed = true;
+			continue;
+		}
 		if (prefix(argv[i], "-C")) {
 			chosen_class = argv[i] + 2;
 			continue;
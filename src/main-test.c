@@ -18,10 +18,14 @@
 
 #include "angband.h"
 #include "buildid.h"
+#include "cave.h"
 #include "main.h"
 #include "player.h"
 #include "player-birth.h"
 #include "ui-game.h"
+#include "ui-map.h"
+#include "ui-record.h"
+#include "z-rand.h"
 
 #ifdef USE_TEST
 
@@ -29,6 +33,30 @@ static int prompt = 0;
 static int verbose = 0;
 static int nextkey = 0;
 
+/**
+ * Replaying a recording from ui-record.c.  The input is handed over when
+ * the game has asked for input as many times as it had when it was recorded.
+ */
+struct replay_phase {
+	char *name;
+	clock_t time;
+	int inputs;
+};
+
+static struct {
+	bool active;
+	bool done;		/* the game has ended and been reported */
+	bool pending;		/* input has been read but not handed over */
+	ui_event input;
+	int input_asks;		/* asks before the input when recorded */
+	int asks;		/* asks since the last input was handed over */
+
+	struct replay_phase *phases;
+	int n_phases;
+	int phase;		/* the phase being timed, or -1 */
+	clock_t phase_start;
+} replay = { false, false, false, { 0 }, 0, 0, NULL, 0, -1, 0 };
+
 static void c_key(char *rest) {
 	if (streq(rest, "left")) {
 		nextkey = ARROW_LEFT;
@@ -71,6 +99,175 @@ static void c_version(char *rest) {
 	printf("cmd-version: %s\n", buildid);
 }
 
+/**
+ * Replay commands
+ */
+static void replay_end_phase(void) {
+	if (replay.phase >= 0) {
+		replay.phases[replay.phase].time += clock() - replay.phase_start;
+		replay.phase = -1;
+	}
+}
+
+static void replay_print_phases(void) {
+	clock_t time = 0;
+	int inputs = 0, i;
+
+	for (i = 0; i < replay.n_phases; i++) {
+		printf("replay-phase: %s %.3fs %d inputs\n", replay.phases[i].name,
+			(double)replay.phases[i].time / CLOCKS_PER_SEC,
+			replay.phases[i].inputs);
+		time += replay.phases[i].time;
+		inputs += replay.phases[i].inputs;
+	}
+	printf("replay-total: %.3fs %d inputs\n", (double)time / CLOCKS_PER_SEC,
+		inputs);
+}
+
+static void replay_report(void) {
+	int i;
+
+	replay_end_phase();
+	replay_print_phases();
+	printf("state-hash: %08lx\n", (unsigned long)record_state_hash());
+	for (i = 0; i < replay.n_phases; i++) {
+		string_free(replay.phases[i].name);
+	}
+	mem_free(replay.phases);
+	replay.phases = NULL;
+	replay.n_phases = 0;
+	replay.done = true;
+}
+
+static void replay_begin(void) {
+	if (replay.active) return;
+	replay.active = true;
+	record_end_hook = replay_report;
+
+	/* Reading this was the first time the game asked for input */
+	replay.asks = 1;
+}
+
+static void c_seed(char *rest) {
+	if (!rest) {
+		printf("seed: missing seed\n");
+		return;
+	}
+	Rand_quick = false;
+	Rand_state_init((uint32_t)strtoul(rest, NULL, 10));
+	replay_begin();
+}
+
+static void c_phase(char *rest) {
+	const char *name = rest ? rest : "";
+	int i;
+
+	replay_end_phase();
+	for (i = 0; i < replay.n_phases; i++) {
+		if (streq(replay.phases[i].name, name)) break;
+	}
+	if (i == replay.n_phases) {
+		replay.phases = mem_realloc(replay.phases,
+			(replay.n_phases + 1) * sizeof(*replay.phases));
+		replay.phases[i].name = string_make(name);
+		replay.phases[i].time = 0;
+		replay.phases[i].inputs = 0;
+		replay.n_phases++;
+	}
+	replay.phase = i;
+	replay.phase_start = clock();
+}
+
+static void c_keypress(char *rest) {
+	unsigned long code = 0;
+	unsigned int mods = 0;
+
+	if (!rest || sscanf(rest, "%d %lu %u", &replay.input_asks, &code,
+			&mods) != 3) {
+		printf("keypress: bad input '%s'\n", rest ? rest : "");
+		return;
+	}
+	replay_begin();
+	replay.input.key.type = EVT_KBRD;
+	replay.input.key.code = (keycode_t)code;
+	replay.input.key.mods = (uint8_t)mods;
+	replay.pending = true;
+}
+
+static void c_mouse(char *rest) {
+	unsigned int button = 0, x = 0, y = 0, mods = 0;
+
+	if (!rest || sscanf(rest, "%d %u %u %u %u", &replay.input_asks,
+			&button, &x, &y, &mods) != 5) {
+		printf("mouse: bad input '%s'\n", rest ? rest : "");
+		return;
+	}
+	replay_begin();
+	replay.input.mouse.type = EVT_MOUSE;
+	replay.input.mouse.button = (uint8_t)button;
+	replay.input.mouse.x = (uint8_t)x;
+	replay.input.mouse.y = (uint8_t)y;
+	replay.input.mouse.mods = (uint8_t)mods;
+	replay.pending = true;
+}
+
+static void c_hash(char *rest) {
+	printf("state-hash: %08lx\n", (unsigned long)record_state_hash());
+}
+
+static void c_timing(char *rest) {
+	/* Bring the phase being timed up to date */
+	if (replay.phase >= 0) {
+		replay.phases[replay.phase].time += clock() - replay.phase_start;
+		replay.phase_start = clock();
+	}
+	replay_print_phases();
+}
+
+/**
+ * Redraw the whole map the given number of times, and report the frames per
+ * second and the time taken by Term_fresh(): with every grid sent to the
+ * terminal again, with only the two ends of each row changed, and with
+ * nothing changed.  The terminal can be resized first.
+ */
+static void c_fps(char *rest) {
+	const char *names[3] = { "full", "sparse", "unchanged" };
+	int frames = 1000, w = 0, h = 0, i, k, y;
+
+	if (rest && sscanf(rest, "%d %d %d", &frames, &w, &h) < 1) {
+		printf("fps: bad input '%s'\n", rest);
+		return;
+	}
+	if (w > 0 && h > 0) Term_resize(w, h);
+
+	for (k = 0; k < 3; k++) {
+		clock_t start = clock(), fresh = 0, t;
+
+		for (i = 0; i < frames; i++) {
+			if (k == 0) {
+				Term->total_erase = true;
+			} else if (k == 1) {
+				wchar_t c = (i % 2) ? L'.' : L':';
+
+				for (y = 0; y < Term->hgt; y++) {
+					Term_putch(0, y, COLOUR_WHITE, c);
+					Term_putch(Term->wid - 1, y, COLOUR_WHITE, c);
+				}
+			}
+			prt_map();
+			t = clock();
+			Term_fresh();
+			fresh += clock() - t;
+		}
+		t = clock() - start;
+
+		printf("fps: %dx%d %s: %.0f frames/s, %.1fus per Term_fresh\n",
+			Term->wid, Term->hgt, names[k],
+			(t > 0) ? frames * (double)CLOCKS_PER_SEC / t : 0.0,
+			fresh * 1e6 / CLOCKS_PER_SEC / frames);
+	}
+}
+
 /**
  * Player commands
  */
@@ -128,6 +325,14 @@ static test_cmd cmds[] = {
 	{ "player-class?", c_player_class },
 	{ "player-race?", c_player_race },
 
+	{ "seed", c_seed },
+	{ "phase", c_phase },
+	{ "keypress", c_keypress },
+	{ "mouse", c_mouse },
+	{ "hash?", c_hash },
+	{ "timing?", c_timing },
+	{ "fps?", c_fps },
+
 	{ NULL, NULL }
 };
 
@@ -209,12 +414,51 @@ static errr term_xtra_alive(int v) {
 	return 0;
 }
 
+/**
+ * Hand over the recorded input when the game has asked for it as often as
+ * when it was recorded, or is waiting for it; input which was recorded
+ * along with it follows straight away.
+ */
+static errr replay_event(int v) {
+	bool wait = v;
+
+	replay.asks++;
+	while (1) {
+		/* Run the script up to the next input */
+		while (!replay.pending) {
+			if (test_docmd()) {
+				/* Let the game run on until it waits for input */
+				if (!wait) return 0;
+				if (!replay.done) {
+					printf("replay: the recording ended before the game\n");
+				}
+				quit(NULL);
+			}
+		}
+
+		if (!wait && replay.asks < replay.input_asks) return 0;
+
+		if (replay.input.type == EVT_MOUSE) {
+			Term_mousepress(replay.input.mouse.x, replay.input.mouse.y,
+				replay.input.mouse.button |
+				(replay.input.mouse.mods << 4));
+		} else {
+			Term_keypress(replay.input.key.code, replay.input.key.mods);
+		}
+		if (replay.phase >= 0) replay.phases[replay.phase].inputs++;
+		replay.pending = false;
+		replay.asks = 0;
+		wait = false;
+	}
+}
+
 static errr term_xtra_event(int v) {
 	if (verbose) printf("term-xtra-event %d\n", v);
 	if (nextkey) {
 		Term_keypress(nextkey, 0);
 		nextkey = 0;
 	}
+	if (replay.active) return replay_event(v);
 	return test_docmd();
 }
 
@@ -296,9 +540,10 @@ static void term_data_link(int i) {
 	angband_term[i] = t;
 }
 
-const char help_test[] = "Test mode, subopts -p(rompt)";
+const char help_test[] = "Test mode, subopts -p(rompt) -s(avefile path)";
 
 errr init_test(int argc, char *argv[]) {
+	const char *load = "";
 	int i;
 
 	/* Skip over argv[0] */
@@ -307,14 +552,18 @@ errr init_test(int argc, char *argv[]) {
 			prompt = 1;
 			continue;
 		}
+		if (prefix(argv[i], "-s")) {
+			load = argv[i] + 2;
+			continue;
+		}
 		printf("init-test: bad argument '%s'\n", argv[i]);
 	}
 
 	/*
 	 * Reset savefile set by main.c:  don't want it to interfere with the
-	 * test.
+	 * test.  A replay can name the savefile its recording started from.
 	 */
-	savefile[0] = '\0';
+	my_strcpy(savefile, load, sizeof(savefile));
 
 	term_data_link(0);
 	return 0;
@@ -26,6 +26,7 @@
 #include "ui-init.h"
 #include "ui-input.h"
 #include "ui-prefs.h"
+#include "ui-record.h"
 #include "ui-signals.h"
 
 #ifdef SOUND
@@ -132,6 +133,7 @@ static void basic_quit_hook(const char *s)
  */
 static void extended_quit_hook(const char *s)
 {
+	record_end();
 	textui_cleanup();
 	cleanup_angband();
 #ifdef SOUND
@@ -346,6 +348,7 @@ int main(int argc, char *argv[])
 	bool done = false;
 
 	const char *mstr = NULL;
+	const char *record_path = NULL;
 	bool args = true;
 
 	/* Save the "program name" XXX XXX XXX */
@@ -450,6 +453,11 @@ int main(int argc, char *argv[])
 				change_path(arg);
 				continue;
 
+			case 'r':
+				if (!*arg) goto usage;
+				record_path = arg;
+				continue;
+
 			case '-':
 				argv[i] = argv[0];
 				argc = argc - i;
@@ -466,6 +474,7 @@ int main(int argc, char *argv[])
 				puts("  -w             Resurrect dead character (marks savefile)");
 				puts("  -g             Request graphics mode");
 				puts("  -u<who>        Use your <who> savefile");
+				puts("  -r<file>       Record the input to <file>, to replay with -mtest");
 				puts("  -d<dir>=<path> Override a specific directory with <path>. <path> can be:");
 				for (i = 0; i < (int)N_ELEMENTS(change_path_values); i++) {
 #ifdef SETGID
@@ -566,6 +575,11 @@ int main(int argc, char *argv[])
 	init_angband();
 	textui_init();
 
+	/* Start recording, if asked */
+	if (record_path && !record_start(record_path)) {
+		quit_fmt("Couldn't record to %s", record_path);
+	}
+
 	/*
 	 * Install a quit hook that will clean up those things.  Have it call
 	 * the previously registered quit hook so whatever other cleaning up
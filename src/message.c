@@ -36,9 +36,7 @@
 
 typedef struct _message_t
 {
-	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	uint32_t str;
 	uint16_t type;
 	uint16_t count;
 } message_t;
@@ -50,15 +48,30 @@ typedef struct _msgcolor_t
 	struct _msgcolor_t *next;
 } msgcolor_t;
 
+/**
+ * The message log is a ring of max entries, oldest first.  Their text is
+ * kept in order in a ring of text_size bytes:  each new message goes after the
+ * last one, or at the start if it won't fit at the end, and the oldest
+ * messages are dropped while they are in the way.
+ */
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
+	message_t *log;
+	char *text;
 	msgcolor_t *colors;
+	uint32_t oldest;
 	uint32_t count;
 	uint32_t max;
+	uint32_t text_size;
+	uint32_t text_end;
 } msgqueue_t;
 
+/**
+ * Room for the text of the whole log, unless its messages average over 128
+ * characters
+ */
+#define MESSAGE_TEXT_SIZE 128
+
 static msgqueue_t *messages = NULL;
 
 /**
@@ -73,6 +86,9 @@ void messages_init(void)
 {
 	messages = mem_zalloc(sizeof(msgqueue_t));
 	messages->max = 2048;
+	messages->log = mem_zalloc(messages->max * sizeof(message_t));
+	messages->text_size = messages->max * MESSAGE_TEXT_SIZE;
+	messages->text = mem_zalloc(messages->text_size);
 }
 
 /**
@@ -82,15 +98,6 @@ void messages_free(void)
 {
 	msgcolor_t *c = messages->colors;
 	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m) {
-		nextm = m->older;
-		mem_free(m->str);
-		mem_free(m);
-		m = nextm;
-	}
 
 	while (c) {
 		nextc = c->next;
@@ -98,6 +105,8 @@ void messages_free(void)
 		c = nextc;
 	}
 
+	mem_free(messages->text);
+	mem_free(messages->log);
 	mem_free(messages);
 }
 
@@ -113,6 +122,25 @@ uint16_t messages_num(void)
  * ------------------------------------------------------------------------
  * Functions for individual messages
  * ------------------------------------------------------------------------ */
+/**
+ * Returns the message of age `age`.
+ */
+static message_t *message_get(uint16_t age)
+{
+	if (age >= messages->count) return NULL;
+	return &messages->log[(messages->oldest + messages->count - 1 - age) %
+		messages->max];
+}
+
+/**
+ * Drop the oldest message
+ */
+static void message_drop_oldest(void)
+{
+	messages->oldest = (messages->oldest + 1) % messages->max;
+	messages->count--;
+}
+
 /**
  * Save a new message into the memory buffer, with text `str` and type `type`.
  * The type should be one of the MSG_ constants defined in message.h.
@@ -123,55 +151,48 @@ uint16_t messages_num(void)
  */
 void message_add(const char *str, uint16_t type)
 {
-	message_t *m;
-
-	if (messages->head &&
-	    messages->head->type == type &&
-	    streq(messages->head->str, str) &&
-	    messages->head->count != (uint16_t)-1) {
-		messages->head->count++;
+	message_t *m = message_get(0);
+	size_t len = strlen(str);
+	uint32_t start;
+
+	if (m &&
+	    m->type == type &&
+	    streq(messages->text + m->str, str) &&
+	    m->count != (uint16_t)-1) {
+		m->count++;
 		return;
 	}
 
-	m = mem_zalloc(sizeof(message_t));
-	m->str = string_make(str);
-	m->type = type;
-	m->count = 1;
-	m->older = messages->head;
-
-	if (messages->head)
-		messages->head->newer = m;
-
-	messages->head = m;
-	messages->count++;
-
-	if (!messages->tail)
-		messages->tail = m;
-
-	if (messages->count > messages->max) {
-		message_t *old_tail = messages->tail;
-
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		mem_free(old_tail->str);
-		mem_free(old_tail);
-		messages->count--;
+	/* Truncate anything too long for the text ring */
+	if (len >= messages->text_size) len = messages->text_size - 1;
+
+	/*
+	 * Find room for the text, dropping the old messages which start
+	 * between the end of the newest one and the end of the new text
+	 */
+	start = messages->text_end;
+	if (start + len + 1 > messages->text_size) start = 0;
+	if (messages->count == messages->max) message_drop_oldest();
+	while (messages->count) {
+		uint32_t old = messages->log[messages->oldest].str;
+
+		if (start == messages->text_end) {
+			if (old < start || old > start + len) break;
+		} else if (old < messages->text_end && old > len) {
+			break;
+		}
+		message_drop_oldest();
 	}
-}
 
-/**
- * Returns the message of age `age`.
- */
-static message_t *message_get(uint16_t age)
-{
-	message_t *m = messages->head;
+	memcpy(messages->text + start, str, len);
+	messages->text[start + len] = '\0';
+	messages->text_end = start + len + 1;
 
-	while (m && age) {
-		age--;
-		m = m->older;
-	}
-
-	return m;
+	m = &messages->log[(messages->oldest + messages->count) % messages->max];
+	m->str = start;
+	m->type = type;
+	m->count = 1;
+	messages->count++;
 }
 
 
@@ -185,7 +206,7 @@ static message_t *message_get(uint16_t age)
 const char *message_str(uint16_t age)
 {
 	message_t *m = message_get(age);
-	return (m ? m->str : "");
+	return (m ? messages->text + m->str : "");
 }
 
 /**
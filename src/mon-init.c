@@ -1825,6 +1825,7 @@ static errr finish_parse_monster(struct parser *p) {
 		mem_free(r);
 	}
 	z_info->r_max += 1;
+	forget_monster_lookups();
 
 	/* Convert friend and shape names into race pointers */
 	for (i = 0; i < z_info->r_max; i++) {
@@ -1949,6 +1950,7 @@ static void cleanup_monster(void)
 	}
 
 	mem_free(r_info);
+	forget_monster_lookups();
 }
 
 struct file_parser monster_parser = {
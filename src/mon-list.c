@@ -18,10 +18,10 @@
  */
 
 #include "game-world.h"
+#include "init.h"
 #include "mon-desc.h"
 #include "mon-list.h"
 #include "mon-predicate.h"
-#include "project.h"
 
 /**
  * Allocate a new monster list based on the size of the current cave's monster
@@ -42,6 +42,8 @@ monster_list_t *monster_list_new(void)
 		return NULL;
 	}
 
+	list->race_entry = mem_zalloc(z_info->r_max * sizeof(uint16_t));
+
 	list->entries_size = size;
 
 	return list;
@@ -60,6 +62,9 @@ void monster_list_free(monster_list_t *list)
 		list->entries = NULL;
 	}
 
+	mem_free(list->race_entry);
+	list->race_entry = NULL;
+
 	mem_free(list);
 	list = NULL;
 }
@@ -103,7 +108,7 @@ monster_list_t *monster_list_shared_instance(void)
  */
 static bool monster_list_can_update(const monster_list_t *list)
 {
-	if (list == NULL || list->entries == NULL)
+	if (list == NULL || list->entries == NULL || list->race_entry == NULL)
 		return false;
 
 	return (int)list->entries_size >= cave_monster_max(cave);
@@ -125,6 +130,8 @@ void monster_list_reset(monster_list_t *list)
 	}
 
 	memset(list->entries, 0, list->entries_size * sizeof(monster_list_entry_t));
+	if (list->race_entry != NULL)
+		memset(list->race_entry, 0, z_info->r_max * sizeof(uint16_t));
 	memset(list->total_entries, 0, MONSTER_LIST_SECTION_MAX * sizeof(uint16_t));
 	memset(list->total_monsters, 0, MONSTER_LIST_SECTION_MAX * sizeof(uint16_t));
 	list->distinct_entries = 0;
@@ -149,27 +156,20 @@ void monster_list_collect(monster_list_t *list)
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		struct monster *mon = cave_monster(cave, i);
 		monster_list_entry_t *entry = NULL;
-		int j, field;
-		bool los = false;
+		int field;
 
 		/* Only consider visible, known monsters */
 		if (!monster_is_visible(mon) ||	monster_is_camouflaged(mon))
 			continue;
 
-		/* Find or add a list entry. */
-		for (j = 0; j < (int)list->entries_size; j++) {
-			if (list->entries[j].race == NULL) {
-				/* We found an empty slot, so add this race here. */
-				entry = &list->entries[j];
-				memset(entry, 0, sizeof(monster_list_entry_t));
-				entry->race = mon->race;
-				break;
-			}
-			else if (list->entries[j].race == mon->race) {
-				/* We found a matching race and we'll use that. */
-				entry = &list->entries[j];
-				break;
-			}
+		/* Find or add the entry for this race. */
+		if (list->race_entry[mon->race->ridx]) {
+			entry = &list->entries[list->race_entry[mon->race->ridx] - 1];
+		} else if (list->distinct_entries < list->entries_size) {
+			entry = &list->entries[list->distinct_entries];
+			memset(entry, 0, sizeof(monster_list_entry_t));
+			entry->race = mon->race;
+			list->race_entry[mon->race->ridx] = ++list->distinct_entries;
 		}
 
 		if (entry == NULL)
@@ -180,14 +180,10 @@ void monster_list_collect(monster_list_t *list)
 		 * the standard glyph in the UI */
 		entry->attr = mon->attr;
 
-		/*
-		 * Check for LOS
-		 * Hack - we should use (mon->mflag & (MFLAG_VIEW)) here,
-		 * but this does not catch monsters detected by ESP which are
-		 * targetable, so we cheat and use projectable() instead
-		 */
-		los = projectable(cave, player->grid, mon->grid, PROJECT_NONE);
-		field = (los) ? MONSTER_LIST_SECTION_LOS : MONSTER_LIST_SECTION_ESP;
+		/* Check for LOS; update_mon() marks monsters seen or sensed by
+		 * ESP in the player's view, so there is no need to project */
+		field = monster_is_in_view(mon) ?
+			MONSTER_LIST_SECTION_LOS : MONSTER_LIST_SECTION_ESP;
 		entry->count[field]++;
 
 		if (mon->m_timed[MON_TMD_SLEEP] > 0)
@@ -200,10 +196,7 @@ void monster_list_collect(monster_list_t *list)
 	}
 
 	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++) {
-		if (list->entries[i].race == NULL)
-			continue;
-
+	for (i = 0; i < list->distinct_entries; i++) {
 		if (list->entries[i].count[MONSTER_LIST_SECTION_LOS] > 0)
 			list->total_entries[MONSTER_LIST_SECTION_LOS]++;
 
@@ -214,7 +207,6 @@ void monster_list_collect(monster_list_t *list)
 			list->entries[i].count[MONSTER_LIST_SECTION_LOS];
 		list->total_monsters[MONSTER_LIST_SECTION_ESP] +=
 			list->entries[i].count[MONSTER_LIST_SECTION_ESP];
-		list->distinct_entries++;
 	}
 
 	list->creation_turn = turn;
@@ -278,7 +270,7 @@ int monster_list_compare_exp(const void *a, const void *b)
 void monster_list_sort(monster_list_t *list,
 					   int (*compare)(const void *, const void *))
 {
-	size_t elements;
+	size_t elements, i;
 
 	if (list == NULL || list->entries == NULL)
 		return;
@@ -293,6 +285,10 @@ void monster_list_sort(monster_list_t *list,
 
 	sort(list->entries, MIN(elements, list->entries_size), sizeof(list->entries[0]), compare);
 	list->sorted = true;
+
+	/* The entries have moved */
+	for (i = 0; i < MIN(elements, list->entries_size); i++)
+		list->race_entry[list->entries[i].race->ridx] = i + 1;
 }
 
 /**
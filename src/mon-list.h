@@ -39,6 +39,7 @@ typedef struct monster_list_entry_s {
 typedef struct monster_list_s {
 	monster_list_entry_t *entries;
 	size_t entries_size;
+	uint16_t *race_entry;	/* 1 + index of each race's entry, or 0 */
 	uint16_t distinct_entries;
 	int32_t creation_turn;
 	bool sorted;
@@ -49,10 +49,44 @@
  * - prob3 is calculated by get_mon_num(), which checks whether universal
  *         restrictions apply (for example, unique monsters can only appear
  *         once on a given level); prob3 is always either prob2 or 0.
+ *
+ * Working out prob3 means looking at every race up to the generated level,
+ * and picking a race means walking along the table, so get_mon_num() keeps
+ * the running totals of prob3 for each generated level, which it can search
+ * instead.  The totals for a level stay good while the restriction from
+ * get_mon_num_prep(), the level where the monster will be placed, the season
+ * and which uniques can appear all stay the same.
  * ------------------------------------------------------------------------ */
 static int16_t alloc_race_size;
 static struct alloc_entry *alloc_race_table;
 
+/**
+ * Running totals of prob3 over the allocation table for one generated level
+ */
+struct race_alloc_totals {
+	bool valid;
+	uint32_t prep;			/* The restriction the totals were made with */
+	int force_level;		/* The level FORCE_DEPTH monsters must be at */
+	bool season;			/* Whether seasonal monsters were allowed */
+	int size;				/* Number of table entries totalled */
+	uint32_t *totals;		/* Running total of prob3 for each entry */
+	bool *unique_ok;		/* Whether each unique in range could appear */
+};
+
+static struct race_alloc_totals *alloc_race_totals;
+
+/* The allocation table entries for uniques, in table order */
+static int16_t *alloc_race_uniques;
+static int16_t alloc_race_n_uniques;
+
+/* The restriction from get_mon_num_prep(); zero means none */
+static uint32_t alloc_race_prep;
+static uint32_t alloc_race_prep_count;
+
+/* The game day on which the date was last looked at, and what it said */
+static int32_t alloc_season_day = -1;
+static bool alloc_season;
+
 /**
  * Initialize monster allocation info
  */
@@ -134,9 +168,32 @@ static void init_race_allocs(void) {
 	}
 	mem_free(already_counted);
 	mem_free(num);
+
+	/* Note the uniques */
+	alloc_race_uniques = mem_zalloc(alloc_race_size * sizeof(int16_t));
+	alloc_race_n_uniques = 0;
+	for (i = 0; i < alloc_race_size; i++) {
+		if (rf_has(r_info[table[i].index].flags, RF_UNIQUE)) {
+			alloc_race_uniques[alloc_race_n_uniques++] = i;
+		}
+	}
+
+	/* Make room for the running totals */
+	alloc_race_totals = mem_zalloc(z_info->max_depth *
+		sizeof(*alloc_race_totals));
+	alloc_race_prep = 0;
+	alloc_season_day = -1;
 }
 
 static void cleanup_race_allocs(void) {
+	int i;
+
+	for (i = 0; i < z_info->max_depth; i++) {
+		mem_free(alloc_race_totals[i].totals);
+		mem_free(alloc_race_totals[i].unique_ok);
+	}
+	mem_free(alloc_race_totals);
+	mem_free(alloc_race_uniques);
 	mem_free(alloc_race_table);
 }
 
@@ -150,6 +207,7 @@ static void cleanup_race_allocs(void) {
 void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 {
 	int i;
+	bool restricted = false;
 
 	/* Scan the allocation table */
 	for (i = 0; i < alloc_race_size; i++) {
@@ -164,32 +222,88 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 			/* Do not use this monster */
 			entry->prob2 = 0;
 		}
+		if (entry->prob2 != entry->prob1) restricted = true;
+	}
+
+	/* Any running totals made with another restriction are out of date */
+	if (restricted) {
+		if (!++alloc_race_prep_count) alloc_race_prep_count = 1;
+		alloc_race_prep = alloc_race_prep_count;
+	} else {
+		alloc_race_prep = 0;
 	}
 }
 
+/**
+ * Whether it's the season for seasonal monsters; the date is only looked at
+ * once each game day
+ */
+static bool mon_season(void)
+{
+	int32_t day = turn / (10L * z_info->day_length);
+
+	if (day != alloc_season_day) {
+		time_t cur_time = time(NULL);
+		struct tm *date = localtime(&cur_time);
+
+		alloc_season = date->tm_mon == 11 && date->tm_mday >= 24 &&
+			date->tm_mday <= 26;
+		alloc_season_day = day;
+	}
+	return alloc_season;
+}
+
+/**
+ * Check whether the running totals for a level are still good
+ */
+static bool race_totals_valid(const struct race_alloc_totals *t,
+		int force_level, bool season)
+{
+	int i;
+
+	if (!t->valid || t->prep != alloc_race_prep ||
+			t->force_level != force_level || t->season != season) {
+		return false;
+	}
+
+	/* The same uniques must be able to appear */
+	for (i = 0; i < alloc_race_n_uniques; i++) {
+		const struct monster_race *race;
+
+		if (alloc_race_uniques[i] >= t->size) break;
+		race = &r_info[alloc_race_table[alloc_race_uniques[i]].index];
+		if (t->unique_ok[i] != (race->cur_num < race->max_num)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 /**
  * Helper function for get_mon_num(). Scans the prepared monster allocation
  * table and picks a random monster. Returns the index of a monster in
  * `table`.
  */
-static struct monster_race *get_mon_race_aux(long total,
+static struct monster_race *get_mon_race_aux(const struct race_alloc_totals *t,
 											 const alloc_entry *table)
 {
-	int i;
+	int lo = 0, hi = t->size - 1;
 
 	/* Pick a monster */
-	long value = randint0(total);
+	uint32_t value = randint0(t->totals[t->size - 1]);
 
-	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Found the entry */
-		if (value < table[i].prob3) break;
+	/* Find the first entry whose running total passes the value */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
 
-		/* Decrement */
-		value -= table[i].prob3;
+		if (t->totals[mid] > value) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
 	}
 
-	return &r_info[table[i].index];
+	return &r_info[table[lo].index];
 }
 
 /**
@@ -220,59 +334,87 @@ static struct monster_race *get_mon_race_aux(long total,
  */
 struct monster_race *get_mon_num(int generated_level, int current_level)
 {
-	int i, p;
-	long total;
+	int i, p, level, force_level;
+	uint32_t total;
+	bool season = mon_season();
 	struct monster_race *race;
+	struct race_alloc_totals *t;
 	alloc_entry *table = alloc_race_table;
-	time_t cur_time = time(NULL);
-	struct tm *date = localtime(&cur_time);
 
 	/* Occasionally produce a nastier monster in the dungeon */
 	if (generated_level > 0 && one_in_(z_info->ood_monster_chance))
 		generated_level += MIN(generated_level / 4 + 2,
 			z_info->ood_monster_amount);
 
-	total = 0L;
+	/* Monsters are all shallower than the deepest level */
+	if (generated_level < 0) return NULL;
+	level = MIN(generated_level, z_info->max_depth - 1);
+	force_level = MIN(current_level, level);
+	t = &alloc_race_totals[level];
 
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Monsters are sorted by depth */
-		if (table[i].level > generated_level) break;
+	/* Process probabilities, unless it has been done for this level */
+	if (!race_totals_valid(t, force_level, season)) {
+		int n = 0;
 
-		/* Default */
-		table[i].prob3 = 0;
+		if (!t->totals) {
+			t->totals = mem_zalloc(alloc_race_size * sizeof(*t->totals));
+			t->unique_ok = mem_zalloc(alloc_race_n_uniques *
+				sizeof(*t->unique_ok));
+		}
 
-		/* No town monsters in dungeon */
-		if (generated_level > 0 && table[i].level <= 0) continue;
+		total = 0;
+		for (i = 0; i < alloc_race_size; i++) {
+			/* Monsters are sorted by depth */
+			if (table[i].level > level) break;
 
-		/* Get the chosen monster */
-		race = &r_info[table[i].index];
+			/* Default */
+			table[i].prob3 = 0;
+			t->totals[i] = total;
 
-		/* No seasonal monsters outside of Christmas */
-		if (rf_has(race->flags, RF_SEASONAL) &&
-			!(date->tm_mon == 11 && date->tm_mday >= 24 && date->tm_mday <= 26))
-			continue;
+			/* Get the chosen monster */
+			race = &r_info[table[i].index];
 
-		/* Only one copy of a unique must be around at the same time */
-		if (rf_has(race->flags, RF_UNIQUE) && (race->cur_num >= race->max_num))
-			continue;
+			/* Note whether a unique could appear */
+			if (n < alloc_race_n_uniques && alloc_race_uniques[n] == i) {
+				t->unique_ok[n++] = race->cur_num < race->max_num;
+			}
 
-		/* Some monsters never appear out of depth */
-		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > current_level)
-			continue;
+			/* No town monsters in dungeon */
+			if (level > 0 && table[i].level <= 0) continue;
 
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
+			/* No seasonal monsters outside of Christmas */
+			if (rf_has(race->flags, RF_SEASONAL) && !season)
+				continue;
+
+			/* Only one copy of a unique must be around at the same time */
+			if (rf_has(race->flags, RF_UNIQUE) &&
+					(race->cur_num >= race->max_num))
+				continue;
 
-		/* Total */
-		total += table[i].prob3;
+			/* Some monsters never appear out of depth */
+			if (rf_has(race->flags, RF_FORCE_DEPTH) &&
+					race->level > force_level)
+				continue;
+
+			/* Accept */
+			table[i].prob3 = table[i].prob2;
+
+			/* Total */
+			total += table[i].prob3;
+			t->totals[i] = total;
+		}
+		t->size = i;
+		t->prep = alloc_race_prep;
+		t->force_level = force_level;
+		t->season = season;
+		t->valid = true;
 	}
 
 	/* No legal monsters */
-	if (total <= 0) return NULL;
+	if (!t->size || !t->totals[t->size - 1]) return NULL;
 
 	/* Pick a monster */
-	race = get_mon_race_aux(total, table);
+	race = get_mon_race_aux(t, table);
 
 	/* Try for a "harder" monster once (50%) or twice (10%) */
 	p = randint0(100);
@@ -281,7 +423,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a new monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(t, table);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -292,7 +434,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(t, table);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
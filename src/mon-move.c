@@ -50,6 +50,7 @@
 #include "player-util.h"
 #include "project.h"
 #include "trap.h"
+#include "z-prof.h"
 
 
 /**
@@ -116,10 +117,12 @@ static bool monster_can_hear(struct monster *mon)
  */
 static bool monster_can_smell(struct monster *mon)
 {
-	if (cave->scent.grids[mon->grid.y][mon->grid.x] == 0) {
+	int age = cave_scent_age(cave, mon->grid);
+
+	if (age == 0) {
 		return false;
 	}
-	return mon->race->smell > cave->scent.grids[mon->grid.y][mon->grid.x];
+	return mon->race->smell > age;
 }
 
 /**
@@ -471,13 +474,12 @@ static bool get_move_advance(struct monster *mon, bool *track)
 		for (i = 0; i < 8; i++) {
 			/* Get the location */
 			struct loc grid = loc_sum(mon->grid, ddgrid_ddd[i]);
+			int age = cave_scent_age(cave, grid);
 			int smelled_scent;
 
 			/* If no good sound yet, use scent */
-			smelled_scent = mon->race->smell
-				- cave->scent.grids[grid.y][grid.x];
-			if ((smelled_scent > best_scent) &&
-				(cave->scent.grids[grid.y][grid.x] != 0)) {
+			smelled_scent = mon->race->smell - age;
+			if ((smelled_scent > best_scent) && (age != 0)) {
 				best_scent = smelled_scent;
 				best_grid = grid;
 				found = true;
@@ -1891,6 +1893,8 @@ void process_monsters(int minimum_energy)
 	/* Only process some things every so often */
 	bool regen = false;
 
+	PROF_BEGIN(PROF_PROCESS_MONSTERS);
+
 	/* Regenerate hitpoints and mana every 100 game turns */
 	if (turn % 100 == 0)
 		regen = true;
@@ -1963,7 +1967,9 @@ void process_monsters(int minimum_energy)
 			cave->mon_current = i;
 
 			/* The monster takes its turn */
+			PROF_BEGIN(PROF_MONSTER_TURN);
 			monster_turn(mon);
+			PROF_END(PROF_MONSTER_TURN);
 
 			/*
 			 * For symmetry with the player, monster can take
@@ -1979,6 +1985,8 @@ void process_monsters(int minimum_energy)
 	/* Update monster visibility after this */
 	/* XXX This may not be necessary */
 	player->upkeep->update |= PU_MONSTERS;
+
+	PROF_END(PROF_PROCESS_MONSTERS);
 }
 
 /**
@@ -46,6 +46,7 @@
 #include "player-util.h"
 #include "project.h"
 #include "trap.h"
+#include "z-names.h"
 
 /**
  * ------------------------------------------------------------------------
@@ -111,6 +112,20 @@ void create_mon_flag_mask(bitflag *f, ...)
  * ------------------------------------------------------------------------
  * Lookup utilities
  * ------------------------------------------------------------------------ */
+/**
+ * Index of the monster race names, made when first needed
+ */
+static struct name_index *race_names;
+
+/**
+ * Forget the index of the monster race names, for when r_info changes
+ */
+void forget_monster_lookups(void)
+{
+	name_index_free(race_names);
+	race_names = NULL;
+}
+
 /**
  * Returns the monster with the given name. If no monster has the exact name
  * given, returns the first monster with the given name as a (case-insensitive)
@@ -119,25 +134,26 @@ void create_mon_flag_mask(bitflag *f, ...)
 struct monster_race *lookup_monster(const char *name)
 {
 	int i;
-	struct monster_race *closest = NULL;
 
-	/* Look for it */
-	for (i = 0; i < z_info->r_max; i++) {
-		struct monster_race *race = &r_info[i];
-		if (!race->name)
-			continue;
-
-		/* Test for equality */
-		if (my_stricmp(name, race->name) == 0)
-			return race;
-
-		/* Test for close matches */
-		if (!closest && my_stristr(race->name, name))
-			closest = race;
+	if (!race_names) {
+		const char **names = mem_alloc(MAX(z_info->r_max, 1)
+			* sizeof(*names));
+
+		for (i = 0; i < z_info->r_max; i++) {
+			names[i] = r_info[i].name;
+		}
+		race_names = name_index_new(names, z_info->r_max);
+		mem_free(names);
+	}
+
+	/* Test for equality, then for close matches */
+	i = name_index_find(race_names, name, -1, false);
+	if (i < 0) {
+		i = name_index_find_part(race_names, name);
 	}
 
 	/* Return our best match */
-	return closest;
+	return (i >= 0) ? &r_info[i] : NULL;
 }
 
 /**
@@ -223,7 +239,7 @@ static void path_analyse(struct chunk *c, struct loc grid)
 	for (i = 0; i < path_n - 1; ++i) {
 		/* Forget grids which would block los */
 		if (!square_allowslos(player->cave, path_g[i])) {
-			sqinfo_off(square(c, path_g[i])->info, SQUARE_SEEN);
+			sqinfo_off(square_info(c, path_g[i]), SQUARE_SEEN);
 			square_forget(c, path_g[i]);
 			square_light_spot(c, path_g[i]);
 		}
@@ -838,7 +854,6 @@ void update_smart_learn(struct monster *mon, struct player *p, int flag,
  * ------------------------------------------------------------------------
  * Monster healing
  * ------------------------------------------------------------------------ */
-#define MAX_KIN_RADIUS			5
 #define MAX_KIN_DISTANCE		5
 
 /**
@@ -884,14 +899,13 @@ static struct monster *get_injured_kin(struct chunk *c,
  */
 bool find_any_nearby_injured_kin(struct chunk *c, const struct monster *mon)
 {
-	struct loc grid;
-	for (grid.y = mon->grid.y - MAX_KIN_RADIUS;
-		 grid.y <= mon->grid.y + MAX_KIN_RADIUS; grid.y++) {
-		for (grid.x = mon->grid.x - MAX_KIN_RADIUS;
-			 grid.x <= mon->grid.x + MAX_KIN_RADIUS; grid.x++) {
-			if (get_injured_kin(c, mon, grid) != NULL) {
-				return true;
-			}
+	const int *midx;
+	int n = cave_monsters_near(c, mon->grid, MAX_KIN_DISTANCE, &midx), i;
+
+	for (i = 0; i < n; i++) {
+		struct monster *kin = cave_monster(c, midx[i]);
+		if (get_injured_kin(c, mon, kin->grid) != NULL) {
+			return true;
 		}
 	}
 
@@ -901,26 +915,24 @@ bool find_any_nearby_injured_kin(struct chunk *c, const struct monster *mon)
 /**
  * Choose one injured monster of the same base in LOS of the provided monster.
  *
- * Scan MAX_KIN_RADIUS grids around the monster to find potential grids,
+ * Look through the monsters near the provided one to find potential kin,
  * using reservoir sampling with k = 1 to find a random one.
  */
 struct monster *choose_nearby_injured_kin(struct chunk *c,
                                           const struct monster *mon)
 {
-	struct loc grid;
+	const int *midx;
+	int n = cave_monsters_near(c, mon->grid, MAX_KIN_DISTANCE, &midx), i;
 	int nseen = 0;
 	struct monster *found = NULL;
 
-	for (grid.y = mon->grid.y - MAX_KIN_RADIUS;
-		 grid.y <= mon->grid.y + MAX_KIN_RADIUS; grid.y++) {
-		for (grid.x = mon->grid.x - MAX_KIN_RADIUS;
-			 grid.x <= mon->grid.x + MAX_KIN_RADIUS; grid.x++) {
-			struct monster *kin = get_injured_kin(c, mon, grid);
-			if (kin) {
-				nseen++;
-				if (!randint0(nseen))
-					found = kin;
-			}
+	for (i = 0; i < n; i++) {
+		struct monster *kin = get_injured_kin(c, mon,
+			cave_monster(c, midx[i])->grid);
+		if (kin) {
+			nseen++;
+			if (!randint0(nseen))
+				found = kin;
 		}
 	}
 
@@ -2218,6 +2218,7 @@ static errr finish_parse_object(struct parser *p) {
 	}
 	z_info->k_max += 1;
 	z_info->ordinary_kind_max = z_info->k_max;
+	forget_object_lookups();
 
 	parser_destroy(p);
 	return 0;
@@ -2238,6 +2239,7 @@ static void cleanup_object(void)
 		free_effect(kind->effect);
 	}
 	mem_free(k_info);
+	forget_object_lookups();
 }
 
 struct file_parser object_parser = {
@@ -2657,6 +2659,7 @@ static errr finish_parse_ego(struct parser *p) {
 		mem_free(e);
 	}
 	z_info->e_max += 1;
+	forget_object_lookups();
 
 	parser_destroy(p);
 	return 0;
@@ -2683,6 +2686,7 @@ static void cleanup_ego(void)
 		}
 	}
 	mem_free(e_info);
+	forget_object_lookups();
 }
 
 struct file_parser ego_parser = {
@@ -3093,6 +3097,7 @@ static errr finish_parse_artifact(struct parser *p) {
 		aup_info[aidx].aidx = aidx;
 	}
 	z_info->a_max += 1;
+	forget_object_lookups();
 
 	/* Now we're done with object kinds, deal with object-like things */
 	none = tval_find_idx("none");
@@ -3120,6 +3125,7 @@ static void cleanup_artifact(void)
 	}
 	mem_free(a_info);
 	mem_free(aup_info);
+	forget_object_lookups();
 }
 
 struct file_parser artifact_parser = {
@@ -3168,6 +3174,7 @@ static errr finish_parse_randart(struct parser *p) {
 		aup_info[aidx].aidx = aidx;
 	}
 	z_info->a_max += 1;
+	forget_object_lookups();
 
 	parser_destroy(p);
 	return 0;
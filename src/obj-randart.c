@@ -3214,6 +3214,9 @@ void do_randart(uint32_t randart_seed, bool create_file)
 		}
 	}
 
+	/* The artifacts have new names */
+	forget_object_lookups();
+
 	/* When done, resume use of the Angband "complex" RNG. */
 	Rand_quick = false;
 }
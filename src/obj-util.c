@@ -41,6 +41,7 @@
 #include "player-spell.h"
 #include "player-util.h"
 #include "randname.h"
+#include "z-names.h"
 #include "z-queue.h"
 
 struct object_base *kb_info;
@@ -486,6 +487,80 @@ unsigned check_for_inscrip_with_int(const struct object *obj, const char *inscri
 
 /*** Object kind lookup functions ***/
 
+/**
+ * The kinds by tval and sval, made when first needed.  The kind with tval,
+ * tv, and sval, sv, is k_info[kind_table[kind_start[tv] + sv]] if sv is less
+ * than kind_start[tv + 1] - kind_start[tv], and that entry is not -1.
+ */
+static int *kind_start;
+static int *kind_table;
+static int kind_table_max;
+
+/**
+ * Index of the artifact names, made when first needed
+ */
+static struct name_index *artifact_names;
+
+/**
+ * Index of the ego item names, made when first needed
+ */
+static struct name_index *ego_names;
+
+/**
+ * Forget the indexes used to look up kinds, artifacts and egos, for when
+ * k_info, a_info or e_info change
+ */
+void forget_object_lookups(void)
+{
+	mem_free(kind_start);
+	mem_free(kind_table);
+	kind_start = NULL;
+	kind_table = NULL;
+	name_index_free(artifact_names);
+	artifact_names = NULL;
+	name_index_free(ego_names);
+	ego_names = NULL;
+}
+
+/**
+ * Place each kind in the table by tval and sval
+ */
+static void make_kind_table(void)
+{
+	int k, tval;
+
+	mem_free(kind_start);
+	mem_free(kind_table);
+	kind_start = mem_zalloc((TV_MAX + 1) * sizeof(*kind_start));
+
+	/* Find the highest sval of each tval */
+	for (k = 0; k < z_info->k_max; k++) {
+		struct object_kind *kind = &k_info[k];
+
+		if (kind->tval < 0 || kind->tval >= TV_MAX || kind->sval < 0)
+			continue;
+		kind_start[kind->tval + 1] = MAX(kind_start[kind->tval + 1],
+			kind->sval + 1);
+	}
+	for (tval = 0; tval < TV_MAX; tval++) {
+		kind_start[tval + 1] += kind_start[tval];
+	}
+
+	/* The first kind with each tval and sval is the one found */
+	kind_table = mem_alloc(MAX(kind_start[TV_MAX], 1) * sizeof(*kind_table));
+	for (k = 0; k < kind_start[TV_MAX]; k++) {
+		kind_table[k] = -1;
+	}
+	for (k = z_info->k_max - 1; k >= 0; k--) {
+		struct object_kind *kind = &k_info[k];
+
+		if (kind->tval < 0 || kind->tval >= TV_MAX || kind->sval < 0)
+			continue;
+		kind_table[kind_start[kind->tval] + kind->sval] = k;
+	}
+	kind_table_max = z_info->k_max;
+}
+
 /**
  * Return the object kind with the given `tval` and `sval`, or NULL.
  */
@@ -493,11 +568,16 @@ struct object_kind *lookup_kind(int tval, int sval)
 {
 	int k;
 
+	/* Kinds are added to k_info while the data files are read */
+	if (!kind_table || kind_table_max != z_info->k_max) {
+		make_kind_table();
+	}
+
 	/* Look for it */
-	for (k = 0; k < z_info->k_max; k++) {
-		struct object_kind *kind = &k_info[k];
-		if (kind->tval == tval && kind->sval == sval)
-			return kind;
+	if (tval >= 0 && tval < TV_MAX && sval >= 0
+			&& sval < kind_start[tval + 1] - kind_start[tval]) {
+		k = kind_table[kind_start[tval] + sval];
+		if (k >= 0) return &k_info[k];
 	}
 
 	/* Failure */
@@ -519,23 +599,28 @@ struct object_kind *objkind_byid(int kidx) {
  */
 const struct artifact *lookup_artifact_name(const char *name)
 {
-	int i;
-	int a_idx = -1;
+	int a_idx;
 
-	/* Look for it */
-	for (i = 0; i < z_info->a_max; i++) {
-		const struct artifact *art = &a_info[i];
-
-		/* Test for equality */
-		if (art->name && streq(name, art->name))
-			return art;
-		
-		/* Test for close matches */
-		if (strlen(name) >= 3 && art->name && my_stristr(art->name, name)
-			&& a_idx == -1)
-			a_idx = i;
+	if (!artifact_names) {
+		const char **names = mem_alloc(MAX(z_info->a_max, 1)
+			* sizeof(*names));
+
+		for (a_idx = 0; a_idx < z_info->a_max; a_idx++) {
+			names[a_idx] = a_info[a_idx].name;
+		}
+		artifact_names = name_index_new(names, z_info->a_max);
+		mem_free(names);
 	}
 
+	/* Test for equality */
+	a_idx = name_index_find(artifact_names, name, -1, true);
+	if (a_idx >= 0)
+		return &a_info[a_idx];
+
+	/* Test for close matches */
+	a_idx = (strlen(name) >= 3) ?
+		name_index_find_part(artifact_names, name) : -1;
+
 	/* Return our best match */
 	return a_idx > 0 ? &a_info[a_idx] : NULL;
 }
@@ -551,16 +636,24 @@ struct ego_item *lookup_ego_item(const char *name, int tval, int sval)
 	struct object_kind *kind = lookup_kind(tval, sval);
 	int i;
 
-	/* Look for it */
+	if (!ego_names) {
+		const char **names = mem_alloc(MAX(z_info->e_max, 1)
+			* sizeof(*names));
+
+		for (i = 0; i < z_info->e_max; i++) {
+			names[i] = e_info[i].name;
+		}
+		ego_names = name_index_new(names, z_info->e_max);
+		mem_free(names);
+	}
+
+	/* Look for it among the egos with this name */
 	if (!kind) return NULL;
-	for (i = 0; i < z_info->e_max; i++) {
+	for (i = name_index_find(ego_names, name, -1, true); i >= 0;
+			i = name_index_find(ego_names, name, i, true)) {
 		struct ego_item *ego = &e_info[i];
 		struct poss_item *poss_item = ego->poss_items;
 
-		/* Reject nameless and wrong names */
-		if (!ego->name) continue;
-		if (!streq(name, ego->name)) continue;
-
 		/* Check tval and sval */
 		while (poss_item) {
 			if (kind->kidx == poss_item->kidx) {
@@ -40,6 +40,7 @@ bool item_test(item_tester tester, int item);
 bool is_unknown(const struct object *obj);
 unsigned check_for_inscrip(const struct object *obj, const char *inscrip);
 unsigned check_for_inscrip_with_int(const struct object *obj, const char *insrip, int *ival);
+void forget_object_lookups(void);
 struct object_kind *lookup_kind(int tval, int sval);
 struct object_kind *objkind_byid(int kidx);
 const struct artifact *lookup_artifact_name(const char *name);
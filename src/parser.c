@@ -44,6 +44,13 @@
  * Each hook has a list of specs, which are essentially named formal parameters;
  * when we run a particular hook across a line, each spec in the hook is
  * assigned a value.
+ *
+ * The hooks are found by their directives in a hash table.  Each line is
+ * copied into a buffer kept by the parser and split up in place, and the
+ * values are kept in an array which is reused from line to line, so parsing
+ * a line allocates nothing once the buffers are big enough.  The strings
+ * handed out by parser_getsym() and parser_getstr() point into the line
+ * buffer, so last only until the next line is parsed.
  */
 
 enum {
@@ -64,7 +71,7 @@ struct parser_spec {
 };
 
 struct parser_value {
-	struct parser_spec spec;
+	const struct parser_spec *spec;
 	union {
 		wchar_t cval;
 		int ival;
@@ -88,11 +95,29 @@ struct parser {
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
-	struct parser_value *fhead;
-	struct parser_value *ftail;
+	struct parser_hook **table;
+	unsigned int table_size;
+	unsigned int table_count;
+	char *line;
+	size_t line_size;
+	struct parser_value *values;
+	unsigned int n_values;
+	unsigned int values_size;
 	void *priv;
+	bool recording;
+	uint8_t *record;
+	size_t record_len;
+	size_t record_max;
+	struct parser_hook **hook_list;
+	unsigned int n_hooks;
 };
 
+/**
+ * Change this whenever the way fields are converted or records are packed
+ * changes, so old records are not replayed.
+ */
+#define PARSER_RECORD_VERSION 1
+
 /**
  * Allocates a new parser.
  */
@@ -101,26 +126,116 @@ struct parser *parser_new(void) {
 	return p;
 }
 
+/**
+ * Find the slot in the hook table for a directive; it is empty if there is
+ * no hook for the directive
+ */
+static unsigned int hook_slot(struct parser *p, const char *dir) {
+	unsigned int mask = p->table_size - 1;
+	unsigned int i = djb2_hash(dir) & mask;
+
+	while (p->table[i] && !streq(p->table[i]->dir, dir)) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
 static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h) {
-		if (streq(h->dir, dir))
-			break;
-		h = h->next;
+	return p->table ? p->table[hook_slot(p, dir)] : NULL;
+}
+
+/**
+ * Put a hook in the hook table, superseding any other with its directive,
+ * and keep the table no more than half full
+ */
+static void addhook(struct parser *p, struct parser_hook *h) {
+	unsigned int i;
+
+	if (2 * (p->table_count + 1) > p->table_size) {
+		struct parser_hook **old = p->table;
+		unsigned int old_size = p->table_size;
+
+		p->table_size = old_size ? 2 * old_size : 32;
+		p->table = mem_zalloc(p->table_size * sizeof(*p->table));
+		for (i = 0; i < old_size; i++) {
+			if (old[i]) p->table[hook_slot(p, old[i]->dir)] = old[i];
+		}
+		mem_free(old);
 	}
-	return h;
+	i = hook_slot(p, h->dir);
+	if (!p->table[i]) p->table_count++;
+	p->table[i] = h;
 }
 
 static void parser_freeold(struct parser *p) {
-	struct parser_value *v;
-	while (p->fhead) {
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
-		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
-		p->fhead = v;
+	p->n_values = 0;
+}
+
+/**
+ * Make sure the line buffer can hold `size` bytes, keeping the strings in
+ * the values pointing at the same text if it moves
+ */
+static void line_reserve(struct parser *p, size_t size) {
+	char *old = p->line;
+	unsigned int i;
+
+	if (size <= p->line_size) return;
+	while (p->line_size < size) {
+		p->line_size = p->line_size ? 2 * p->line_size : 1024;
+	}
+	p->line = mem_realloc(p->line, p->line_size);
+	for (i = 0; i < p->n_values; i++) {
+		int t = p->values[i].spec->type & ~PARSE_T_OPT;
+
+		if (t == PARSE_T_SYM || t == PARSE_T_STR) {
+			p->values[i].u.sval = p->line + (p->values[i].u.sval - old);
+		}
+	}
+}
+
+/**
+ * Get the next value for the current line, to be kept by value_done()
+ */
+static struct parser_value *value_next(struct parser *p,
+		const struct parser_spec *s) {
+	if (p->n_values == p->values_size) {
+		p->values_size = p->values_size ? 2 * p->values_size : 8;
+		p->values = mem_realloc(p->values,
+			p->values_size * sizeof(*p->values));
 	}
+	p->values[p->n_values].spec = s;
+	return &p->values[p->n_values];
+}
+
+static void value_done(struct parser *p) {
+	p->n_values++;
+}
+
+/**
+ * Split off the next field of a line, just as strtok() would with ":" as the
+ * delimiters if `split` is true or with no delimiters if not.  A null `s`
+ * carries on from where the last field ended, which is kept in `*rest`.
+ */
+static char *next_field(char *s, bool split, char **rest) {
+	char *tok;
+
+	if (!s) s = *rest;
+	if (split) {
+		while (*s == ':') s++;
+	}
+	if (!*s) {
+		*rest = s;
+		return NULL;
+	}
+	tok = s;
+	s = split ? strchr(tok, ':') : NULL;
+	if (s) {
+		*s++ = '\0';
+	} else {
+		s = tok + strlen(tok);
+	}
+	*rest = s;
+	return tok;
 }
 
 static bool parse_random(const char *str, random_value *bonus) {
@@ -213,18 +328,83 @@ static bool parse_random(const char *str, random_value *bonus) {
 	return true;
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Records of parsed lines
+ *
+ * A record holds, for each line which ran a hook, the line number, which hook
+ * it was (by its place in the list of hooks) and the values of its fields,
+ * already split up and converted, in the order of the hook's fields.
+ * ------------------------------------------------------------------------ */
+
+static void record_bytes(struct parser *p, const void *data, size_t len)
+{
+	if (p->record_len + len > p->record_max) {
+		while (p->record_len + len > p->record_max) {
+			p->record_max = p->record_max ? 2 * p->record_max : 4096;
+		}
+		p->record = mem_realloc(p->record, p->record_max);
+	}
+	memcpy(p->record + p->record_len, data, len);
+	p->record_len += len;
+}
+
+static void record_line(struct parser *p, struct parser_hook *h)
+{
+	struct parser_hook *hp;
+	uint32_t lineno = p->lineno;
+	uint16_t index = 0;
+	uint8_t n_values = p->n_values;
+	unsigned int i;
+
+	for (hp = p->hooks; hp != h; hp = hp->next) index++;
+	record_bytes(p, &lineno, sizeof(lineno));
+	record_bytes(p, &index, sizeof(index));
+	record_bytes(p, &n_values, sizeof(n_values));
+
+	for (i = 0; i < p->n_values; i++) {
+		struct parser_value *v = &p->values[i];
+		int t = v->spec->type & ~PARSE_T_OPT;
+
+		if (t == PARSE_T_INT) {
+			int32_t ival = v->u.ival;
+			record_bytes(p, &ival, sizeof(ival));
+		} else if (t == PARSE_T_UINT) {
+			uint32_t u = v->u.uval;
+			record_bytes(p, &u, sizeof(u));
+		} else if (t == PARSE_T_CHAR) {
+			uint32_t c = v->u.cval;
+			record_bytes(p, &c, sizeof(c));
+		} else if (t == PARSE_T_RAND) {
+			int32_t r[4];
+
+			r[0] = v->u.rval.base;
+			r[1] = v->u.rval.dice;
+			r[2] = v->u.rval.sides;
+			r[3] = v->u.rval.m_bonus;
+			record_bytes(p, r, sizeof(r));
+		} else {
+			uint16_t len = strlen(v->u.sval);
+
+			record_bytes(p, &len, sizeof(len));
+			record_bytes(p, v->u.sval, len);
+		}
+	}
+}
+
 /**
  * Parses the provided line.
  *
  * This runs the first parser hook registered with `p` that matches `line`.
  */
 enum parser_error parser_parse(struct parser *p, const char *line) {
-	char *cline;
 	char *tok;
+	char *rest;
 	struct parser_hook *h;
 	struct parser_spec *s;
 	struct parser_value *v;
 	char *sp = NULL;
+	size_t len;
 
 	assert(p);
 	assert(line);
@@ -233,8 +413,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 
 	p->lineno++;
 	p->colno = 1;
-	p->fhead = NULL;
-	p->ftail = NULL;
 
 	/* Ignore empty lines and comments. */
 	while (*line && (isspace((unsigned char)*line)))
@@ -242,11 +420,13 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Copy the line to split it up in place */
+	len = strlen(line) + 1;
+	line_reserve(p, len);
+	memcpy(p->line, line, len);
 
-	tok = strtok(cline, ":");
+	tok = next_field(p->line, true, &rest);
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -255,7 +435,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
 
@@ -271,10 +450,10 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		 * at all (i.e., they consume the remainder of the line) */
 		if (t == PARSE_T_INT || t == PARSE_T_SYM || t == PARSE_T_RAND ||
 			t == PARSE_T_UINT) {
-			tok = strtok(sp, ":");
+			tok = next_field(sp, true, &rest);
 			sp = NULL;
 		} else if (t == PARSE_T_CHAR) {
-			tok = strtok(sp, "");
+			tok = next_field(sp, false, &rest);
 			if (tok) {
 				sp = utf8_fskip(tok, 1, NULL);
 				if (sp) {
@@ -284,38 +463,29 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 						my_strcpy(p->errmsg, s->name,
 							sizeof(p->errmsg));
 						p->error = PARSE_ERROR_FIELD_TOO_LONG;
-						mem_free(cline);
 						return PARSE_ERROR_FIELD_TOO_LONG;
 					}
 				}
 			}
 		} else {
-			tok = strtok(sp, "");
+			tok = next_field(sp, false, &rest);
 			sp = NULL;
 		}
 		if (!tok) {
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node. */
-		v = mem_alloc(sizeof *v);
-		v->spec.next = NULL;
-		v->spec.type = s->type;
-		v->spec.name = s->name;
-
 		/* Parse out its value. */
+		v = value_next(p, s);
 		if (t == PARSE_T_INT) {
 			char *z = NULL;
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -324,8 +494,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			char *z = NULL;
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-') {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -333,26 +501,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		} else if (t == PARSE_T_CHAR) {
 			text_mbstowcs(&v->u.cval, tok, 1);
 		} else if (t == PARSE_T_SYM || t == PARSE_T_STR) {
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		} else if (t == PARSE_T_RAND) {
 			if (!parse_random(tok, &v->u.rval)) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
 			}
 		}
-
-		/* Link it into the value list. */
-		if (!p->fhead)
-			p->fhead = v;
-		else
-			p->ftail->spec.next = &v->spec;
-		p->ftail = v;
+		value_done(p);
 	}
 
-	mem_free(cline);
+	if (p->recording) record_line(p, h);
 
 	p->error = h->func(p);
 	return p->error;
@@ -374,6 +534,156 @@ void parser_setpriv(struct parser *p, void *v) {
 	p->priv = v;
 }
 
+/**
+ * Starts keeping a record of the lines parsed from now on, throwing away any
+ * record kept before, or stops keeping one.
+ */
+void parser_record(struct parser *p, bool on) {
+	mem_free(p->record);
+	p->record = NULL;
+	p->record_len = 0;
+	p->record_max = 0;
+	p->recording = on;
+}
+
+/**
+ * Gets the record kept since parser_record() was last called, and its length.
+ */
+const uint8_t *parser_get_record(struct parser *p, size_t *len) {
+	*len = p->record_len;
+	return p->record;
+}
+
+/**
+ * Gets a hash of the parser's hooks and their fields, so a record is only
+ * replayed into the sort of parser it was made by.
+ */
+uint32_t parser_signature(struct parser *p) {
+	uint32_t hash = PARSER_RECORD_VERSION;
+	struct parser_hook *h;
+	struct parser_spec *s;
+
+	for (h = p->hooks; h; h = h->next) {
+		hash = hash * 33 + djb2_hash(h->dir);
+		for (s = h->fhead; s; s = s->next) {
+			hash = hash * 33 + djb2_hash(s->name);
+			hash = hash * 33 + s->type;
+		}
+		hash = hash * 33 + 1;
+	}
+	return hash;
+}
+
+static bool replay_bytes(const uint8_t **pos, const uint8_t *end, void *data,
+		size_t len)
+{
+	if ((size_t)(end - *pos) < len) return false;
+	memcpy(data, *pos, len);
+	*pos += len;
+	return true;
+}
+
+/**
+ * Runs the hook for the next line in a record starting at `*pos` and ending
+ * at `end`, just as parser_parse() would have for the line itself, and moves
+ * `*pos` on to the line after.  A broken record moves `*pos` to the end.
+ */
+enum parser_error parser_replay(struct parser *p, const uint8_t **pos,
+		const uint8_t *end) {
+	struct parser_hook *h;
+	struct parser_spec *s;
+	struct parser_value *v;
+	uint32_t lineno;
+	uint16_t index;
+	uint8_t n_values, i;
+	size_t used = 0;
+
+	parser_freeold(p);
+
+	/* Find the hooks by their place in the list */
+	if (!p->hook_list) {
+		p->n_hooks = 0;
+		for (h = p->hooks; h; h = h->next) p->n_hooks++;
+		p->hook_list = mem_alloc(p->n_hooks * sizeof(*p->hook_list));
+		p->n_hooks = 0;
+		for (h = p->hooks; h; h = h->next) p->hook_list[p->n_hooks++] = h;
+	}
+
+	if (!replay_bytes(pos, end, &lineno, sizeof(lineno)) ||
+			!replay_bytes(pos, end, &index, sizeof(index)) ||
+			!replay_bytes(pos, end, &n_values, sizeof(n_values)) ||
+			index >= p->n_hooks) {
+		*pos = end;
+		p->error = PARSE_ERROR_GENERIC;
+		return p->error;
+	}
+	p->lineno = lineno;
+	p->colno = 1;
+	h = p->hook_list[index];
+
+	for (i = 0, s = h->fhead; s && i < n_values; i++, s = s->next) {
+		int t = s->type & ~PARSE_T_OPT;
+		bool okay;
+
+		p->colno++;
+
+		/* Read the value, keeping any string in the line buffer */
+		v = value_next(p, s);
+		if (t == PARSE_T_INT) {
+			int32_t ival = 0;
+			okay = replay_bytes(pos, end, &ival, sizeof(ival));
+			v->u.ival = ival;
+		} else if (t == PARSE_T_UINT) {
+			uint32_t uval = 0;
+			okay = replay_bytes(pos, end, &uval, sizeof(uval));
+			v->u.uval = uval;
+		} else if (t == PARSE_T_CHAR) {
+			uint32_t cval = 0;
+			okay = replay_bytes(pos, end, &cval, sizeof(cval));
+			v->u.cval = cval;
+		} else if (t == PARSE_T_RAND) {
+			int32_t r[4] = { 0, 0, 0, 0 };
+			okay = replay_bytes(pos, end, r, sizeof(r));
+			v->u.rval.base = r[0];
+			v->u.rval.dice = r[1];
+			v->u.rval.sides = r[2];
+			v->u.rval.m_bonus = r[3];
+		} else {
+			uint16_t len;
+			okay = replay_bytes(pos, end, &len, sizeof(len)) &&
+				(size_t)(end - *pos) >= len;
+			if (okay) {
+				line_reserve(p, used + len + 1);
+				v = &p->values[p->n_values];
+				v->u.sval = p->line + used;
+				memcpy(v->u.sval, *pos, len);
+				v->u.sval[len] = '\0';
+				used += len + 1;
+				*pos += len;
+			}
+		}
+
+		if (!okay) {
+			my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
+			*pos = end;
+			p->error = PARSE_ERROR_GENERIC;
+			return p->error;
+		}
+		value_done(p);
+	}
+
+	/* The record must hold the mandatory fields, and no more than all */
+	if (i < n_values || (s && !(s->type & PARSE_T_OPT))) {
+		*pos = end;
+		p->error = PARSE_ERROR_GENERIC;
+		return p->error;
+	}
+	if (s) p->colno++;
+
+	p->error = h->func(p);
+	return p->error;
+}
+
 static int parse_type(const char *s) {
 	int rv = 0;
 	if (s[0] == '?') {
@@ -411,7 +721,11 @@ static void clean_specs(struct parser_hook *h) {
  */
 void parser_destroy(struct parser *p) {
 	struct parser_hook *h;
-	parser_freeold(p);
+	mem_free(p->values);
+	mem_free(p->line);
+	mem_free(p->table);
+	mem_free(p->record);
+	mem_free(p->hook_list);
 	while (p->hooks) {
 		h = p->hooks->next;
 		clean_specs(p->hooks);
@@ -516,7 +830,12 @@ errr parser_reg(struct parser *p, const char *fmt,
 	}
 
 	p->hooks = h;
+	addhook(p, h);
 	mem_free(cfmt);
+
+	/* Hooks have moved along the list */
+	mem_free(p->hook_list);
+	p->hook_list = NULL;
 	return 0;
 }
 
@@ -533,19 +852,19 @@ enum parser_error ignored(struct parser *p) {
  * Used to test for presence of optional values.
  */
 bool parser_hasval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name))
+	unsigned int i;
+	for (i = 0; i < p->n_values; i++) {
+		if (streq(p->values[i].spec->name, name))
 			return true;
 	}
 	return false;
 }
 
 static struct parser_value *parser_getval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name)) {
-			return v;
+	unsigned int i;
+	for (i = 0; i < p->n_values; i++) {
+		if (streq(p->values[i].spec->name, name)) {
+			return &p->values[i];
 		}
 	}
 	quit_fmt("parser_getval error: name is %s\n", name);
@@ -557,7 +876,7 @@ static struct parser_value *parser_getval(struct parser *p, const char *name) {
  */
 const char *parser_getsym(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_SYM);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_SYM);
 	return v->u.sval;
 }
 
@@ -566,7 +885,7 @@ const char *parser_getsym(struct parser *p, const char *name) {
  */
 int parser_getint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_INT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_INT);
 	return v->u.ival;
 }
 
@@ -575,7 +894,7 @@ int parser_getint(struct parser *p, const char *name) {
  */
 unsigned int parser_getuint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_UINT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_UINT);
 	return v->u.uval;
 }
 
@@ -584,7 +903,7 @@ unsigned int parser_getuint(struct parser *p, const char *name) {
  */
 const char *parser_getstr(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_STR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_STR);
 	return v->u.sval;
 }
 
@@ -593,7 +912,7 @@ const char *parser_getstr(struct parser *p, const char *name) {
  */
 struct random parser_getrand(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_RAND);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_RAND);
 	return v->u.rval;
 }
 
@@ -602,7 +921,7 @@ struct random parser_getrand(struct parser *p, const char *name) {
  */
 wchar_t parser_getchar(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_CHAR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_CHAR);
 	return v->u.cval;
 }
 
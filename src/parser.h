@@ -66,5 +66,10 @@ extern int parser_getstate(struct parser *p, struct parser_state *s);
 extern void parser_setstate(struct parser *p, enum parser_error ecode,
 		unsigned int line, unsigned int col, const char *msg);
 extern int get_parser_error_limit(void);
+extern void parser_record(struct parser *p, bool on);
+extern const uint8_t *parser_get_record(struct parser *p, size_t *len);
+extern uint32_t parser_signature(struct parser *p);
+extern enum parser_error parser_replay(struct parser *p, const uint8_t **pos,
+		const uint8_t *end);
 
 #endif /* !PARSER_H */
@@ -38,6 +38,7 @@
 #include "player-spell.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "z-prof.h"
 
 /**
  * Stat Table (INT) -- Magic devices
@@ -2567,6 +2568,7 @@ void update_stuff(struct player *p)
 	/* Update stuff */
 	if (!p->upkeep->update) return;
 
+	PROF_BEGIN(PROF_UPDATE_STUFF);
 
 	if (p->upkeep->update & (PU_INVEN)) {
 		p->upkeep->update &= ~(PU_INVEN);
@@ -2601,10 +2603,16 @@ void update_stuff(struct player *p)
 	}
 
 	/* Character is not ready yet, no map updates */
-	if (!character_generated) return;
+	if (!character_generated) {
+		PROF_END(PROF_UPDATE_STUFF);
+		return;
+	}
 
 	/* Map is not shown, no map updates */
-	if (!map_is_visible()) return;
+	if (!map_is_visible()) {
+		PROF_END(PROF_UPDATE_STUFF);
+		return;
+	}
 
 	if (p->upkeep->update & (PU_UPDATE_VIEW)) {
 		p->upkeep->update &= ~(PU_UPDATE_VIEW);
@@ -2627,6 +2635,7 @@ void update_stuff(struct player *p)
 		p->upkeep->update &= ~(PU_PANEL);
 		event_signal(EVENT_PLAYERMOVED);
 	}
+	PROF_END(PROF_UPDATE_STUFF);
 }
 
 
@@ -2727,7 +2736,9 @@ void redraw_stuff(struct player *p)
  */
 void handle_stuff(struct player *p)
 {
+	PROF_BEGIN(PROF_HANDLE_STUFF);
 	if (p->upkeep->update) update_stuff(p);
 	if (p->upkeep->redraw) redraw_stuff(p);
+	PROF_END(PROF_HANDLE_STUFF);
 }
 
@@ -51,7 +51,8 @@ static void project_feature_handler_LIGHT_WEAK(project_feature_handler_context_t
 	const struct loc grid = context->grid;
 
 	/* Turn on the light */
-	sqinfo_on(square(cave, grid)->info, SQUARE_GLOW);
+	sqinfo_on(square_info(cave, grid), SQUARE_GLOW);
+	cave_light_changed(cave, grid);
 
 	/* Grid is in line of sight */
 	if (square_isview(cave, grid)) {
@@ -72,7 +73,8 @@ static void project_feature_handler_DARK_WEAK(project_feature_handler_context_t
 
 	if ((player->depth != 0 || !is_daytime()) && !square_isbright(cave, grid)) {
 		/* Turn off the light */
-		sqinfo_off(square(cave, grid)->info, SQUARE_GLOW);
+		sqinfo_off(square_info(cave, grid), SQUARE_GLOW);
+		cave_light_changed(cave, grid);
 	}
 
 	/* Grid is in line of sight */
@@ -228,7 +228,7 @@ void thrust_away(struct loc centre, struct loc target, int grids_away)
 	}
 
 	/* Clear the projection mark. */
-	sqinfo_off(square(cave, grid)->info, SQUARE_PROJECT);
+	sqinfo_off(square_info(cave, grid), SQUARE_PROJECT);
 }
 
 /**
@@ -29,6 +29,7 @@
 #include "project.h"
 #include "source.h"
 #include "trap.h"
+#include "z-prof.h"
 
 struct projection *projections;
 
@@ -428,6 +429,214 @@ struct loc origin_get_loc(struct source origin)
 	return loc(-1, -1);
 }
 
+/**
+ * The grids around the centre of an explosion of each radius, other than the
+ * centre itself, in the order project() scans them, with their distances
+ * from the centre; built when a radius is first needed
+ */
+static struct blast_shape {
+	int count;
+	struct loc *offset;
+	int *dist;
+} *blast_shapes;
+static int blast_shapes_max;
+
+/**
+ * Marks kept for each grid of the box around an explosion while working out
+ * which grids it reaches
+ */
+#define BLAST_PROJ_KNOWN	0x01
+#define BLAST_PROJ			0x02
+#define BLAST_LOS_KNOWN		0x04
+#define BLAST_LOS			0x08
+#define BLAST_ON_PATH		0x10
+
+/**
+ * The box is the grids within half grids of the centre in each direction;
+ * its marks are kept in memory reused by every explosion
+ */
+struct blast_box {
+	struct chunk *c;
+	struct loc centre;
+	int half;
+	uint8_t *marks;
+};
+
+static uint8_t *blast_marks;
+static size_t blast_marks_size;
+
+static const struct blast_shape *blast_shape(int rad)
+{
+	struct blast_shape *shape;
+
+	if (rad >= blast_shapes_max) {
+		blast_shapes = mem_realloc(blast_shapes,
+			(rad + 1) * sizeof(*blast_shapes));
+		memset(blast_shapes + blast_shapes_max, 0,
+			(rad + 1 - blast_shapes_max) * sizeof(*blast_shapes));
+		blast_shapes_max = rad + 1;
+	}
+
+	shape = &blast_shapes[rad];
+	if (!shape->offset) {
+		int side = 2 * rad + 1;
+		struct loc off;
+
+		shape->offset = mem_alloc(side * side * sizeof(*shape->offset));
+		shape->dist = mem_alloc(side * side * sizeof(*shape->dist));
+		for (off.y = -rad; off.y <= rad; off.y++) {
+			for (off.x = -rad; off.x <= rad; off.x++) {
+				int d = distance(loc(0, 0), off);
+
+				if (loc_is_zero(off) || d > rad) continue;
+				shape->offset[shape->count] = off;
+				shape->dist[shape->count] = d;
+				shape->count++;
+			}
+		}
+	}
+
+	return shape;
+}
+
+/**
+ * Set up the box for an explosion of radius rad at centre, marking the grids
+ * of the projection path
+ */
+static void blast_box_init(struct blast_box *box, struct chunk *c,
+		struct loc centre, int rad, const struct loc *path_grid,
+		int num_path_grids)
+{
+	/* Walls look at their neighbours, so go one grid beyond the radius */
+	int side = 2 * (rad + 1) + 1, i;
+	size_t size = side * side;
+
+	if (size > blast_marks_size) {
+		mem_free(blast_marks);
+		blast_marks = mem_alloc(size);
+		blast_marks_size = size;
+	}
+	memset(blast_marks, 0, size);
+	box->c = c;
+	box->centre = centre;
+	box->half = rad + 1;
+	box->marks = blast_marks;
+
+	for (i = 0; i < num_path_grids; i++) {
+		struct loc off = loc_diff(path_grid[i], centre);
+
+		if (ABS(off.x) > box->half || ABS(off.y) > box->half) continue;
+		box->marks[(off.y + box->half) * side + off.x + box->half] |=
+			BLAST_ON_PATH;
+	}
+}
+
+static uint8_t *blast_box_mark(struct blast_box *box, struct loc off)
+{
+	int side = 2 * box->half + 1;
+
+	return &box->marks[(off.y + box->half) * side + off.x + box->half];
+}
+
+/**
+ * Whether the grid at off from the centre is projectable, looking it up only
+ * once per explosion
+ */
+static bool blast_projectable(struct blast_box *box, struct loc off)
+{
+	uint8_t *mark = blast_box_mark(box, off);
+
+	if (!(*mark & BLAST_PROJ_KNOWN)) {
+		*mark |= BLAST_PROJ_KNOWN;
+		if (square_isprojectable(box->c, loc_sum(box->centre, off)))
+			*mark |= BLAST_PROJ;
+	}
+	return (*mark & BLAST_PROJ) ? true : false;
+}
+
+/**
+ * Equivalent to los() from the centre to the grid at off, tracing each line
+ * only once per explosion along the precomputed sight lines
+ */
+static bool blast_los(struct blast_box *box, struct loc off)
+{
+	uint8_t *mark = blast_box_mark(box, off);
+
+	if (!(*mark & BLAST_LOS_KNOWN)) {
+		int ax = ABS(off.x), ay = ABS(off.y), n, i;
+		const struct loc *path;
+		bool clear = true;
+
+		/* Handle adjacent grids and "knights" as los() does */
+		if ((ax < 2) && (ay < 2)) {
+			clear = true;
+		} else if ((ax == 1) && (ay == 2) && blast_projectable(box,
+				loc(0, (off.y < 0) ? -1 : 1))) {
+			clear = true;
+		} else if ((ay == 1) && (ax == 2) && blast_projectable(box,
+				loc((off.x < 0) ? -1 : 1, 0))) {
+			clear = true;
+		} else if ((n = sight_line(off, &path)) < 0) {
+			clear = los(box->c, box->centre, loc_sum(box->centre, off));
+		} else {
+			for (i = 0; i < n && clear; i++)
+				clear = blast_projectable(box, path[i]);
+		}
+
+		*mark |= BLAST_LOS_KNOWN;
+		if (clear) *mark |= BLAST_LOS;
+	}
+	return (*mark & BLAST_LOS) ? true : false;
+}
+
+/**
+ * Damage done by an explosion at dist grids from its centre
+ */
+static int blast_damage(int dist, int rad, int dam, uint8_t diameter_of_source)
+{
+	uint32_t dam_temp;
+
+	if (dist > rad) {
+		/* No damage outside the radius. */
+		dam_temp = 0;
+	} else if ((!diameter_of_source) || (dist == 0)) {
+		/* Standard damage calc. for 10' source diameters, or at origin. */
+		dam_temp = (dam + dist) / (dist + 1);
+	} else {
+		/* If a particular diameter for the source of the explosion's
+		 * energy is given, it is full strength to that diameter and
+		 * then reduces */
+		dam_temp = (diameter_of_source * dam) / (dist + 1);
+		if (dam_temp > (uint32_t) dam) {
+			dam_temp = dam;
+		}
+	}
+
+	return dam_temp;
+}
+
+static void project_cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < blast_shapes_max; i++) {
+		mem_free(blast_shapes[i].offset);
+		mem_free(blast_shapes[i].dist);
+	}
+	mem_free(blast_shapes);
+	blast_shapes = NULL;
+	blast_shapes_max = 0;
+	mem_free(blast_marks);
+	blast_marks = NULL;
+	blast_marks_size = 0;
+}
+
+struct init_module project_module = {
+	.name = "project",
+	.init = NULL,
+	.cleanup = project_cleanup
+};
+
 /**
  * Generic "beam"/"bolt"/"ball" projection routine.
  *   -BEN-, some changes by -LM-
@@ -578,9 +787,7 @@ bool project(struct source origin, int rad, struct loc finish,
 			 int degrees_of_arc, uint8_t diameter_of_source,
 			 const struct object *obj)
 {
-	int i, j, k, dist_from_centre;
-
-	uint32_t dam_temp;
+	int i, j, k;
 
 	struct loc centre;
 	struct loc start;
@@ -615,8 +822,7 @@ bool project(struct source origin, int rad, struct loc finish,
 	/* Player visibility of each of the affected grids. */
 	bool player_sees_grid[256];
 
-	/* Precalculated damage values for each distance. */
-	int *dam_at_dist = mem_alloc((z_info->max_range + 1) * sizeof(*dam_at_dist));
+	PROF_BEGIN(PROF_PROJECT);
 
 	/* Flush any pending output */
 	handle_stuff(player);
@@ -661,7 +867,7 @@ bool project(struct source origin, int rad, struct loc finish,
 		blast_grid[num_grids] =  finish;
 		centre = finish;
 		distance_to_grid[num_grids] = 0;
-		sqinfo_on(square(cave, finish)->info, SQUARE_PROJECT);
+		sqinfo_on(square_info(cave, finish), SQUARE_PROJECT);
 		num_grids++;
 	} else {
 		/* Start from caster */
@@ -705,13 +911,13 @@ bool project(struct source origin, int rad, struct loc finish,
 					blast_grid[num_grids].y = y;
 					blast_grid[num_grids].x = x;
 					distance_to_grid[num_grids] = 0;
-					sqinfo_on(square(cave, loc(x, y))->info, SQUARE_PROJECT);
+					sqinfo_on(square_info(cave, loc(x, y)), SQUARE_PROJECT);
 					num_grids++;
 				} else if (i == num_path_grids - 1) {
 					blast_grid[num_grids].y = y;
 					blast_grid[num_grids].x = x;
 					distance_to_grid[num_grids] = 0;
-					sqinfo_on(square(cave, loc(x, y))->info, SQUARE_PROJECT);
+					sqinfo_on(square_info(cave, loc(x, y)), SQUARE_PROJECT);
 					num_grids++;
 				}
 
@@ -736,7 +942,8 @@ bool project(struct source origin, int rad, struct loc finish,
 	 * will affect; all non-beam projections with positive radius explode in
 	 * some way */
 	if ((rad > 0) && (!(flg & (PROJECT_BEAM)))) {
-		int y, x;
+		const struct blast_shape *shape;
+		struct blast_box box;
 
 		/* Pre-calculate some things for arcs. */
 		if ((flg & (PROJECT_ARC)) && (num_path_grids != 0)) {
@@ -762,123 +969,88 @@ bool project(struct source origin, int rad, struct loc finish,
 		if (num_grids == 0) {
 			blast_grid[num_grids] = centre;
 			distance_to_grid[num_grids] = 0;
-			sqinfo_on(square(cave, centre)->info, SQUARE_PROJECT);
+			sqinfo_on(square_info(cave, centre), SQUARE_PROJECT);
 			num_grids++;
 		}
 
 		/* Scan every grid that might possibly be in the blast radius. */
-		for (y = centre.y - rad; y <= centre.y + rad; y++) {
-			for (x = centre.x - rad; x <= centre.x + rad; x++) {
-				struct loc grid = loc(x, y);
-				bool on_path = false;
-
-				/* Center grid has already been stored. */
-				if (loc_eq(grid, centre))
-					continue;
+		shape = blast_shape(rad);
+		blast_box_init(&box, cave, centre, rad, path_grid, num_path_grids);
+		for (k = 0; k < shape->count; k++) {
+			struct loc off = shape->offset[k];
+			struct loc grid = loc_sum(centre, off);
+			bool on_path;
+
+			/* Precaution: Stay within area limit. */
+			if (num_grids >= 255)
+				break;
 
-				/* Precaution: Stay within area limit. */
-				if (num_grids >= 255)
-					break;
+			/* Ignore "illegal" locations */
+			if (!square_in_bounds(cave, grid))
+				continue;
 
-				/* Ignore "illegal" locations */
-				if (!square_in_bounds(cave, grid))
+			/* Note grids which are on the projection path */
+			on_path = (*blast_box_mark(&box, off) & BLAST_ON_PATH) ?
+				true : false;
+
+			/* Do we need to consider a restricted angle? */
+			if (flg & (PROJECT_ARC)) {
+				/* Use angle comparison to delineate an arc. */
+				int n2y, n2x, tmp, rotate, diff;
+
+				/* Reorient current grid for table access. */
+				n2y = grid.y - start.y + 20;
+				n2x = grid.x - start.x + 20;
+
+				/* Find the angular difference (/2) between the lines to
+				 * the end of the arc's center-line and to the current grid.
+				 */
+				rotate = 90 - get_angle_to_grid[n1y][n1x];
+				tmp = ABS(get_angle_to_grid[n2y][n2x] + rotate) % 180;
+				diff = ABS(90 - tmp);
+
+				/* If difference is greater then that allowed, skip it,
+				 * unless it's on the target path */
+				if ((diff >= (degrees_of_arc + 6) / 4) && !on_path)
 					continue;
+			}
 
-				/* Most explosions are immediately stopped by walls. If
-				 * PROJECT_THRU is set, walls can be affected if adjacent to
-				 * a grid visible from the explosion centre - note that as of
-				 * Angband 3.5.0 there are no such explosions - NRM.
-				 * All explosions can affect one layer of terrain which is
-				 * passable but not projectable */
-				if ((flg & (PROJECT_THRU)) || square_ispassable(cave, grid)) {
-					/* If this is a wall grid, ... */
-					if (!square_isprojectable(cave, grid)) {
-						bool can_see_one = false;
-						/* Check neighbors */
-						for (i = 0; i < 8; i++) {
-							struct loc adj_grid = loc_sum(grid, ddgrid_ddd[i]);
-							if (los(cave, centre, adj_grid)) {
-								can_see_one = true;
-								break;
-							}
+			/* Most explosions are immediately stopped by walls. If
+			 * PROJECT_THRU is set, walls can be affected if adjacent to
+			 * a grid visible from the explosion centre - note that as of
+			 * Angband 3.5.0 there are no such explosions - NRM.
+			 * All explosions can affect one layer of terrain which is
+			 * passable but not projectable */
+			if ((flg & (PROJECT_THRU)) || square_ispassable(cave, grid)) {
+				/* If this is a wall grid, ... */
+				if (!blast_projectable(&box, off)) {
+					bool can_see_one = false;
+					/* Check neighbors */
+					for (i = 0; i < 8; i++) {
+						struct loc adj = loc_sum(off, ddgrid_ddd[i]);
+						if (blast_los(&box, adj)) {
+							can_see_one = true;
+							break;
 						}
-
-						/* Require at least one adjacent grid in LOS. */
-						if (!can_see_one)
-							continue;
-					}
-				} else if (!square_isprojectable(cave, grid))
-					continue;
-
-				/* Must be within maximum distance. */
-				dist_from_centre  = (distance(centre, grid));
-				if (dist_from_centre > rad)
-					continue;
-
-				/* Mark grids which are on the projection path */
-				for (i = 0; i < num_path_grids; i++) {
-					if (loc_eq(grid, path_grid[i])) {
-						on_path = true;
 					}
-				}
 
-				/* Do we need to consider a restricted angle? */
-				if (flg & (PROJECT_ARC)) {
-					/* Use angle comparison to delineate an arc. */
-					int n2y, n2x, tmp, rotate, diff;
-
-					/* Reorient current grid for table access. */
-					n2y = y - start.y + 20;
-					n2x = x - start.x + 20;
-
-					/* Find the angular difference (/2) between the lines to
-					 * the end of the arc's center-line and to the current grid.
-					 */
-					rotate = 90 - get_angle_to_grid[n1y][n1x];
-					tmp = ABS(get_angle_to_grid[n2y][n2x] + rotate) % 180;
-					diff = ABS(90 - tmp);
-
-					/* If difference is greater then that allowed, skip it,
-					 * unless it's on the target path */
-					if ((diff >= (degrees_of_arc + 6) / 4) && !on_path)
+					/* Require at least one adjacent grid in LOS. */
+					if (!can_see_one)
 						continue;
 				}
+			} else if (!blast_projectable(&box, off))
+				continue;
 
-				/* Accept remaining grids if in LOS or on the projection path */
-				if (los(cave, centre, grid) || on_path) {
-					blast_grid[num_grids].y = y;
-					blast_grid[num_grids].x = x;
-					distance_to_grid[num_grids] = dist_from_centre;
-					sqinfo_on(square(cave, grid)->info, SQUARE_PROJECT);
-					num_grids++;
-				}
-			}
-		}
-	}
-
-	/* Calculate and store the actual damage at each distance. */
-	for (i = 0; i <= z_info->max_range; i++) {
-		if (i > rad) {
-			/* No damage outside the radius. */
-			dam_temp = 0;
-		} else if ((!diameter_of_source) || (i == 0)) {
-			/* Standard damage calc. for 10' source diameters, or at origin. */
-			dam_temp = (dam + i) / (i + 1);
-		} else {
-			/* If a particular diameter for the source of the explosion's
-			 * energy is given, it is full strength to that diameter and
-			 * then reduces */
-			dam_temp = (diameter_of_source * dam) / (i + 1);
-			if (dam_temp > (uint32_t) dam) {
-				dam_temp = dam;
+			/* Accept remaining grids if in LOS or on the projection path */
+			if (on_path || blast_los(&box, off)) {
+				blast_grid[num_grids] = grid;
+				distance_to_grid[num_grids] = shape->dist[k];
+				sqinfo_on(square_info(cave, grid), SQUARE_PROJECT);
+				num_grids++;
 			}
 		}
-
-		/* Store it. */
-		dam_at_dist[i] = dam_temp;
 	}
 
-
 	/* Sort the blast grids by distance from the centre. */
 	for (i = 0, k = 0; i <= rad; i++) {
 		/* Collect all the grids of a given distance together. */
@@ -919,7 +1091,8 @@ bool project(struct source origin, int rad, struct loc finish,
 	if (flg & (PROJECT_ITEM)) {
 		for (i = 0; i < num_grids; i++) {
 			if (project_o(origin, distance_to_grid[i], blast_grid[i],
-						  dam_at_dist[distance_to_grid[i]], typ, obj)) {
+						  blast_damage(distance_to_grid[i], rad, dam,
+									   diameter_of_source), typ, obj)) {
 				notice = true;
 			}
 		}
@@ -947,7 +1120,8 @@ bool project(struct source origin, int rad, struct loc finish,
 
 			/* Affect the monster in the grid */
 			project_m(origin, distance_to_grid[i], blast_grid[i],
-			          dam_at_dist[distance_to_grid[i]], typ, flg,
+			          blast_damage(distance_to_grid[i], rad, dam,
+			                       diameter_of_source), typ, flg,
 			          &did_hit, &was_obvious);
 			if (was_obvious) {
 				notice = true;
@@ -995,11 +1169,12 @@ bool project(struct source origin, int rad, struct loc finish,
 		}
 		for (i = 0; i < num_grids; i++) {
 			if (project_p(origin, distance_to_grid[i], blast_grid[i],
-						  dam_at_dist[distance_to_grid[i]], typ, power,
+						  blast_damage(distance_to_grid[i], rad, dam,
+									   diameter_of_source), typ, power,
 						  flg & PROJECT_SELF)) {
 				notice = true;
 				if (player->is_dead) {
-					mem_free(dam_at_dist);
+					PROF_END(PROF_PROJECT);
 					return notice;
 				}
 				break;
@@ -1011,7 +1186,8 @@ bool project(struct source origin, int rad, struct loc finish,
 	if (flg & (PROJECT_GRID)) {
 		for (i = 0; i < num_grids; i++) {
 			if (project_f(origin, distance_to_grid[i], blast_grid[i],
-						  dam_at_dist[distance_to_grid[i]], typ)) {
+						  blast_damage(distance_to_grid[i], rad, dam,
+									   diameter_of_source), typ)) {
 				notice = true;
 			}
 		}
@@ -1020,13 +1196,13 @@ bool project(struct source origin, int rad, struct loc finish,
 	/* Clear all the processing marks. */
 	for (i = 0; i < num_grids; i++) {
 		/* Clear the mark */
-		sqinfo_off(square(cave, blast_grid[i])->info, SQUARE_PROJECT);
+		sqinfo_off(square_info(cave, blast_grid[i]), SQUARE_PROJECT);
 	}
 
 	/* Update stuff if needed */
 	if (player->upkeep->update) update_stuff(player);
 
-	mem_free(dam_at_dist);
+	PROF_END(PROF_PROJECT);
 
 	/* Return "something was noticed" */
 	return (notice);
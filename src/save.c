@@ -786,7 +786,7 @@ static void wr_dungeon_aux(struct chunk *c)
 	wr_u16b(c->height);
 	wr_u16b(c->width);
 
-	/* Run length encoding of c->squares[y][x].info */
+	/* Run length encoding of the square flags */
 	for (i = 0; i < SQUARE_SIZE; i++) {
 		count = 0;
 		prev_char = 0;
@@ -794,8 +794,8 @@ static void wr_dungeon_aux(struct chunk *c)
 		/* Dump for each grid */
 		for (y = 0; y < c->height; y++) {
 			for (x = 0; x < c->width; x++) {
-				/* Extract the important c->squares[y][x].info flags */
-				tmp8u = square(c, loc(x, y))->info[i];
+				/* Extract the important square flags */
+				tmp8u = square_info(c, loc(x, y))[i];
 
 				/* If the run is broken, or too full, flush it */
 				if ((tmp8u != prev_char) || (count == UCHAR_MAX)) {
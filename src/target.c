@@ -451,33 +451,45 @@ struct point_set *target_get_monsters(int mode, monster_predicate pred,
 		max_x = player->grid.x + z_info->max_range + 1;
 	}
 
-	/* Scan for targets */
-	for (y = min_y; y < max_y; y++) {
-		for (x = min_x; x < max_x; x++) {
-			struct loc grid = loc(x, y);
+	/* Only the grids of monsters can hold a monster to kill */
+	if (mode & (TARGET_KILL)) {
+		const int *midx;
+		int n = cave_monsters_in(cave, loc(min_x, min_y),
+			loc(max_x - 1, max_y - 1), &midx), i;
+
+		for (i = 0; i < n; i++) {
+			struct monster *mon = cave_monster(cave, midx[i]);
 
 			/* Check bounds */
-			if (!square_in_bounds_fully(cave, grid)) continue;
+			if (!square_in_bounds_fully(cave, mon->grid)) continue;
 
 			/* Require "interesting" contents */
-			if (!target_accept(y, x)) continue;
+			if (!target_accept(mon->grid.y, mon->grid.x)) continue;
+
+			/* Must be a targettable monster */
+			if (!target_able(mon)) continue;
 
-			/* Special mode */
-			if (mode & (TARGET_KILL)) {
-				struct monster *mon = square_monster(cave, grid);
+			/* Must be the right sort of monster */
+			if (pred && !pred(mon)) continue;
+
+			/* Save the location */
+			add_to_point_set(targets, mon->grid);
+		}
+	} else {
+		/* Scan for targets */
+		for (y = min_y; y < max_y; y++) {
+			for (x = min_x; x < max_x; x++) {
+				struct loc grid = loc(x, y);
 
-				/* Must contain a monster */
-				if (mon == NULL) continue;
+				/* Check bounds */
+				if (!square_in_bounds_fully(cave, grid)) continue;
 
-				/* Must be a targettable monster */
-				if (!target_able(mon)) continue;
+				/* Require "interesting" contents */
+				if (!target_accept(y, x)) continue;
 
-				/* Must be the right sort of monster */
-				if (pred && !pred(mon)) continue;
+				/* Save the location */
+				add_to_point_set(targets, grid);
 			}
-
-			/* Save the location */
-			add_to_point_set(targets, grid);
 		}
 	}
 
@@ -0,0 +1,204 @@
+/* cave/light */
+/* Check that relighting only what has changed gives the same light levels as
+ * lighting the whole level, and count and time the grids relit. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-calcs.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Add some monsters which carry light or darkness */
+static void add_lit_monsters(int n)
+{
+	struct monster_group_info info = { 0, 0 };
+	int i;
+
+	for (i = 1; i < z_info->r_max && n > 0; i++) {
+		struct monster_race *race = &r_info[i];
+		struct loc grid;
+
+		if (!race->name || !race->light) continue;
+		if (rf_has(race->flags, RF_UNIQUE)) continue;
+		if (!cave_find(cave, &grid, square_isempty)) break;
+		if (place_new_monster(cave, grid, race, false, false, info,
+				ORIGIN_DROP)) {
+			n--;
+		}
+	}
+}
+
+/* Move the player or a monster a step, if there is room */
+static void step(struct loc grid)
+{
+	struct loc next = loc_sum(grid, ddgrid_ddd[randint0(8)]);
+
+	if (square_isempty(cave, next)) monster_swap(grid, next);
+}
+
+/* Do something which could change the light */
+static void random_change(void)
+{
+	struct loc grid;
+	int k = randint1(cave_monster_max(cave) - 1);
+
+	switch (randint0(8)) {
+		case 0:
+			if (cave_find(cave, &grid, square_isempty)) {
+				monster_swap(player->grid, grid);
+			}
+			break;
+		case 1:
+			player->state.cur_light = randint0(5) - 1;
+			break;
+		case 2:
+			if (cave_find(cave, &grid, square_isdoor)) {
+				if (square_iscloseddoor(cave, grid)) {
+					square_open_door(cave, grid);
+				} else if (square_isopendoor(cave, grid)) {
+					square_close_door(cave, grid);
+				}
+			}
+			break;
+		case 3:
+			light_room(player->grid, one_in_(2));
+			break;
+		case 4:
+			if (cave_monster(cave, k)->race) {
+				step(cave_monster(cave, k)->grid);
+			}
+			break;
+		default:
+			step(player->grid);
+			break;
+	}
+}
+
+/* Check the light levels against lighting the whole level again */
+static bool light_matches(struct chunk *c)
+{
+	int n = c->height * c->width;
+	int *kept = mem_alloc(n * sizeof(*kept));
+	bool same;
+
+	memcpy(kept, c->light, n * sizeof(*kept));
+	cave_forget_light(c);
+	update_view(c, player);
+	same = !memcmp(kept, c->light, n * sizeof(*kept));
+	mem_free(kept);
+	return same;
+}
+
+static int test_golden(void *state) {
+	int depths[] = { 1, 10, 30, 60, 90 };
+	int i, j;
+
+	for (i = 0; i < (int)N_ELEMENTS(depths); i++) {
+		t_new_level(depths[i]);
+		add_lit_monsters(12);
+		update_view(cave, player);
+		for (j = 0; j < 50; j++) {
+			random_change();
+			update_view(cave, player);
+			require(light_matches(cave));
+		}
+	}
+	ok;
+}
+
+static int test_town(void *state) {
+	int j;
+
+	t_new_level(0);
+	update_view(cave, player);
+	for (j = 0; j < 20; j++) {
+		if (j % 5 == 0) cave_illuminate(cave, j % 10 == 0);
+		step(player->grid);
+		update_view(cave, player);
+		require(light_matches(cave));
+	}
+	ok;
+}
+
+static int test_bench(void *state) {
+	int updates = 2000, i;
+	uint32_t relit, n_updates;
+	clock_t start;
+	double t_full, t_relit;
+
+	bench_only();
+	Rand_state_init(42);
+	t_new_level(20);
+	add_lit_monsters(12);
+	player->state.cur_light = 2;
+
+	start = clock();
+	for (i = 0; i < updates; i++) {
+		cave_forget_light(cave);
+		update_view(cave, player);
+	}
+	t_full = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	relit = cave->lighting.relit_total;
+	n_updates = cave->lighting.updates;
+	start = clock();
+	for (i = 0; i < updates; i++) {
+		int k = randint1(cave_monster_max(cave) - 1);
+
+		step(player->grid);
+		if (cave_monster(cave, k)->race) {
+			step(cave_monster(cave, k)->grid);
+		}
+		update_view(cave, player);
+	}
+	t_relit = (double)(clock() - start) / CLOCKS_PER_SEC;
+	relit = cave->lighting.relit_total - relit;
+	n_updates = cave->lighting.updates - n_updates;
+
+	if (verbose) {
+		printf("\n    %dx%d level: %.0f grids relit per update,"
+			" %.0f views per second (%.0f lighting it all)\n    ",
+			cave->width, cave->height, (double)relit / n_updates,
+			(t_relit > 0) ? updates / t_relit : 0.0,
+			(t_full > 0) ? updates / t_full : 0.0);
+	}
+	eq(n_updates, (uint32_t)updates);
+	require(relit < n_updates * cave->height * cave->width);
+	ok;
+}
+
+const char *suite_name = "cave/light";
+struct test tests[] = {
+	{ "golden", test_golden },
+	{ "town", test_town },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,217 @@
+/* cave/monsters */
+/* Check that the monsters a chunk keeps grouped by block match the grids as
+ * monsters are placed, moved, swapped, killed and compacted, and time how
+ * many neighbourhood searches can be made per second. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Add a monster of a random race on an empty grid */
+static bool add_monster(void)
+{
+	struct monster_group_info info = { 0, 0 };
+	int i;
+
+	for (i = 0; i < 20; i++) {
+		struct monster_race *race = &r_info[randint1(z_info->r_max - 2)];
+		struct loc grid;
+
+		if (!race->name || rf_has(race->flags, RF_UNIQUE)) continue;
+		if (!cave_find(cave, &grid, square_isempty)) return false;
+		if (place_new_monster(cave, grid, race, false, false, info,
+				ORIGIN_DROP)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Go to a new level of the given depth, adding monsters */
+static void new_level(int depth, int n_monsters)
+{
+	t_new_level(depth);
+	player->upkeep->generate_level = false;
+	while (n_monsters-- > 0 && add_monster()) ;
+}
+
+/* Check a search against a scan of the grids, row by row */
+static bool search_matches(struct loc centre, int radius, bool rect)
+{
+	const int *midx;
+	int n = rect ?
+		cave_monsters_in(cave, loc(centre.x - radius, centre.y - radius),
+			loc(centre.x + radius, centre.y + radius), &midx) :
+		cave_monsters_near(cave, centre, radius, &midx);
+	int found = 0;
+	struct loc grid;
+
+	for (grid.y = centre.y - radius; grid.y <= centre.y + radius; grid.y++) {
+		for (grid.x = centre.x - radius; grid.x <= centre.x + radius;
+				grid.x++) {
+			int m;
+
+			if (!square_in_bounds(cave, grid)) continue;
+			m = square(cave, grid)->mon;
+			if (m <= 0) continue;
+			if (!rect && distance(centre, grid) > radius) continue;
+			if (found >= n || midx[found] != m) return false;
+			if (!loc_eq(cave_monster(cave, m)->grid, grid)) return false;
+			found++;
+		}
+	}
+	return found == n;
+}
+
+/* Check searches of many sizes all over the level */
+static bool searches_match(void)
+{
+	int i;
+
+	for (i = 0; i < 200; i++) {
+		struct loc centre = loc(randint0(cave->width),
+			randint0(cave->height));
+		int radius = randint0(25);
+
+		if (!search_matches(centre, radius, one_in_(2))) return false;
+	}
+	return true;
+}
+
+/* Pick a random live monster */
+static struct monster *any_monster(void)
+{
+	int i;
+
+	for (i = 0; i < 100; i++) {
+		struct monster *mon = cave_monster(cave,
+			randint1(cave_monster_max(cave) - 1));
+
+		if (mon && mon->race) return mon;
+	}
+	return NULL;
+}
+
+static int test_index(void *state) {
+	int i, j;
+
+	Rand_state_init(21);
+	for (i = 0; i < 3; i++) {
+		new_level(10 + 15 * i, 150);
+		require(searches_match());
+		for (j = 0; j < 3000; j++) {
+			struct monster *mon = any_monster(), *other = any_monster();
+			struct loc grid;
+
+			if (!mon || !other) break;
+			switch (randint0(5)) {
+				case 0:
+					/* Walk to an empty grid */
+					if (cave_find(cave, &grid, square_isempty)) {
+						monster_swap(mon->grid, grid);
+					}
+					break;
+				case 1:
+					/* Change places */
+					monster_swap(mon->grid, other->grid);
+					break;
+				case 2:
+					delete_monster_idx(cave, mon->midx);
+					break;
+				case 3:
+					add_monster();
+					break;
+				default:
+					/* Fill the holes, renumbering monsters */
+					if (one_in_(20)) compact_monsters(cave, 0);
+					break;
+			}
+			if (j % 100 == 0) require(searches_match());
+		}
+		require(searches_match());
+	}
+	ok;
+}
+
+static int test_bench(void *state) {
+	int searches = 200000, found = 0, i;
+	clock_t start;
+	double t_scan, t;
+
+	bench_only();
+	Rand_state_init(22);
+	new_level(40, 300);
+
+	Rand_state_init(23);
+	start = clock();
+	for (i = 0; i < searches; i++) {
+		struct loc centre = loc(randint0(cave->width),
+			randint0(cave->height)), grid;
+
+		for (grid.y = centre.y - 5; grid.y <= centre.y + 5; grid.y++) {
+			for (grid.x = centre.x - 5; grid.x <= centre.x + 5; grid.x++) {
+				if (square_in_bounds(cave, grid)
+						&& square(cave, grid)->mon > 0
+						&& distance(centre, grid) <= 5) {
+					found++;
+				}
+			}
+		}
+	}
+	t_scan = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	Rand_state_init(23);
+	start = clock();
+	for (i = 0; i < searches; i++) {
+		const int *midx;
+		struct loc centre = loc(randint0(cave->width),
+			randint0(cave->height));
+
+		found -= cave_monsters_near(cave, centre, 5, &midx);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	eq(found, 0);
+	if (verbose) {
+		printf("\n    %d monsters: %.0f radius 5 searches per second (%.0f"
+			" scanning the grids)\n    ", cave_monster_count(cave),
+			(t > 0) ? searches / t : 0.0,
+			(t_scan > 0) ? searches / t_scan : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "cave/monsters";
+struct test tests[] = {
+	{ "index", test_index },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,229 @@
+/* cave/noise */
+/* Check that the noise field matches a full flood of the level as the
+ * centre moves and the terrain changes, and time how much a move costs. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "init.h"
+#include "z-queue.h"
+#include "z-rand.h"
+#include <time.h>
+
+#define NOISE_HGT 66
+#define NOISE_WID 198
+
+/* Flood the level from scratch the way make_noise() always used to */
+static void reference_noise(struct chunk *c, uint16_t **ref,
+		struct loc centre, int step)
+{
+	struct queue *queue = q_new(c->height * c->width);
+	struct loc next = centre;
+	int y, d, noise = 0;
+
+	for (y = 0; y < c->height; y++) {
+		memset(ref[y], 0, c->width * sizeof(ref[y][0]));
+	}
+	q_push_int(queue, next.y * c->width + next.x);
+	noise += step;
+	while (q_len(queue) > 0) {
+		int i = q_pop_int(queue);
+
+		next = loc(i % c->width, i / c->width);
+		if (ref[next.y][next.x] == noise) {
+			q_push_int(queue, i);
+			noise += step;
+			continue;
+		}
+		for (d = 0; d < 8; d++) {
+			struct loc grid = loc_sum(next, ddgrid_ddd[d]);
+
+			if (!square_in_bounds(c, grid)) continue;
+			if (square_isnoflow(c, grid)) continue;
+			if (ref[grid.y][grid.x] != 0) continue;
+			if (loc_eq(centre, grid)) continue;
+			ref[grid.y][grid.x] = noise;
+			q_push_int(queue, grid.y * c->width + grid.x);
+		}
+	}
+	q_free(queue);
+}
+
+static bool noise_matches(struct chunk *c, uint16_t **ref)
+{
+	int y;
+
+	for (y = 1; y < c->height - 1; y++) {
+		if (memcmp(c->noise.grids[y] + 1, ref[y] + 1,
+				(c->width - 2) * sizeof(ref[y][0]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* A cavern: floor with about a third of the grids turned to granite */
+static struct chunk *create_cavern(void)
+{
+	struct chunk *c = t_build_arena(NOISE_HGT, NOISE_WID);
+	struct loc grid;
+
+	for (grid.y = 1; grid.y < c->height - 1; grid.y++) {
+		for (grid.x = 1; grid.x < c->width - 1; grid.x++) {
+			if (one_in_(3)) square_set_feat(c, grid, FEAT_GRANITE);
+		}
+	}
+	return c;
+}
+
+/* Take a step in a random direction, if there is floor to step onto */
+static struct loc random_step(struct chunk *c, struct loc grid)
+{
+	struct loc next = loc_sum(grid, ddgrid_ddd[randint0(8)]);
+
+	return square_isfloor(c, next) ? next : grid;
+}
+
+static uint16_t **alloc_reference(struct chunk *c)
+{
+	uint16_t **ref = mem_zalloc(c->height * sizeof(*ref));
+	int y;
+
+	for (y = 0; y < c->height; y++) {
+		ref[y] = mem_zalloc(c->width * sizeof(**ref));
+	}
+	return ref;
+}
+
+static void free_reference(struct chunk *c, uint16_t **ref)
+{
+	int y;
+
+	for (y = 0; y < c->height; y++) {
+		mem_free(ref[y]);
+	}
+	mem_free(ref);
+}
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+	Rand_init();
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cleanup_angband();
+	return 0;
+}
+
+static int test_moves(void *state) {
+	struct chunk *c = create_cavern();
+	uint16_t **ref = alloc_reference(c);
+	struct loc centre = loc(NOISE_WID / 2, NOISE_HGT / 2);
+	int i;
+
+	square_set_feat(c, centre, FEAT_FLOOR);
+	for (i = 0; i < 100; i++) {
+		int step = (i % 50 < 40) ? 1 : 4;
+
+		if (i % 3) centre = random_step(c, centre);
+		cave_update_flow(c, centre, step);
+		reference_noise(c, ref, centre, step);
+		require(noise_matches(c, ref));
+	}
+	free_reference(c, ref);
+	cave_free(c);
+	ok;
+}
+
+static int test_terrain(void *state) {
+	struct chunk *c = create_cavern();
+	uint16_t **ref = alloc_reference(c);
+	struct loc centre = loc(NOISE_WID / 2, NOISE_HGT / 2);
+	int i, j;
+
+	square_set_feat(c, centre, FEAT_FLOOR);
+	cave_update_flow(c, centre, 1);
+	for (i = 0; i < 80; i++) {
+		/* Tunnel through some walls, and sometimes build one */
+		for (j = randint0(FLOW_OPENED_MAX + 4); j > 0; j--) {
+			struct loc grid = loc(rand_range(1, NOISE_WID - 2),
+				rand_range(1, NOISE_HGT - 2));
+
+			if (square_isgranite(c, grid)) {
+				square_set_feat(c, grid, FEAT_FLOOR);
+			}
+		}
+		if (one_in_(10)) {
+			struct loc grid = loc(rand_range(1, NOISE_WID - 2),
+				rand_range(1, NOISE_HGT - 2));
+
+			if (!loc_eq(grid, centre)) {
+				square_set_feat(c, grid, FEAT_GRANITE);
+			}
+		}
+		cave_update_flow(c, centre, 1);
+		reference_noise(c, ref, centre, 1);
+		require(noise_matches(c, ref));
+	}
+	free_reference(c, ref);
+	cave_free(c);
+	ok;
+}
+
+static int test_bench(void *state) {
+	struct chunk *c;
+	uint16_t **ref;
+	struct loc centre = loc(NOISE_WID / 2, NOISE_HGT / 2);
+	int moves = 200, i;
+	clock_t start;
+	double t_full, t_move, t_still;
+
+	bench_only();
+	c = create_cavern();
+	ref = alloc_reference(c);
+	square_set_feat(c, centre, FEAT_FLOOR);
+
+	start = clock();
+	for (i = 0; i < moves; i++) {
+		centre = random_step(c, centre);
+		reference_noise(c, ref, centre, 1);
+	}
+	t_full = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < moves; i++) {
+		centre = random_step(c, centre);
+		cave_update_flow(c, centre, 1);
+	}
+	t_move = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < moves; i++) {
+		cave_update_flow(c, centre, 1);
+	}
+	t_still = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	if (verbose) {
+		printf("\n    %dx%d, per turn: old flood %.1fus, move %.1fus,"
+			" no move %.3fus\n    ", NOISE_WID, NOISE_HGT,
+			1e6 * t_full / moves, 1e6 * t_move / moves,
+			1e6 * t_still / moves);
+	}
+	reference_noise(c, ref, centre, 1);
+	require(noise_matches(c, ref));
+	free_reference(c, ref);
+	cave_free(c);
+	ok;
+}
+
+const char *suite_name = "cave/noise";
+struct test tests[] = {
+	{ "moves", test_moves },
+	{ "terrain", test_terrain },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,68 @@
+/* cave/scent */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "init.h"
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+	*state = t_build_arena(7, 9);
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(state);
+	cleanup_angband();
+	return 0;
+}
+
+static int test_lay(void *state) {
+	struct chunk *c = state;
+	struct loc grid = loc(3, 3);
+
+	eq(cave_scent_age(c, grid), 0);
+	cave_lay_scent(c, grid, 2);
+	eq(cave_scent_age(c, grid), 2);
+	cave_age_scent(c);
+	eq(cave_scent_age(c, grid), 3);
+	cave_lay_scent(c, grid, 1);
+	eq(cave_scent_age(c, grid), 1);
+	cave_lay_scent(c, grid, 0);
+	eq(cave_scent_age(c, grid), 0);
+	cave_age_scent(c);
+	eq(cave_scent_age(c, grid), 0);
+	ok;
+}
+
+static int test_clock_runs_out(void *state) {
+	struct chunk *c = state;
+	struct loc fresh = loc(2, 2), stale = loc(4, 4), none = loc(5, 5);
+	int i;
+
+	cave_lay_scent(c, stale, 1);
+	cave_lay_scent(c, none, 0);
+	for (i = 0; i < 0x10000 - 20; i++) {
+		cave_age_scent(c);
+	}
+	cave_lay_scent(c, fresh, 2);
+	for (i = 0; i < 10; i++) {
+		cave_age_scent(c);
+	}
+
+	/* Scent survives the clock being reset, unless it's far too old */
+	eq(cave_scent_age(c, fresh), 12);
+	eq(cave_scent_age(c, stale), 0);
+	eq(cave_scent_age(c, none), 0);
+	ok;
+}
+
+const char *suite_name = "cave/scent";
+struct test tests[] = {
+	{ "lay", test_lay },
+	{ "clock-runs-out", test_clock_runs_out },
+	{ NULL, NULL }
+};
@@ -1,3 +1,9 @@
 TESTPROGS += \
 	cave/find \
-	cave/scatter
+	cave/light \
+	cave/monsters \
+	cave/noise \
+	cave/scatter \
+	cave/scent \
+	cave/terrain \
+	cave/view
@@ -0,0 +1,158 @@
+/* cave/terrain */
+/* Check that the grids a chunk keeps grouped by terrain match the terrain as
+ * it changes, that cave_find() still picks any suitable grid with the same
+ * chance, and time how many grids it can find per second. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Check the grids listed for each feature against the terrain */
+static bool terrain_matches(struct chunk *c)
+{
+	int n = c->height * c->width, total = 0, f, i;
+	uint8_t *seen = mem_zalloc(n * sizeof(*seen));
+	bool same = true;
+
+	for (f = 0; f < FEAT_MAX && same; f++) {
+		const int *grids;
+		int count = cave_terrain_grids(c, f, &grids);
+
+		for (i = 0; i < count && same; i++) {
+			same = !seen[grids[i]] && c->squares[0][grids[i]].feat == f
+				&& c->terrain.grids[c->terrain.pos[grids[i]]] == grids[i];
+			seen[grids[i]] = 1;
+		}
+		total += count;
+	}
+	mem_free(seen);
+	return same && total == n;
+}
+
+static int test_index(void *state) {
+	int feats[] = { FEAT_FLOOR, FEAT_GRANITE, FEAT_RUBBLE, FEAT_MAGMA,
+		FEAT_LESS, FEAT_CLOSED, FEAT_PERM, FEAT_LAVA };
+	int i, j;
+
+	Rand_state_init(5);
+	for (i = 0; i < 3; i++) {
+		t_new_level(5 + 20 * i);
+		require(terrain_matches(cave));
+		for (j = 0; j < 2000; j++) {
+			struct loc grid = loc(rand_range(1, cave->width - 2),
+				rand_range(1, cave->height - 2));
+
+			if (square(cave, grid)->mon || square_object(cave, grid)) {
+				continue;
+			}
+			square_set_feat(cave, grid,
+				feats[randint0(N_ELEMENTS(feats))]);
+			if (j % 100 == 0) require(terrain_matches(cave));
+		}
+		require(terrain_matches(cave));
+	}
+	ok;
+}
+
+static int test_uniform(void *state) {
+	struct chunk *c = t_build_arena(7, 7);
+	int counts[25] = { 0 };
+	int tries = 25000, i;
+	struct loc grid;
+
+	/* A 5x5 room, three of whose grids are no good */
+	square_set_feat(c, loc(1, 1), FEAT_RUBBLE);
+	square_set_feat(c, loc(3, 3), FEAT_CLOSED);
+	square_set_mon(c, loc(5, 5), 1);
+	for (i = 0; i < tries; i++) {
+		require(cave_find(c, &grid, square_isempty));
+		require(square_isempty(c, grid));
+		counts[(grid.y - 1) * 5 + grid.x - 1]++;
+	}
+
+	/* Each of the other 22 should turn up about 1136 times */
+	for (i = 0; i < 25; i++) {
+		if (i == 0 || i == 12 || i == 24) {
+			eq(counts[i], 0);
+		} else {
+			require(counts[i] > 950 && counts[i] < 1330);
+		}
+	}
+
+	/* Nothing to find */
+	for (grid.y = 1; grid.y < 6; grid.y++) {
+		for (grid.x = 1; grid.x < 6; grid.x++) {
+			square_set_feat(c, grid, FEAT_GRANITE);
+		}
+	}
+	require(!cave_find(c, &grid, square_isempty));
+	require(!find_empty(c, &grid));
+	square_set_mon(c, loc(5, 5), 0);
+	cave_free(c);
+	ok;
+}
+
+static int test_bench(void *state) {
+	int finds = 20000, i;
+	clock_t start;
+	double t_rect, t;
+	struct loc grid;
+
+	bench_only();
+	Rand_state_init(42);
+	t_new_level(20);
+	start = clock();
+	for (i = 0; i < finds; i++) {
+		cave_find_in_range(cave, &grid, loc(0, 0),
+			loc(cave->width - 1, cave->height - 1), square_isempty);
+	}
+	t_rect = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < finds; i++) {
+		find_empty(cave, &grid);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %dx%d level: %.0f finds per second (%.0f searching"
+			" the whole level)\n    ", cave->width, cave->height,
+			(t > 0) ? finds / t : 0.0, (t_rect > 0) ? finds / t_rect : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "cave/terrain";
+struct test tests[] = {
+	{ "index", test_index },
+	{ "uniform", test_uniform },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
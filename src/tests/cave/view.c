@@ -0,0 +1,205 @@
+/* cave/view */
+/* Check update_view() against a grid by grid use of los() on generated
+ * levels, and time how many views it can do per second. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-calcs.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* How the view used to be worked out: every grid, using los() directly */
+static void reference_one(struct chunk *c, struct player *p, struct loc grid,
+		bool *view, bool *seen)
+{
+	int i = grid.y * c->width + grid.x;
+	int xc = grid.x, yc = grid.y;
+	int d = distance(grid, p->grid);
+	bool close = d < p->state.cur_light;
+
+	if (d > z_info->max_sight) return;
+	if (player_has(p, PF_UNLIGHT) && (p->state.cur_light <= 1)) {
+		close = d < (2 + p->lev / 6 - p->state.cur_light);
+	}
+	if (!square_allowslos(c, grid)) {
+		int dx = grid.x - p->grid.x, dy = grid.y - p->grid.y;
+		int ax = ABS(dx), ay = ABS(dy);
+		int sx = dx > 0 ? 1 : -1, sy = dy > 0 ? 1 : -1;
+
+		xc = (grid.x < p->grid.x) ? (grid.x + 1) :
+			(grid.x > p->grid.x) ? (grid.x - 1) : grid.x;
+		yc = (grid.y < p->grid.y) ? (grid.y + 1) :
+			(grid.y > p->grid.y) ? (grid.y - 1) : grid.y;
+		if (!square_allowslos(c, loc(xc, yc))) {
+			xc = grid.x;
+			yc = grid.y;
+		}
+		if (ax == 2 && ay == 1) {
+			if (square_allowslos(c, loc(grid.x - sx, grid.y))
+					&& !square_allowslos(c,
+					loc(grid.x - sx, grid.y - sy))) {
+				xc = grid.x;
+				yc = grid.y;
+			}
+		} else if (ax == 1 && ay == 2) {
+			if (square_allowslos(c, loc(grid.x, grid.y - sy))
+					&& !square_allowslos(c,
+					loc(grid.x - sx, grid.y - sy))) {
+				xc = grid.x;
+				yc = grid.y;
+			}
+		}
+	}
+	if (!los(c, p->grid, loc(xc, yc)) || view[i]) return;
+
+	view[i] = true;
+	if (close) seen[i] = true;
+	if (square_islit(c, grid)) {
+		if (!square_allowslos(c, grid)) {
+			xc = (grid.x < p->grid.x) ? (grid.x + 1) :
+				(grid.x > p->grid.x) ? (grid.x - 1) : grid.x;
+			yc = (grid.y < p->grid.y) ? (grid.y + 1) :
+				(grid.y > p->grid.y) ? (grid.y - 1) : grid.y;
+			if (square_islit(c, loc(xc, yc))) seen[i] = true;
+		} else {
+			seen[i] = true;
+		}
+	}
+}
+
+static void reference_view(struct chunk *c, struct player *p, bool *view,
+		bool *seen)
+{
+	int n = c->height * c->width, i;
+	struct loc grid;
+
+	memset(view, 0, n * sizeof(*view));
+	memset(seen, 0, n * sizeof(*seen));
+	i = p->grid.y * c->width + p->grid.x;
+	view[i] = true;
+	if (p->state.cur_light > 0 || square_islit(c, p->grid) ||
+			player_has(p, PF_UNLIGHT)) {
+		seen[i] = true;
+	}
+	for (grid.y = 0; grid.y < c->height; grid.y++) {
+		for (grid.x = 0; grid.x < c->width; grid.x++) {
+			reference_one(c, p, grid, view, seen);
+		}
+	}
+	if (p->timed[TMD_BLIND]) {
+		memset(seen, 0, n * sizeof(*seen));
+	}
+}
+
+static bool view_matches(struct chunk *c, bool *view, bool *seen)
+{
+	struct loc grid;
+
+	for (grid.y = 0; grid.y < c->height; grid.y++) {
+		for (grid.x = 0; grid.x < c->width; grid.x++) {
+			int i = grid.y * c->width + grid.x;
+
+			if (square_isview(c, grid) != view[i]) return false;
+			if (square_isseen(c, grid) != seen[i]) return false;
+			if (square_wasseen(c, grid)) return false;
+		}
+	}
+	return true;
+}
+
+/* Move the player to a random empty grid, or a step away */
+static void move_player(bool step)
+{
+	struct loc grid;
+
+	if (step) {
+		grid = loc_sum(player->grid, ddgrid_ddd[randint0(8)]);
+		if (!square_isempty(cave, grid)) return;
+	} else if (!cave_find(cave, &grid, square_isempty)) {
+		return;
+	}
+	monster_swap(player->grid, grid);
+}
+
+static int test_golden(void *state) {
+	int depths[] = { 1, 5, 15, 30, 50, 75, 98 };
+	int i, j;
+
+	for (i = 0; i < (int)N_ELEMENTS(depths); i++) {
+		bool *view, *seen;
+
+		t_new_level(depths[i]);
+		view = mem_zalloc(cave->height * cave->width * sizeof(*view));
+		seen = mem_zalloc(cave->height * cave->width * sizeof(*seen));
+		for (j = 0; j < 24; j++) {
+			move_player(j % 4 != 0);
+			player->state.cur_light = randint0(4);
+			player->timed[TMD_BLIND] = one_in_(10) ? 1 : 0;
+			update_view(cave, player);
+			reference_view(cave, player, view, seen);
+			require(view_matches(cave, view, seen));
+		}
+		player->timed[TMD_BLIND] = 0;
+		mem_free(seen);
+		mem_free(view);
+	}
+	ok;
+}
+
+static int test_bench(void *state) {
+	int views = 2000, i;
+	clock_t start;
+	double t;
+
+	bench_only();
+	Rand_state_init(42);
+	t_new_level(20);
+	player->state.cur_light = 2;
+	start = clock();
+	for (i = 0; i < views; i++) {
+		move_player(true);
+		update_view(cave, player);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %dx%d level: %.0f views per second\n    ",
+			cave->width, cave->height, (t > 0) ? views / t : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "cave/view";
+struct test tests[] = {
+	{ "golden", test_golden },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
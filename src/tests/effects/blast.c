@@ -0,0 +1,241 @@
+/* effects/blast */
+/* Check the grids project() catches in balls and arcs against the old grid
+ * by grid scan with los() on generated levels, and time the explosions. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-event.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "project.h"
+#include "source.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* The grids of the last explosion, as project() reported them */
+static struct loc got_grid[256];
+static int got_dist[256];
+static int got_n;
+
+static void catch_explosion(game_event_type type, game_event_data *data,
+		void *user)
+{
+	got_n = data->explosion.num_grids;
+	memcpy(got_grid, data->explosion.blast_grid, got_n * sizeof(*got_grid));
+	memcpy(got_dist, data->explosion.distance_to_grid,
+		got_n * sizeof(*got_dist));
+}
+
+/* How project() used to find the grids: every grid of the box, using los() */
+static int reference_blast(struct loc start, struct loc finish, int rad,
+		int flg, int degrees_of_arc, struct loc *blast_grid,
+		int *distance_to_grid)
+{
+	struct loc path_grid[512], centre = start;
+	int num_path_grids = 0, num_grids = 0, n1y = 0, n1x = 0, i, j, k;
+	struct loc grid;
+
+	if (loc_eq(start, finish)) {
+		blast_grid[num_grids] = finish;
+		distance_to_grid[num_grids++] = 0;
+	} else {
+		num_path_grids = project_path(cave, path_grid, z_info->max_range,
+			start, finish, flg);
+		if (!(flg & PROJECT_ARC)) {
+			for (i = 0; i < num_path_grids; i++) {
+				if (!square_ispassable(cave, path_grid[i])) break;
+				centre = path_grid[i];
+			}
+			blast_grid[num_grids] = centre;
+			distance_to_grid[num_grids++] = 0;
+		}
+	}
+
+	if ((flg & PROJECT_ARC) && num_path_grids != 0) {
+		centre = start;
+		if (rad > 20) rad = 20;
+		i = (num_path_grids < 21) ? num_path_grids - 1 : 20;
+		n1y = path_grid[i].y - centre.y + 20;
+		n1x = path_grid[i].x - centre.x + 20;
+	}
+	if (num_grids == 0) {
+		blast_grid[num_grids] = centre;
+		distance_to_grid[num_grids++] = 0;
+	}
+
+	for (grid.y = centre.y - rad; grid.y <= centre.y + rad; grid.y++) {
+		for (grid.x = centre.x - rad; grid.x <= centre.x + rad; grid.x++) {
+			bool on_path = false;
+			int d;
+
+			if (loc_eq(grid, centre)) continue;
+			if (num_grids >= 255) break;
+			if (!square_in_bounds(cave, grid)) continue;
+			if ((flg & PROJECT_THRU) || square_ispassable(cave, grid)) {
+				if (!square_isprojectable(cave, grid)) {
+					bool can_see_one = false;
+
+					for (i = 0; i < 8; i++) {
+						if (los(cave, centre,
+								loc_sum(grid, ddgrid_ddd[i]))) {
+							can_see_one = true;
+							break;
+						}
+					}
+					if (!can_see_one) continue;
+				}
+			} else if (!square_isprojectable(cave, grid)) {
+				continue;
+			}
+			d = distance(centre, grid);
+			if (d > rad) continue;
+			for (i = 0; i < num_path_grids; i++) {
+				if (loc_eq(grid, path_grid[i])) on_path = true;
+			}
+			if (flg & PROJECT_ARC) {
+				int rotate = 90 - get_angle_to_grid[n1y][n1x];
+				int tmp = ABS(get_angle_to_grid[grid.y - start.y + 20]
+					[grid.x - start.x + 20] + rotate) % 180;
+
+				if ((ABS(90 - tmp) >= (degrees_of_arc + 6) / 4) && !on_path)
+					continue;
+			}
+			if (los(cave, centre, grid) || on_path) {
+				blast_grid[num_grids] = grid;
+				distance_to_grid[num_grids++] = d;
+			}
+		}
+	}
+
+	for (i = 0, k = 0; i <= rad; i++) {
+		for (j = k; j < num_grids; j++) {
+			if (distance_to_grid[j] == i) {
+				struct loc tmp = blast_grid[k];
+				int tmp_d = distance_to_grid[k];
+
+				blast_grid[k] = blast_grid[j];
+				distance_to_grid[k] = distance_to_grid[j];
+				blast_grid[j] = tmp;
+				distance_to_grid[j] = tmp_d;
+				k++;
+			}
+		}
+	}
+	return num_grids;
+}
+
+/* Pick a grid within range of the player, not always an empty one */
+static struct loc random_target(void)
+{
+	struct loc grid;
+
+	do {
+		grid = loc(player->grid.x + rand_range(-15, 15),
+			player->grid.y + rand_range(-15, 15));
+	} while (!square_in_bounds_fully(cave, grid));
+	return grid;
+}
+
+static int test_golden(void *state) {
+	int depths[] = { 1, 5, 15, 30, 50, 75, 98 };
+	struct loc want_grid[256];
+	int want_dist[256];
+	int i, j, n;
+
+	event_add_handler(EVENT_EXPLOSION, catch_explosion, NULL);
+	for (i = 0; i < (int)N_ELEMENTS(depths); i++) {
+		t_new_level(depths[i]);
+		for (j = 0; j < 120; j++) {
+			struct loc grid, finish = random_target();
+			int rad = randint1(one_in_(10) ? 20 : 6);
+			int flg = PROJECT_HIDE, degrees = 0;
+			bool jump = one_in_(4);
+
+			if (one_in_(20)) flg |= PROJECT_THRU;
+			if (!jump && one_in_(3)) {
+				flg |= PROJECT_ARC;
+				degrees = randint1(180);
+			}
+			if (jump) flg |= PROJECT_JUMP;
+			if (!cave_find(cave, &grid, square_isempty)) continue;
+			monster_swap(player->grid, grid);
+			if (!jump && loc_eq(finish, player->grid)) continue;
+
+			got_n = -1;
+			project(source_player(), rad, finish, 0, PROJ_MISSILE, flg,
+				degrees, 0, NULL);
+			n = reference_blast(jump ? finish : player->grid, finish, rad,
+				flg & ~PROJECT_JUMP, degrees, want_grid, want_dist);
+			eq(got_n, n);
+			require(!memcmp(got_grid, want_grid, n * sizeof(*want_grid)));
+			require(!memcmp(got_dist, want_dist, n * sizeof(*want_dist)));
+		}
+	}
+	event_remove_handler(EVENT_EXPLOSION, catch_explosion, NULL);
+	ok;
+}
+
+static int test_bench(void *state) {
+	int balls = 20000, i;
+	clock_t start;
+	double t;
+
+	bench_only();
+	Rand_state_init(42);
+	t_new_level(40);
+	start = clock();
+	for (i = 0; i < balls; i++) {
+		struct loc grid;
+
+		if (i % 100 == 0 && cave_find(cave, &grid, square_isempty))
+			monster_swap(player->grid, grid);
+
+		/* Breaths are wide arcs, and the rest mostly small balls */
+		if (i % 2) {
+			project(source_player(), 20, random_target(), 0, PROJ_MISSILE,
+				PROJECT_HIDE | PROJECT_ARC, 30 + i % 60, 0, NULL);
+		} else {
+			project(source_player(), 2 + i % 4, random_target(), 0,
+				PROJ_MISSILE, PROJECT_HIDE, 0, 0, NULL);
+		}
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %dx%d level: %.0f explosions per second\n    ",
+			cave->width, cave->height, (t > 0) ? balls / t : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "effects/blast";
+struct test tests[] = {
+	{ "golden", test_golden },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
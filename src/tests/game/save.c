@@ -0,0 +1,145 @@
+/* game/save */
+/* Check that a game with many persistent levels saves, loads and saves
+ * again to the same file, and time saving and loading it. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+
+#include <stdio.h>
+#include "cave.h"
+#include "init.h"
+#include "mon-make.h"
+#include "savefile.h"
+#include "player.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include "z-util.h"
+#include <time.h>
+
+static void reset_before_load(void) {
+	play_again = true;
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	chunk_list_max = 0;
+	init_angband();
+	play_again = false;
+}
+
+int setup_tests(void **state) {
+	int depth;
+
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	Rand_state_init(42);
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+
+	/* Visit enough levels, kept for later, to make a long-lived game */
+	player->opts.opt[OPT_birth_levels_persist] = true;
+	for (depth = 1; depth <= 25; depth++) {
+		t_new_level(depth);
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	file_delete("Test-save1");
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Read a whole file, returning its size, or -1 if it can't be read */
+static long read_whole(const char *path, char **contents)
+{
+	FILE *f = fopen(path, "rb");
+	long size;
+
+	*contents = NULL;
+	if (!f) return -1;
+	if (fseek(f, 0, SEEK_END) || (size = ftell(f)) < 0 ||
+			fseek(f, 0, SEEK_SET)) {
+		fclose(f);
+		return -1;
+	}
+	*contents = mem_alloc(size + 1);
+	if (fread(*contents, 1, size, f) != (size_t)size) size = -1;
+	fclose(f);
+	return size;
+}
+
+static int test_roundtrip(void *state) {
+	int n_chunks = chunk_list_max, i;
+	char (*names)[80] = mem_zalloc(n_chunks * sizeof(*names));
+	int *sizes = mem_zalloc(n_chunks * sizeof(*sizes));
+	int32_t exp = player->exp, au = player->au;
+
+	require(n_chunks >= 25);
+	for (i = 0; i < n_chunks; i++) {
+		my_strcpy(names[i], chunk_list[i]->name, sizeof(names[i]));
+		sizes[i] = chunk_list[i]->height * chunk_list[i]->width;
+	}
+	eq(savefile_save("Test-save1"), true);
+	reset_before_load();
+	eq(savefile_load("Test-save1", false), true);
+
+	eq(player->depth, 25);
+	eq(player->exp, exp);
+	eq(player->au, au);
+	eq(chunk_list_max, n_chunks);
+	for (i = 0; i < n_chunks; i++) {
+		require(streq(chunk_list[i]->name, names[i]));
+		eq(chunk_list[i]->height * chunk_list[i]->width, sizes[i]);
+	}
+	mem_free(sizes);
+	mem_free(names);
+	ok;
+}
+
+static int test_bench(void *state) {
+	int times = 20, i;
+	clock_t start;
+	double t_save, t_load;
+	char *contents;
+	long size;
+
+	bench_only();
+	start = clock();
+	for (i = 0; i < times; i++) {
+		eq(savefile_save("Test-save1"), true);
+	}
+	t_save = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	t_load = 0.0;
+	for (i = 0; i < times; i++) {
+		reset_before_load();
+		start = clock();
+		eq(savefile_load("Test-save1", false), true);
+		t_load += (double)(clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	size = read_whole("Test-save1", &contents);
+	mem_free(contents);
+	if (verbose) {
+		printf("\n    %d levels, %ld bytes: %.1fms to save, %.1fms to"
+			" load\n    ", chunk_list_max, size,
+			1e3 * t_save / times, 1e3 * t_load / times);
+	}
+	require(size > 0);
+	ok;
+}
+
+const char *suite_name = "game/save";
+struct test tests[] = {
+	{ "roundtrip", test_roundtrip },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,131 @@
+/* game/schedule */
+/* Check that the game loop counts the game turns a player turn takes, and
+ * time it with many monsters. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-calcs.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Go to a new level of the given depth, with only monsters that stay put */
+static void new_level(int depth, int n_monsters)
+{
+	struct monster_group_info info = { 0, 0 };
+	int i;
+
+	t_new_level(depth);
+	player->upkeep->generate_level = false;
+	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
+		if (cave_monster(cave, i)->race) delete_monster_idx(cave, i);
+	}
+
+	for (i = 0; n_monsters > 0; i++) {
+		struct monster_race *race = &r_info[i % z_info->r_max];
+		struct loc grid;
+
+		if (!race->name || !rf_has(race->flags, RF_NEVER_MOVE)) continue;
+		if (rf_has(race->flags, RF_UNIQUE) || race->freq_spell ||
+				race->freq_innate) continue;
+		if (!cave_find(cave, &grid, square_isempty)) break;
+		if (distance(grid, player->grid) < 3) continue;
+		if (place_new_monster(cave, grid, race, false, false, info,
+				ORIGIN_DROP)) {
+			n_monsters--;
+		}
+	}
+}
+
+/* Stay still for some player turns */
+static void hold(int turns)
+{
+	while (turns-- > 0) {
+		cmdq_push(CMD_HOLD);
+		run_game_loop();
+	}
+}
+
+static int test_loop(void *state) {
+	int32_t start;
+
+	Rand_state_init(11);
+	new_level(5, 40);
+	player->energy = z_info->move_energy;
+	hold(1);
+	start = turn;
+	hold(100);
+
+	/* Holding takes one normal speed player turn, ten game turns */
+	eq(player->state.speed, 110);
+	eq(turn - start, 1000);
+	eq(player->is_dead, false);
+	ok;
+}
+
+/* Time some player turns spent standing still, with a few or many monsters */
+static int test_bench(void *state) {
+	int counts[] = { 10, 150 };
+	int holds = 2000, i;
+
+	bench_only();
+	for (i = 0; i < (int)N_ELEMENTS(counts); i++) {
+		int32_t start_turn;
+		clock_t start;
+		double t;
+
+		Rand_state_init(42);
+		new_level(20, counts[i]);
+		player->energy = z_info->move_energy;
+		hold(1);
+		start_turn = turn;
+		start = clock();
+		hold(holds);
+		t = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (verbose) {
+			printf("\n    %d monsters: %.0f player turns, %.0f game"
+				" turns per second", cave_monster_count(cave),
+				(t > 0) ? holds / t : 0.0,
+				(t > 0) ? (turn - start_turn) / t : 0.0);
+		}
+		eq(player->is_dead, false);
+	}
+	if (verbose) printf("\n    ");
+	ok;
+}
+
+const char *suite_name = "game/schedule";
+struct test tests[] = {
+	{ "loop", test_loop },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,254 @@
+/* game/startup */
+/* Check that the game data read back from the cache of parsed data files is
+ * the same as that parsed from the text, that records made by another version
+ * or with a broken head are remade, and time starting up with and without
+ * the cache. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "buildid.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "monster.h"
+#include "obj-util.h"
+#include "player.h"
+#include "z-util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* The real user directory, put back once the tests are done */
+static char *user_dir;
+
+/* Empty the cache, so the next start has to parse all the text */
+static void clear_cache(void)
+{
+	char dir[1024], name[1024], path[1024];
+	ang_dir *d;
+
+	path_build(dir, sizeof(dir), ANGBAND_DIR_USER, "cache");
+	d = my_dopen(dir);
+	if (!d) return;
+	while (my_dread(d, name, sizeof(name))) {
+		path_build(path, sizeof(path), dir, name);
+		file_delete(path);
+	}
+	my_dclose(d);
+}
+
+int setup_tests(void **state) {
+	char dir[1024];
+
+	set_file_paths();
+	play_again = true;
+
+	/* Empty and fill a cache of our own, not the player's */
+	user_dir = ANGBAND_DIR_USER;
+#ifdef UNIX
+	my_strcpy(dir, "/tmp/angband-startup-XXXXXX", sizeof(dir));
+	if (!mkdtemp(dir)) return 1;
+#else
+	path_build(dir, sizeof(dir), user_dir, "startup-test");
+	if (!dir_create(dir)) return 1;
+#endif
+	ANGBAND_DIR_USER = string_make(dir);
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	char dir[1024];
+
+	clear_cache();
+	path_build(dir, sizeof(dir), ANGBAND_DIR_USER, "cache");
+	remove(dir);
+	remove(ANGBAND_DIR_USER);
+	string_free(ANGBAND_DIR_USER);
+	ANGBAND_DIR_USER = user_dir;
+	play_again = false;
+	return 0;
+}
+
+static uint32_t digest_str(uint32_t hash, const char *str)
+{
+	return hash * 33 + (str ? djb2_hash(str) : 0);
+}
+
+/* Sum up some of everything parsed */
+static uint32_t digest_data(void)
+{
+	uint32_t hash = 0;
+	struct vault *v;
+	struct player_race *race;
+	struct player_class *class;
+	int i;
+
+	hash = hash * 33 + z_info->k_max + (z_info->a_max << 16);
+	hash = hash * 33 + z_info->r_max + (z_info->e_max << 16);
+	hash = hash * 33 + z_info->trap_max + (z_info->profile_max << 16);
+	hash = hash * 33 + z_info->max_sight + (z_info->move_energy << 16);
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *r = &r_info[i];
+
+		hash = digest_str(hash, r->name);
+		hash = digest_str(hash, r->text);
+		hash = hash * 33 + r->level + (r->speed << 8) + (r->avg_hp << 16);
+		hash = hash * 33 + r->mexp + r->freq_spell + r->light;
+		hash = hash * 33 + djb2_hash((const char *)r->flags);
+		if (r->blow && r->blow[0].method) {
+			hash = digest_str(hash, r->blow[0].method->name);
+		}
+	}
+	for (i = 0; i < z_info->k_max; i++) {
+		struct object_kind *k = &k_info[i];
+
+		hash = digest_str(hash, k->name);
+		hash = digest_str(hash, k->text);
+		hash = hash * 33 + k->tval + (k->sval << 8) + (k->level << 16);
+		hash = hash * 33 + k->cost + k->weight;
+	}
+	for (i = 0; i < z_info->a_max; i++) {
+		hash = digest_str(hash, a_info[i].name);
+		hash = hash * 33 + a_info[i].tval + (a_info[i].sval << 8);
+	}
+	for (i = 0; i < z_info->e_max; i++) {
+		hash = digest_str(hash, e_info[i].name);
+	}
+	for (v = vaults; v; v = v->next) {
+		hash = digest_str(hash, v->name);
+		hash = digest_str(hash, v->text);
+		hash = digest_str(hash, v->typ);
+	}
+	for (race = races; race; race = race->next) {
+		hash = digest_str(hash, race->name);
+	}
+	for (class = classes; class; class = class->next) {
+		hash = digest_str(hash, class->name);
+	}
+	return hash;
+}
+
+static int test_cached(void *state) {
+	uint32_t parsed, cached;
+	char dir[1024], path[1024];
+
+	clear_cache();
+	init_angband();
+	parsed = digest_data();
+	cleanup_angband();
+
+	/* The monsters should have been left in the cache */
+	path_build(dir, sizeof(dir), ANGBAND_DIR_USER, "cache");
+	path_build(path, sizeof(path), dir, "monster.dat");
+	require(file_exists(path));
+
+	init_angband();
+	cached = digest_data();
+	cleanup_angband();
+	eq(cached, parsed);
+	ok;
+}
+
+/* Read the build hash from the head of a cached record */
+static uint32_t cached_build(const char *name)
+{
+	char dir[1024], path[1024], head[8];
+	uint32_t build = 0;
+	ang_file *f;
+
+	path_build(dir, sizeof(dir), ANGBAND_DIR_USER, "cache");
+	path_build(path, sizeof(path), dir, name);
+	f = file_open(path, MODE_READ, FTYPE_RAW);
+	if (f) {
+		if (file_read(f, head, sizeof(head)) == sizeof(head)) {
+			memcpy(&build, head + 4, sizeof(build));
+		}
+		file_close(f);
+	}
+	return build;
+}
+
+static int test_version(void *state) {
+	const char *version = buildver;
+	uint32_t ours, theirs;
+
+	init_angband();
+	cleanup_angband();
+	ours = cached_build("monster.dat");
+
+	/* Another version of the game shouldn't use our records */
+	buildver = "0.0.0-test";
+	init_angband();
+	cleanup_angband();
+	theirs = cached_build("monster.dat");
+	buildver = version;
+	require(ours != 0 && theirs != 0);
+	require(ours != theirs);
+	ok;
+}
+
+static int test_corrupt(void *state) {
+	uint32_t parsed, cached, huge = 0xFFFFFFF0;
+	char dir[1024], path[1024], head[28];
+	ang_file *f;
+
+	init_angband();
+	parsed = digest_data();
+	cleanup_angband();
+
+	/* Claim a record far bigger than the file; it should just be remade */
+	path_build(dir, sizeof(dir), ANGBAND_DIR_USER, "cache");
+	path_build(path, sizeof(path), dir, "monster.dat");
+	f = file_open(path, MODE_READ, FTYPE_RAW);
+	require(f);
+	eq(file_read(f, head, sizeof(head)), (int)sizeof(head));
+	file_close(f);
+	memcpy(head + 20, &huge, sizeof(huge));
+	f = file_open(path, MODE_WRITE, FTYPE_RAW);
+	require(f);
+	require(file_write(f, head, sizeof(head)));
+	file_close(f);
+
+	init_angband();
+	cached = digest_data();
+	cleanup_angband();
+	eq(cached, parsed);
+	ok;
+}
+
+static int test_bench(void *state) {
+	int times = 20, i;
+	clock_t start;
+	double t_cold = 0.0, t_warm;
+
+	bench_only();
+	for (i = 0; i < times; i++) {
+		clear_cache();
+		start = clock();
+		init_angband();
+		t_cold += (double)(clock() - start) / CLOCKS_PER_SEC;
+		cleanup_angband();
+	}
+
+	start = clock();
+	for (i = 0; i < times; i++) {
+		init_angband();
+		cleanup_angband();
+	}
+	t_warm = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %.1fms to start from the text, %.1fms from the"
+			" cache\n    ", 1e3 * t_cold / times,
+			1e3 * t_warm / times);
+	}
+	ok;
+}
+
+const char *suite_name = "game/startup";
+struct test tests[] = {
+	{ "cached", test_cached },
+	{ "version", test_version },
+	{ "corrupt", test_corrupt },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
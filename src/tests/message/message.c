@@ -254,6 +254,60 @@ static int test_fill(void *state) {
 	ok;
 }
 
+/* Make up the text of the ith message, of between 1 and 1000 characters */
+static void long_text(char *buf, size_t size, int i)
+{
+	size_t len = strnfmt(buf, size, "%d ", i);
+	size_t want = 1 + ((unsigned int)i * 7919u * 7919u) % 1000;
+
+	while (len < want && len < size - 1) {
+		buf[len] = 'a' + (i + len) % 26;
+		++len;
+	}
+	buf[len] = '\0';
+}
+
+static int test_long(void *state) {
+	char buf[1024];
+	char *huge;
+	int i;
+	uint16_t n, j;
+
+	messages_free();
+	messages_init();
+
+	/*
+	 * Add messages long enough to wrap around the space for the text a few
+	 * times, checking that those kept are intact and that enough are.
+	 */
+	for (i = 0; i < 30000; ++i) {
+		long_text(buf, sizeof(buf), i);
+		message_add(buf, MSG_GENERIC);
+		n = messages_num();
+		require(n > 200 || n == i + 1);
+		if (i % 97 == 0) {
+			for (j = 0; j < n; ++j) {
+				long_text(buf, sizeof(buf), i - (int)j);
+				require(streq(message_str(j), buf));
+			}
+		}
+	}
+
+	/* Something too long for the text space only keeps what fits */
+	huge = mem_alloc(1 << 20);
+	memset(huge, 'x', (1 << 20) - 1);
+	huge[(1 << 20) - 1] = '\0';
+	message_add(huge, MSG_GENERIC);
+	mem_free(huge);
+	eq(messages_num(), 1);
+	require(strlen(message_str(0)) > 0);
+	message_add("msg", MSG_GENERIC);
+	eq(messages_num(), 1);
+	require(streq(message_str(0), "msg"));
+
+	ok;
+}
+
 static int test_many_repeat(void *state)
 {
 	int i = 0;
@@ -662,6 +716,7 @@ struct test tests[] = {
 	{ "empty", test_empty },
 	{ "add", test_add },
 	{ "fill", test_fill },
+	{ "long", test_long },
 	{ "many_repeat", test_many_repeat },
 	{ "color", test_color },
 	{ "format", test_msg },
@@ -0,0 +1,226 @@
+/* monster/alloc */
+/* Check that get_mon_num() picks just the races it did when it worked out
+ * the probabilities and walked the allocation table on every call, and time
+ * how many races it can pick per second. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-make.h"
+#include "monster.h"
+#include "z-rand.h"
+#include <time.h>
+
+/* A copy of the allocation table, made the way init_race_allocs() makes it */
+struct ref_entry {
+	int index;
+	int level;
+	int prob2;
+	int prob3;
+};
+
+static struct ref_entry *ref_table;
+static int ref_size;
+
+int setup_tests(void **state) {
+	int lev, i;
+
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+	ref_table = mem_zalloc(z_info->r_max * sizeof(*ref_table));
+	for (lev = 0; lev < z_info->max_depth; lev++) {
+		for (i = 1; i < z_info->r_max - 1; i++) {
+			struct monster_race *race = &r_info[i];
+
+			if (!race->rarity || race->level != lev) continue;
+			ref_table[ref_size].index = i;
+			ref_table[ref_size].level = lev;
+			ref_table[ref_size].prob2 = (100 / race->rarity) *
+				(1 + lev / 10);
+			ref_size++;
+		}
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	mem_free(ref_table);
+	cleanup_angband();
+	return 0;
+}
+
+static void ref_prep(bool (*hook)(struct monster_race *race))
+{
+	int i;
+
+	for (i = 0; i < ref_size; i++) {
+		struct monster_race *race = &r_info[ref_table[i].index];
+
+		ref_table[i].prob2 = (!hook || hook(race)) ?
+			(100 / race->rarity) * (1 + ref_table[i].level / 10) : 0;
+	}
+}
+
+static struct monster_race *ref_pick(long total)
+{
+	long value = randint0(total);
+	int i;
+
+	for (i = 0; i < ref_size; i++) {
+		if (value < ref_table[i].prob3) break;
+		value -= ref_table[i].prob3;
+	}
+	return &r_info[ref_table[i].index];
+}
+
+/* How get_mon_num() used to choose a race */
+static struct monster_race *ref_get_mon_num(int generated_level,
+		int current_level)
+{
+	time_t cur_time = time(NULL);
+	struct tm *date = localtime(&cur_time);
+	struct monster_race *race, *old;
+	long total = 0;
+	int i, p;
+
+	if (generated_level > 0 && one_in_(z_info->ood_monster_chance))
+		generated_level += MIN(generated_level / 4 + 2,
+			z_info->ood_monster_amount);
+	for (i = 0; i < ref_size; i++) {
+		if (ref_table[i].level > generated_level) break;
+		ref_table[i].prob3 = 0;
+		if (generated_level > 0 && ref_table[i].level <= 0) continue;
+		race = &r_info[ref_table[i].index];
+		if (rf_has(race->flags, RF_SEASONAL) && !(date->tm_mon == 11 &&
+				date->tm_mday >= 24 && date->tm_mday <= 26))
+			continue;
+		if (rf_has(race->flags, RF_UNIQUE) &&
+				race->cur_num >= race->max_num)
+			continue;
+		if (rf_has(race->flags, RF_FORCE_DEPTH) &&
+				race->level > current_level)
+			continue;
+		ref_table[i].prob3 = ref_table[i].prob2;
+		total += ref_table[i].prob3;
+	}
+	if (total <= 0) return NULL;
+
+	race = ref_pick(total);
+	p = randint0(100);
+	if (p < 60) {
+		old = race;
+		race = ref_pick(total);
+		if (race->level < old->level) race = old;
+	}
+	if (p < 10) {
+		old = race;
+		race = ref_pick(total);
+		if (race->level < old->level) race = old;
+	}
+	return race;
+}
+
+static bool hook_animal(struct monster_race *race)
+{
+	return rf_has(race->flags, RF_ANIMAL);
+}
+
+static bool hook_dragon(struct monster_race *race)
+{
+	return rf_has(race->flags, RF_DRAGON);
+}
+
+static bool hook_unique(struct monster_race *race)
+{
+	return rf_has(race->flags, RF_UNIQUE);
+}
+
+/* Pick with both from the same seed; they should agree, and leave the
+ * random numbers in the same state */
+static bool same_pick(uint32_t seed, int generated_level, int current_level)
+{
+	struct monster_race *race, *ref;
+	int next;
+
+	Rand_state_init(seed);
+	race = get_mon_num(generated_level, current_level);
+	next = randint0(0x10000000);
+	Rand_state_init(seed);
+	ref = ref_get_mon_num(generated_level, current_level);
+	return race == ref && next == randint0(0x10000000);
+}
+
+static int test_same(void *state) {
+	bool (*hooks[])(struct monster_race *race) =
+		{ NULL, hook_animal, hook_unique, NULL, hook_dragon };
+	int i, j;
+
+	for (i = 0; i < 5000; i++) {
+		/* Now and then, change the restriction or the uniques about */
+		if (i % 500 == 0) {
+			get_mon_num_prep(hooks[(i / 500) % N_ELEMENTS(hooks)]);
+			ref_prep(hooks[(i / 500) % N_ELEMENTS(hooks)]);
+		}
+		if (i % 50 == 0) {
+			for (j = 0; j < ref_size; j++) {
+				struct monster_race *race =
+					&r_info[ref_table[j].index];
+
+				if (rf_has(race->flags, RF_UNIQUE)) {
+					race->cur_num = one_in_(3) ? 1 : 0;
+					race->max_num = 1;
+				}
+			}
+		}
+		Rand_state_init(i);
+		j = randint0(z_info->max_depth + 20);
+		require(same_pick(i + 1000, j, one_in_(2) ? j : randint0(j + 1)));
+	}
+
+	/* No monsters at all, or none at a level */
+	require(same_pick(1, -1, 0));
+	get_mon_num_prep(hook_dragon);
+	ref_prep(hook_dragon);
+	require(same_pick(2, 0, 0));
+	get_mon_num_prep(NULL);
+	ref_prep(NULL);
+	for (j = 0; j < ref_size; j++) {
+		r_info[ref_table[j].index].cur_num = 0;
+	}
+	ok;
+}
+
+static int test_bench(void *state) {
+	int picks = 200000, i;
+	clock_t start;
+	double t_ref, t;
+
+	bench_only();
+	Rand_state_init(42);
+	start = clock();
+	for (i = 0; i < picks; i++) {
+		ref_get_mon_num(1 + i % 60, 30);
+	}
+	t_ref = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < picks; i++) {
+		get_mon_num(1 + i % 60, 30);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %.0f picks per second (%.0f walking the table)\n    ",
+			(t > 0) ? picks / t : 0.0, (t_ref > 0) ? picks / t_ref : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "monster/alloc";
+struct test tests[] = {
+	{ "same", test_same },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,191 @@
+/* monster/list */
+/* Check that the monster list counts each race once per section, using the
+ * view flags to pick the section, and time how many lists can be collected
+ * per second on a crowded level. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-list.h"
+#include "mon-make.h"
+#include "mon-predicate.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-util.h"
+#include "z-rand.h"
+#include <time.h>
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+#ifdef UNIX
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/* Go to a new level of the given depth, adding monsters of many races */
+static void new_level(int depth, int n_monsters)
+{
+	struct monster_group_info info = { 0, 0 };
+	int i;
+
+	t_new_level(depth);
+	player->upkeep->generate_level = false;
+
+	for (i = 0; i < 20 * n_monsters && n_monsters > 0; i++) {
+		struct monster_race *race = &r_info[randint1(z_info->r_max - 2)];
+		struct loc grid;
+
+		if (!race->name || rf_has(race->flags, RF_UNIQUE)) continue;
+		if (!cave_find(cave, &grid, square_isempty)) break;
+		if (place_new_monster(cave, grid, race, false, false, info,
+				ORIGIN_DROP)) {
+			n_monsters--;
+		}
+	}
+}
+
+/* Make each monster seen, in view, asleep or not at random */
+static void shuffle_flags(void)
+{
+	int i;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (!mon->race) continue;
+		if (one_in_(4)) {
+			mflag_off(mon->mflag, MFLAG_VISIBLE);
+		} else {
+			mflag_on(mon->mflag, MFLAG_VISIBLE);
+		}
+		if (one_in_(2)) {
+			mflag_off(mon->mflag, MFLAG_VIEW);
+		} else {
+			mflag_on(mon->mflag, MFLAG_VIEW);
+		}
+		mon->m_timed[MON_TMD_SLEEP] = one_in_(3) ? 10 : 0;
+	}
+}
+
+/* Check a collected list against the monsters */
+static bool list_matches(monster_list_t *list)
+{
+	int n = 0, totals[MONSTER_LIST_SECTION_MAX] = { 0 };
+	int e, i, s;
+
+	for (e = 0; e < list->distinct_entries; e++) {
+		monster_list_entry_t *entry = &list->entries[e];
+		int count[MONSTER_LIST_SECTION_MAX] = { 0 };
+		int asleep[MONSTER_LIST_SECTION_MAX] = { 0 };
+		struct loc last[MONSTER_LIST_SECTION_MAX];
+
+		if (!entry->race) return false;
+		if (list->race_entry[entry->race->ridx] != e + 1) return false;
+
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			struct monster *mon = cave_monster(cave, i);
+
+			if (mon->race != entry->race) continue;
+			if (!monster_is_visible(mon)
+					|| monster_is_camouflaged(mon)) continue;
+			s = monster_is_in_view(mon) ?
+				MONSTER_LIST_SECTION_LOS : MONSTER_LIST_SECTION_ESP;
+			count[s]++;
+			if (mon->m_timed[MON_TMD_SLEEP]) asleep[s]++;
+			last[s] = mon->grid;
+		}
+		for (s = 0; s < MONSTER_LIST_SECTION_MAX; s++) {
+			if (entry->count[s] != count[s]) return false;
+			if (entry->asleep[s] != asleep[s]) return false;
+			if (count[s] == 1 && (entry->dx[s] != last[s].x - player->grid.x
+					|| entry->dy[s] != last[s].y - player->grid.y)) {
+				return false;
+			}
+			totals[s] += count[s];
+		}
+		n += count[MONSTER_LIST_SECTION_LOS] + count[MONSTER_LIST_SECTION_ESP];
+	}
+
+	/* Every seen monster is in some entry */
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (mon->race && monster_is_visible(mon)
+				&& !monster_is_camouflaged(mon)) n--;
+	}
+	return n == 0
+		&& list->total_monsters[MONSTER_LIST_SECTION_LOS]
+			== totals[MONSTER_LIST_SECTION_LOS]
+		&& list->total_monsters[MONSTER_LIST_SECTION_ESP]
+			== totals[MONSTER_LIST_SECTION_ESP];
+}
+
+static int test_collect(void *state) {
+	monster_list_t *list;
+	int i;
+
+	Rand_state_init(11);
+	new_level(30, 150);
+	list = monster_list_new();
+	for (i = 0; i < 20; i++) {
+		shuffle_flags();
+		monster_list_reset(list);
+		monster_list_collect(list);
+		require(list_matches(list));
+
+		/* Sorting moves the entries, so the races must follow them */
+		monster_list_sort(list, monster_list_standard_compare);
+		require(list_matches(list));
+	}
+	monster_list_free(list);
+	ok;
+}
+
+static int test_bench(void *state) {
+	monster_list_t *list;
+	int lists = 20000, i;
+	clock_t start;
+	double t;
+
+	bench_only();
+	Rand_state_init(12);
+	new_level(40, 300);
+	shuffle_flags();
+	list = monster_list_new();
+	start = clock();
+	for (i = 0; i < lists; i++) {
+		monster_list_reset(list);
+		monster_list_collect(list);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %d monsters, %d races: %.0f lists per second\n    ",
+			cave_monster_count(cave), list->distinct_entries,
+			(t > 0) ? lists / t : 0.0);
+	}
+	monster_list_free(list);
+	ok;
+}
+
+const char *suite_name = "monster/list";
+struct test tests[] = {
+	{ "collect", test_collect },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -1 +1 @@
-TESTPROGS += monster/attack monster/desc monster/monster
+TESTPROGS += monster/alloc monster/attack monster/desc monster/list monster/monster
@@ -4,4 +4,5 @@ TESTPROGS += \
 	object/info \
 	object/pile \
 	object/slays \
+	object/tval \
 	object/util
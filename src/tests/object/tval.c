@@ -0,0 +1,137 @@
+/* object/tval */
+/* Check that get_obj_num() picks just the kinds of a tval it did when it
+ * walked all the kinds, and time how many it can pick per second. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "init.h"
+#include "obj-make.h"
+#include "obj-tval.h"
+#include "object.h"
+#include "z-rand.h"
+#include <time.h>
+
+/* The total chance of the kinds of each tval at each level, good or not */
+static uint32_t *ref_totals;
+
+int setup_tests(void **state) {
+	int lev, item;
+
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+	ref_totals = mem_zalloc((z_info->max_obj_depth + 1) * TV_MAX * 2 *
+		sizeof(*ref_totals));
+	for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+		for (item = 0; item < z_info->k_max; item++) {
+			const struct object_kind *kind = &k_info[item];
+			uint32_t *totals = ref_totals + (lev * TV_MAX + kind->tval) * 2;
+
+			if (lev < kind->alloc_min || lev > kind->alloc_max) continue;
+			totals[0] += kind->alloc_prob;
+			if (kind_is_good(kind)) totals[1] += kind->alloc_prob;
+		}
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	mem_free(ref_totals);
+	cleanup_angband();
+	return 0;
+}
+
+/* How get_obj_num() used to choose a kind of a given tval */
+static struct object_kind *ref_get_obj_num(int level, bool good, int tval)
+{
+	uint32_t total, value;
+	int item;
+
+	if ((level > 0) && one_in_(z_info->great_obj))
+		level = 1 + (level * z_info->max_obj_depth /
+			randint1(z_info->max_obj_depth));
+	level = MIN(level, z_info->max_obj_depth);
+	level = MAX(level, 0);
+
+	total = ref_totals[(level * TV_MAX + tval) * 2 + (good ? 1 : 0)];
+	if (!total) return NULL;
+	value = randint0(total);
+	for (item = 0; item < z_info->k_max; item++) {
+		const struct object_kind *kind = &k_info[item];
+
+		if (kind->tval == tval) {
+			uint32_t prob = (level < kind->alloc_min ||
+				level > kind->alloc_max ||
+				(good && !kind_is_good(kind))) ? 0 : kind->alloc_prob;
+
+			if (value < prob) break;
+			value -= prob;
+		}
+	}
+	return &k_info[item];
+}
+
+static int test_same(void *state) {
+	int i;
+
+	for (i = 0; i < 20000; i++) {
+		struct object_kind *kind, *ref;
+		int level, tval, next;
+		bool good;
+
+		Rand_state_init(i);
+		level = randint0(z_info->max_obj_depth + 10);
+		tval = randint1(TV_MAX - 1);
+		good = one_in_(3);
+
+		Rand_state_init(i + 100000);
+		kind = get_obj_num(level, good, tval);
+		next = randint0(0x10000000);
+		Rand_state_init(i + 100000);
+		ref = ref_get_obj_num(level, good, tval);
+		ptreq(kind, ref);
+		eq(next, randint0(0x10000000));
+		if (kind) eq(kind->tval, tval);
+	}
+	ok;
+}
+
+static int test_bench(void *state) {
+	int tvals[] = { TV_SWORD, TV_POTION, TV_SCROLL, TV_RING, TV_FOOD };
+	int draws = 200000, i, j;
+
+	bench_only();
+	for (j = 0; j < (int)N_ELEMENTS(tvals); j++) {
+		clock_t start;
+		double t_ref, t;
+
+		Rand_state_init(42);
+		start = clock();
+		for (i = 0; i < draws; i++) {
+			ref_get_obj_num(i % 50, false, tvals[j]);
+		}
+		t_ref = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (i = 0; i < draws; i++) {
+			get_obj_num(i % 50, false, tvals[j]);
+		}
+		t = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (verbose) {
+			printf("\n    %s: %.0f draws per second (%.0f walking all the"
+				" kinds)", tval_find_name(tvals[j]),
+				(t > 0) ? draws / t : 0.0,
+				(t_ref > 0) ? draws / t_ref : 0.0);
+		}
+	}
+	if (verbose) printf("\n    ");
+	ok;
+}
+
+const char *suite_name = "object/tval";
+struct test tests[] = {
+	{ "same", test_same },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -561,6 +561,144 @@ static int test_char2(void *state) {
 	ok;
 }
 
+static enum parser_error helper_record(struct parser *p) {
+	char *buf = parser_priv(p);
+	struct random r = parser_getrand(p, "r");
+	struct parser_state st;
+
+	parser_getstate(p, &st);
+	my_strcat(buf, format("%u:%d:%u:%s:%d:%d:%d:%d:%lc", st.line,
+		parser_getint(p, "i"), parser_getuint(p, "u"),
+		parser_getsym(p, "s"), r.base, r.dice, r.sides, r.m_bonus,
+		(wint_t)parser_getchar(p, "c")), 1024);
+	if (parser_hasval(p, "o")) {
+		my_strcat(buf, format(":%d", parser_getint(p, "o")), 1024);
+	}
+	if (parser_hasval(p, "t")) {
+		my_strcat(buf, format(":%s", parser_getstr(p, "t")), 1024);
+	}
+	my_strcat(buf, "|", 1024);
+	return PARSE_ERROR_NONE;
+}
+
+static struct parser *record_parser(char *buf) {
+	struct parser *p = parser_new();
+
+	parser_reg(p, "other sym a", ignored);
+	parser_reg(p, "rec int i uint u sym s rand r char c ?int o ?str t",
+		helper_record);
+	parser_setpriv(p, buf);
+	buf[0] = '\0';
+	return p;
+}
+
+static int test_record0(void *state) {
+	const char *lines[] = {
+		"# a comment",
+		"rec:-3:7:foo:2d6M3:x",
+		"",
+		"rec:1:0:bar:-12:y:5",
+		"other:ignored",
+		"rec:0:3000000000:baz:d4:z:-1:text: with colons",
+	};
+	char parsed[1024], replayed[1024];
+	struct parser *p = record_parser(parsed);
+	struct parser *q = record_parser(replayed);
+	const uint8_t *record, *pos;
+	size_t len, i;
+
+	parser_record(p, true);
+	for (i = 0; i < N_ELEMENTS(lines); i++) {
+		eq(parser_parse(p, lines[i]), PARSE_ERROR_NONE);
+	}
+	record = parser_get_record(p, &len);
+	require(len > 0);
+	eq(parser_signature(p), parser_signature(q));
+
+	/* Replaying runs the same hooks with the same values */
+	pos = record;
+	while (pos < record + len) {
+		eq(parser_replay(q, &pos, record + len), PARSE_ERROR_NONE);
+	}
+	require(streq(parsed, replayed));
+	require(strstr(parsed, "6:0:3000000000:baz:") != NULL);
+
+	/* A short record is an error, and doesn't go past its end */
+	pos = record;
+	eq(parser_replay(q, &pos, record + 5), PARSE_ERROR_GENERIC);
+	ptreq(pos, record + 5);
+
+	parser_record(p, false);
+	parser_destroy(q);
+	parser_destroy(p);
+	ok;
+}
+
+static int test_record1(void *state) {
+	char buf[1024];
+	struct parser *p = record_parser(buf);
+	struct parser *q = record_parser(buf);
+	uint32_t sig = parser_signature(p);
+
+	/* Parsers with different hooks have different signatures */
+	parser_reg(q, "more int a", ignored);
+	require(parser_signature(q) != sig);
+	parser_destroy(q);
+	q = parser_new();
+	parser_reg(q, "other sym a", ignored);
+	parser_reg(q, "rec int i uint u sym s rand r char c ?int o ?sym t",
+		helper_record);
+	require(parser_signature(q) != sig);
+	parser_destroy(q);
+	parser_destroy(p);
+	ok;
+}
+
+static enum parser_error helper_hooks(struct parser *p) {
+	int *seen = parser_priv(p);
+	*seen = parser_getint(p, "n");
+	return PARSE_ERROR_NONE;
+}
+
+static enum parser_error helper_hooks_new(struct parser *p) {
+	int *seen = parser_priv(p);
+	*seen = -parser_getint(p, "n");
+	return PARSE_ERROR_NONE;
+}
+
+static int test_hooks(void *state) {
+	struct parser *p = parser_new();
+	char *line = mem_alloc(5000);
+	int i, seen;
+
+	/* Plenty of directives, each found again among the others */
+	parser_setpriv(p, &seen);
+	for (i = 0; i < 200; i++) {
+		eq(parser_reg(p, format("dir%d int n", i), helper_hooks), 0);
+	}
+	for (i = 0; i < 200; i++) {
+		eq(parser_parse(p, format("dir%d:%d", i, i)), PARSE_ERROR_NONE);
+		eq(seen, i);
+	}
+	eq(parser_parse(p, "dir200:1"), PARSE_ERROR_UNDEFINED_DIRECTIVE);
+
+	/* The newest hook for a directive is the one used */
+	eq(parser_reg(p, "dir7 int n", helper_hooks_new), 0);
+	eq(parser_parse(p, "dir7:3"), PARSE_ERROR_NONE);
+	eq(seen, -3);
+
+	/* Long lines are fine */
+	eq(parser_reg(p, "long int n sym s ?str t", ignored), 0);
+	my_strcpy(line, "long:12:", 5000);
+	for (i = strlen(line); i < 4000; i++) line[i] = 'a' + i % 26;
+	line[i] = '\0';
+	eq(parser_parse(p, line), PARSE_ERROR_NONE);
+
+	mem_free(line);
+	parser_destroy(p);
+	ok;
+}
+
 const char *suite_name = "parse/parser";
 struct test tests[] = {
 	{ "priv", test_priv },
@@ -606,5 +744,9 @@ struct test tests[] = {
 
 	{ "baddir", test_baddir },
 
+	{ "record0", test_record0 },
+	{ "record1", test_record1 },
+	{ "hooks", test_hooks },
+
 	{ NULL, NULL }
 };
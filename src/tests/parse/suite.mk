@@ -32,6 +32,7 @@ TESTPROGS += parse/a-info \
 	parse/realm \
 	parse/shape \
 	parse/slay \
+	parse/throughput \
 	parse/ui_knowledge \
 	parse/v-info \
 	parse/world \
@@ -0,0 +1,179 @@
+/* parse/throughput */
+/* Check that a bare parser takes every line of lib/gamedata and, with -b,
+ * time parsing them both that way and as the game does it when starting up
+ * without its cache of parsed files. */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "datafile.h"
+#include "game-world.h"
+#include "init.h"
+#include "parser.h"
+#include "z-util.h"
+#include <time.h>
+
+/* The lines of all the gamedata files, one after the other */
+static char **lines;
+static int n_lines;
+static size_t n_bytes;
+
+static void add_line(const char *buf, int *max)
+{
+	if (n_lines == *max) {
+		*max = *max ? 2 * *max : 1024;
+		lines = mem_realloc(lines, *max * sizeof(*lines));
+	}
+	lines[n_lines++] = string_make(buf);
+	n_bytes += strlen(buf) + 1;
+}
+
+int setup_tests(void **state) {
+	char name[1024], path[1024], buf[1024];
+	ang_dir *d;
+	int max = 0;
+
+	set_file_paths();
+	play_again = true;
+
+	d = my_dopen(ANGBAND_DIR_GAMEDATA);
+	if (!d) return 1;
+	while (my_dread(d, name, sizeof(name))) {
+		ang_file *fh;
+
+		if (!suffix(name, ".txt")) continue;
+		path_build(path, sizeof(path), ANGBAND_DIR_GAMEDATA, name);
+		fh = file_open(path, MODE_READ, FTYPE_TEXT);
+		if (!fh) continue;
+		while (file_getl(fh, buf, sizeof(buf))) {
+			add_line(buf, &max);
+		}
+		file_close(fh);
+	}
+	my_dclose(d);
+	return n_lines ? 0 : 1;
+}
+
+int teardown_tests(void *state) {
+	int i;
+
+	for (i = 0; i < n_lines; i++) {
+		string_free(lines[i]);
+	}
+	mem_free(lines);
+	play_again = false;
+	return 0;
+}
+
+struct line_count {
+	int lines;
+	int fields;
+};
+
+/* Fetch all the fields, as a real handler would */
+static enum parser_error count_line(struct parser *p) {
+	struct line_count *count = parser_priv(p);
+	const char *names[] = { "a", "b", "c" };
+	size_t i;
+
+	count->lines++;
+	for (i = 0; i < N_ELEMENTS(names); i++) {
+		if (parser_hasval(p, names[i]) && parser_getsym(p, names[i])) {
+			count->fields++;
+		}
+	}
+	if (parser_hasval(p, "rest") && parser_getstr(p, "rest")) {
+		count->fields++;
+	}
+	return PARSE_ERROR_NONE;
+}
+
+/* A parser with a hook taking anything for each directive in the files */
+static struct parser *counting_parser(struct line_count *count)
+{
+	struct parser *p = parser_new();
+	int i;
+
+	parser_setpriv(p, count);
+	for (i = 0; i < n_lines; i++) {
+		const char *s = lines[i];
+		char dir[80];
+		size_t len;
+
+		while (isspace((unsigned char)*s)) s++;
+		len = strcspn(s, ":");
+		if (!*s || *s == '#' || len >= sizeof(dir)) continue;
+		memcpy(dir, s, len);
+		dir[len] = '\0';
+		if (parser_parse(p, format("%s:", dir)) ==
+				PARSE_ERROR_UNDEFINED_DIRECTIVE) {
+			parser_reg(p, format("%s ?sym a ?sym b ?sym c ?str rest",
+				dir), count_line);
+		}
+	}
+	count->lines = 0;
+	count->fields = 0;
+	return p;
+}
+
+static int test_lines(void *state) {
+	struct line_count count = { 0, 0 };
+	struct parser *p = counting_parser(&count);
+	int times = bench ? 20 : 1, parsed = 0, i, j;
+	clock_t start;
+	double t;
+
+	start = clock();
+	for (j = 0; j < times; j++) {
+		for (i = 0; i < n_lines; i++) {
+			eq(parser_parse(p, lines[i]), PARSE_ERROR_NONE);
+		}
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (verbose) {
+		printf("\n    %d lines: %.0f lines, %.1fMB per second\n    ",
+			n_lines, (t > 0) ? times * n_lines / t : 0.0,
+			(t > 0) ? times * n_bytes / t / 1e6 : 0.0);
+	}
+
+	/* Every line bar the blanks and comments gets to the handler */
+	for (i = 0; i < n_lines; i++) {
+		const char *s = lines[i];
+
+		while (isspace((unsigned char)*s)) s++;
+		if (*s && *s != '#') parsed++;
+	}
+	eq(count.lines, times * parsed);
+	require(count.fields > count.lines);
+	parser_destroy(p);
+	ok;
+}
+
+static int test_gamedata(void *state) {
+	int times = 10, i;
+	clock_t start;
+	double t;
+
+	bench_only();
+	use_parse_cache = false;
+	start = clock();
+	for (i = 0; i < times; i++) {
+		init_angband();
+		cleanup_angband();
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	use_parse_cache = true;
+	if (verbose) {
+		printf("\n    %.1fms to start from the text: %.0f lines,"
+			" %.1fMB per second\n    ", 1e3 * t / times,
+			(t > 0) ? times * n_lines / t : 0.0,
+			(t > 0) ? times * n_bytes / t / 1e6 : 0.0);
+	}
+	ok;
+}
+
+const char *suite_name = "parse/throughput";
+struct test tests[] = {
+	{ "lines", test_lines },
+	{ "gamedata", test_gamedata },
+	{ NULL, NULL }
+};
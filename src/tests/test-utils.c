@@ -9,9 +9,12 @@
 #include "h-basic.h"
 #include "cave.h"
 #include "config.h"
+#include "game-world.h"
+#include "generate.h"
 #include "init.h"
 #include "mon-make.h"
 #include "mon-util.h"
+#include "player-util.h"
 #include "test-utils.h"
 #include "unit-test.h"
 #include "z-util.h"
@@ -116,3 +119,9 @@ struct monster *t_add_monster(struct chunk *c, struct loc g, const char *race) {
 	assert(m);
 	return m;
 }
+
+void t_new_level(int depth) {
+	dungeon_change_level(player, depth);
+	prepare_next_level(player);
+	on_new_level();
+}
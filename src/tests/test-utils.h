@@ -23,4 +23,8 @@ struct chunk *t_build_arena(int height, int width);
  * return it. This function cannot return NULL. */
 struct monster *t_add_monster(struct chunk *c, struct loc g, const char *race);
 
+/* Take the player to a newly generated level of the given depth, as going
+ * down a staircase would. */
+void t_new_level(int depth);
+
 #endif /* TEST_UTIL_H */
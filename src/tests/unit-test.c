@@ -11,6 +11,7 @@
 
 int verbose = 0;
 int forcepath = 0;
+int bench = 0;
 
 int main(int argc, char *argv[]) {
 	void *state;
@@ -26,6 +27,10 @@ int main(int argc, char *argv[]) {
 	if (s && s[0]) {
 		forcepath = 1;
 	}
+	s = getenv("BENCH");
+	if (s && s[0]) {
+		bench = 1;
+	}
 	for (i = 1; i < argc; ++i) {
 		if (argv[i][0] == '-') {
 			if (strchr(argv[i] + 1, 'v')) {
@@ -34,6 +39,9 @@ int main(int argc, char *argv[]) {
 			if (strchr(argv[i] + 1, 'f')) {
 				forcepath = 1;
 			}
+			if (strchr(argv[i] + 1, 'b')) {
+				bench = 1;
+			}
 		}
 	}
 
@@ -48,10 +56,14 @@ int main(int argc, char *argv[]) {
 	}
 
 	for (i = 0; tests[i].name; i++) {
+		int result;
+
 		if (verbose) printf("  %-16s  ", tests[i].name);
 		fflush(stdout);
-		if (tests[i].func(state) == 0) passed++;
-		total++;
+		result = tests[i].func(state);
+		if (result == 0) passed++;
+		/* Skipped tests don't count */
+		if (result >= 0) total++;
 		fflush(stdout);
 	}
 
@@ -72,3 +84,7 @@ int showfail(void) {
 	if (verbose) printf("\033[01;31mFailed\033[00m\n");
 	return 1;
 }
+int showskip(void) {
+	if (verbose) printf("\033[01;33mSkipped\033[00m\n");
+	return -1;
+}
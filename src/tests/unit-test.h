@@ -10,9 +10,11 @@
 
 extern int verbose;
 extern int forcepath;
+extern int bench;
 
 extern int showpass(void);
 extern int showfail(void);
+extern int showskip(void);
 
 /* Forward declaration for string provided by the test case but expected by
  * unit-test.c and the macros declared here.
@@ -35,6 +37,14 @@ extern int teardown_tests(void *data);
 
 #define ok return showpass();
 
+/* Timing tests start with this, so that they only run when asked for with
+ * -b or by setting BENCH in the environment.
+ */
+#define bench_only() \
+	do { \
+		if (!bench) return showskip(); \
+	} while (0)
+
 #define eq(x,y) \
 	if ((x) != (y)) { \
 		if (verbose) { \
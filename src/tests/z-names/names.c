@@ -0,0 +1,188 @@
+/* z-names/names.c */
+/* Check that names found through the index are those a walk of the list
+ * with my_stricmp() and my_stristr() finds, and time both. */
+
+#include "unit-test.h"
+#include "z-names.h"
+#include "z-rand.h"
+#include "z-util.h"
+#include "z-virt.h"
+#include <time.h>
+
+#define N_NAMES 1000
+
+static char *name_store[N_NAMES];
+static const char *names[N_NAMES];
+
+/* Make a name from a small alphabet, so that parts and cases repeat */
+static char *random_name(void)
+{
+	const char *letters = "aAbBcC dDeE'-\xc3\xa9";
+	char buf[24];
+	int len = randint1(sizeof(buf) - 1), i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = letters[randint0(strlen(letters))];
+	buf[len] = 0;
+	return string_make(buf);
+}
+
+int setup_tests(void **state) {
+	int i;
+
+	Rand_init();
+	Rand_state_init(31);
+	for (i = 0; i < N_NAMES; i++) {
+		if (one_in_(20)) {
+			/* Some names are missing */
+			name_store[i] = NULL;
+		} else if (i > 0 && one_in_(10)) {
+			/* Some are repeated */
+			name_store[i] = string_make(names[randint0(i)]);
+		} else {
+			name_store[i] = random_name();
+		}
+		names[i] = name_store[i];
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	int i;
+
+	for (i = 0; i < N_NAMES; i++)
+		string_free(name_store[i]);
+	return 0;
+}
+
+/* Walk the list as the lookups used to */
+static int walk_find(const char *name, int after, bool exact_case)
+{
+	int i;
+
+	for (i = after + 1; i < N_NAMES; i++) {
+		if (!names[i]) continue;
+		if (exact_case ? streq(names[i], name) : !my_stricmp(names[i], name))
+			return i;
+	}
+	return -1;
+}
+
+static int walk_find_part(const char *part)
+{
+	int i;
+
+	for (i = 0; i < N_NAMES; i++) {
+		if (names[i] && my_stristr(names[i], part)) return i;
+	}
+	return -1;
+}
+
+/* Get something to look for: a name, part of one, or neither */
+static void random_query(char *buf, size_t len)
+{
+	const char *name = names[randint0(N_NAMES)];
+	char *made;
+
+	if (!name || one_in_(4)) {
+		made = random_name();
+		my_strcpy(buf, made, len);
+		string_free(made);
+	} else {
+		size_t start = randint0(strlen(name));
+
+		my_strcpy(buf, name + start, len);
+		if (one_in_(2)) buf[randint0(strlen(buf) + 1)] = 0;
+	}
+
+	/* Change the case of some letters */
+	for (made = buf; *made; made++) {
+		if (one_in_(3)) *made = toupper((unsigned char) *made);
+	}
+}
+
+static int test_find(void *state) {
+	struct name_index *ni = name_index_new(names, N_NAMES);
+	char query[32];
+	int i;
+
+	for (i = 0; i < 4000; i++) {
+		int found = -1;
+		bool exact_case = one_in_(2);
+
+		random_query(query, sizeof(query));
+		do {
+			int want = walk_find(query, found, exact_case);
+
+			found = name_index_find(ni, query, found, exact_case);
+			eq(found, want);
+		} while (found >= 0);
+		eq(name_index_find_part(ni, query), walk_find_part(query));
+	}
+
+	/* Every name can be found, though maybe as an earlier copy */
+	for (i = 0; i < N_NAMES; i++) {
+		if (!names[i]) continue;
+		require(name_index_find(ni, names[i], -1, true) <= i);
+		require(name_index_find(ni, names[i], i - 1, true) == i);
+	}
+	eq(name_index_find_part(ni, ""), -1);
+	name_index_free(ni);
+	ok;
+}
+
+static int test_empty(void *state) {
+	struct name_index *ni = name_index_new(names, 0);
+
+	eq(name_index_find(ni, "a", -1, false), -1);
+	eq(name_index_find_part(ni, "a"), -1);
+	eq(name_index_find_part(ni, "abc"), -1);
+	name_index_free(ni);
+	ok;
+}
+
+static int test_bench(void *state) {
+	struct name_index *ni;
+	char query[64][32];
+	int lookups = 20000, i, sum = 0;
+	clock_t start;
+	double t_walk, t;
+
+	bench_only();
+	ni = name_index_new(names, N_NAMES);
+	for (i = 0; i < 64; i++)
+		random_query(query[i], sizeof(query[i]));
+
+	start = clock();
+	for (i = 0; i < lookups; i++) {
+		int found = walk_find(query[i % 64], -1, false);
+
+		sum += (found >= 0) ? found : walk_find_part(query[i % 64]);
+	}
+	t_walk = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < lookups; i++) {
+		int found = name_index_find(ni, query[i % 64], -1, false);
+
+		sum -= (found >= 0) ? found :
+			name_index_find_part(ni, query[i % 64]);
+	}
+	t = (double)(clock() - start) / CLOCKS_PER_SEC;
+	eq(sum, 0);
+	if (verbose) {
+		printf("\n    %d names: %.0f lookups per second (%.0f walking"
+			" the list)\n    ", N_NAMES, (t > 0) ? lookups / t : 0.0,
+			(t_walk > 0) ? lookups / t_walk : 0.0);
+	}
+	name_index_free(ni);
+	ok;
+}
+
+const char *suite_name = "z-names/names";
+struct test tests[] = {
+	{ "find", test_find },
+	{ "empty", test_empty },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,2 @@
+TESTPROGS += \
+	z-names/names
@@ -0,0 +1,108 @@
+/* z-prof/prof.c */
+/* Exercise the counters for the hot path timings. */
+
+#include "unit-test.h"
+#include "z-file.h"
+#include "z-prof.h"
+#include "z-virt.h"
+
+NOSETUP
+NOTEARDOWN
+
+static int test_count(void *state)
+{
+	const struct prof_counter *c = prof_counter(PROF_PROJECT);
+	uint64_t start, time;
+
+	prof_reset();
+	eq(c->calls, 0);
+	require(streq(c->name, "project"));
+
+	start = prof_now();
+	prof_begin(PROF_PROJECT);
+	while (prof_now() - c->start < 1000000) ;
+	prof_end(PROF_PROJECT);
+	time = prof_now() - start;
+	eq(c->calls, 1);
+	require(c->total >= 1000000 && c->total <= time);
+	eq(c->max, c->total);
+
+	/* A nested call is counted, but its time isn't added again */
+	prof_begin(PROF_PROJECT);
+	prof_begin(PROF_PROJECT);
+	prof_end(PROF_PROJECT);
+	prof_end(PROF_PROJECT);
+	eq(c->calls, 3);
+	require(c->total < 2 * time);
+	eq(c->depth, 0);
+
+	/* Other scopes are untouched */
+	eq(prof_counter(PROF_MONSTER_TURN)->calls, 0);
+	ok;
+}
+
+static int test_allocs(void *state)
+{
+	const struct prof_counter *c = prof_counter(PROF_UPDATE_VIEW);
+	void *p;
+
+	prof_reset();
+	prof_begin(PROF_UPDATE_VIEW);
+	p = mem_alloc(16);
+	p = mem_realloc(p, 32);
+	mem_free(p);
+	prof_end(PROF_UPDATE_VIEW);
+#ifdef ALLOW_PROFILING
+	eq(c->allocs, 2);
+#else
+	eq(c->allocs, 0);
+#endif
+	ok;
+}
+
+static int test_reset(void *state)
+{
+	prof_begin(PROF_MAKE_NOISE);
+	prof_end(PROF_MAKE_NOISE);
+	prof_reset();
+	eq(prof_counter(PROF_MAKE_NOISE)->calls, 0);
+	eq(prof_counter(PROF_MAKE_NOISE)->total, 0);
+	eq(prof_counter(PROF_MAKE_NOISE)->max, 0);
+	ok;
+}
+
+static int test_csv(void *state)
+{
+	char path[1024], line[256];
+	ang_file *f;
+	int lines = 0;
+
+	prof_reset();
+	prof_begin(PROF_UPDATE_SCENT);
+	prof_end(PROF_UPDATE_SCENT);
+	file_get_tempfile(path, sizeof(path), "z-prof-test", "csv");
+	require(prof_write_csv(path));
+	f = file_open(path, MODE_READ, FTYPE_TEXT);
+	require(f);
+	require(file_getl(f, line, sizeof(line)));
+	require(streq(line, "scope,calls,total_us,mean_us,max_us,allocs"));
+	while (file_getl(f, line, sizeof(line))) {
+		if (prefix(line, "update_scent,")) {
+			require(prefix(line, "update_scent,1,"));
+		}
+		lines++;
+	}
+	file_close(f);
+	file_delete(path);
+	eq(lines, PROF_MAX);
+	ok;
+}
+
+const char *suite_name = "z-prof/prof";
+struct test tests[] = {
+	{ "count", test_count },
+	{ "allocs", test_allocs },
+	{ "reset", test_reset },
+	{ "csv", test_csv },
+	{ NULL, NULL }
+};
@@ -0,0 +1,2 @@
+TESTPROGS += \
+	z-prof/prof
@@ -1,7 +1,9 @@
 /* z-quark/quark.c */
 
 #include "unit-test.h"
+#include "z-form.h"
 #include "z-quark.h"
+#include <time.h>
 
 int setup_tests(void **state) {
 	quarks_init();
@@ -46,9 +48,46 @@ static int test_dedup(void *state) {
 	ok;
 }
 
+/* Add 100k strings, then add them all again, checking the quarks hold */
+static int test_bench(void *state) {
+	int n = 100000, i;
+	quark_t first;
+	char buf[32];
+	clock_t start;
+	double t_add, t_find;
+
+	bench_only();
+	start = clock();
+	strnfmt(buf, sizeof(buf), "2-%d", 0);
+	first = quark_add(buf);
+	for (i = 1; i < n; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		eq(quark_add(buf), first + i);
+	}
+	t_add = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < n; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		eq(quark_add(buf), first + i);
+	}
+	t_find = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	for (i = 0; i < n; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		require(streq(quark_str(first + i), buf));
+	}
+	if (verbose) {
+		printf("\n    %d strings: %.3fs to add, %.3fs to add again\n    ",
+			n, t_add, t_find);
+	}
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "bench", test_bench },
 	{ NULL, NULL }
 };
@@ -153,7 +153,7 @@ bool square_remove_trap(struct chunk *c, struct loc grid, struct trap *trap,
 				square_set_trap(c, grid, next_trap);
 				if (!next_trap) {
 					/* There are no more traps here. */
-					sqinfo_off(square(c, grid)->info,
+					sqinfo_off(square_info(c, grid),
 						SQUARE_TRAP);
 				}
 			}
@@ -188,7 +188,7 @@ bool square_remove_all_traps(struct chunk *c, struct loc grid)
 	}
 
 	square_set_trap(c, grid, NULL);
-	sqinfo_off(square(c, grid)->info, SQUARE_TRAP);
+	sqinfo_off(square_info(c, grid), SQUARE_TRAP);
 
 	/* Refresh grids that the character can see */
 	if (square_isseen(c, grid)) {
@@ -225,7 +225,7 @@ bool square_remove_all_traps_of_type(struct chunk *c, struct loc grid,
 			} else {
 				square_set_trap(c, grid, next_trap);
 				if (!next_trap) {
-					sqinfo_off(square(c, grid)->info,
+					sqinfo_off(square_info(c, grid),
 						SQUARE_TRAP);
 				}
 			}
@@ -386,7 +386,7 @@ void place_trap(struct chunk *c, struct loc grid, int t_idx, int trap_level)
 	trf_copy(new_trap->flags, trap_info[t_idx].flags);
 
 	/* Toggle on the trap marker */
-	sqinfo_on(square(c, grid)->info, SQUARE_TRAP);
+	sqinfo_on(square_info(c, grid), SQUARE_TRAP);
 
 	/* Redraw the grid */
 	square_note_spot(c, grid);
@@ -464,7 +464,7 @@ void square_memorize_traps(struct chunk *c, struct loc grid)
 
 	/* Clear current knowledge */
 	square_remove_all_traps(player->cave, grid);
-	sqinfo_off(square(player->cave, grid)->info, SQUARE_TRAP);
+	sqinfo_off(square_info(player->cave, grid), SQUARE_TRAP);
 
 	/* Copy all visible traps to the known cave */
 	while (trap) {
@@ -484,7 +484,7 @@ void square_memorize_traps(struct chunk *c, struct loc grid)
 		trap = trap->next;
 	}
 	if (square(player->cave, grid)->trap) {
-		sqinfo_on(square(player->cave, grid)->info, SQUARE_TRAP);
+		sqinfo_on(square_info(player->cave, grid), SQUARE_TRAP);
 	}
 }
 
@@ -53,6 +53,7 @@
 #include "ui-output.h"
 #include "ui-player.h"
 #include "ui-prefs.h"
+#include "ui-record.h"
 #include "ui-spell.h"
 #include "ui-score.h"
 #include "ui-signals.h"
@@ -302,6 +303,7 @@ struct cmd_info cmd_debug_stats[] =
 	{ "Pits", { 'P' }, CMD_WIZ_COLLECT_PIT_STATS, NULL, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
 	{ "Disconnected levels", { 'D' }, CMD_WIZ_COLLECT_DISCONNECT_STATS, NULL, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
 	{ "Obj/mon alternate key", { 'f' }, CMD_WIZ_COLLECT_OBJ_MON_STATS, NULL, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
+	{ "Hot path timings", { 'Y' }, CMD_NULL, wiz_display_profile, player_can_debug_prereq, 0, NULL, NULL, NULL, 0 },
 };
 
 struct cmd_info cmd_debug_query[] =
@@ -1118,6 +1120,9 @@ void close_game(bool prompt_failed_save)
 {
 	bool prompting = true;
 
+	/* Finish any recording or replay */
+	record_end();
+
 	/* Tell the UI we're done with the world */
 	event_signal(EVENT_LEAVE_WORLD);
 
@@ -1770,6 +1770,14 @@ static bool textui_check_break(bool user_event, int messaging)
 			"button.", 0, 0);
 		Term_fresh();
 	}
+	if (!user_event) {
+		/*
+		 * Only move pending events to the queue; looping would never
+		 * end once there is one there, since nothing is taken.
+		 */
+		return !Term_inkey(&ch, false, false)
+			&& ch.type == EVT_DISCONNECT;
+	}
 	result = false;
 	while (!Term_inkey(&ch, false, user_event)) {
 		if (ch.type == EVT_DISCONNECT) {
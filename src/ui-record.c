@@ -0,0 +1,172 @@
+/**
+ * \file ui-record.c
+ * \brief Record the input of a session so main-test.c can replay it
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "buildid.h"
+#include "cave.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "monster.h"
+#include "object.h"
+#include "player.h"
+#include "ui-event.h"
+#include "ui-game.h"
+#include "ui-record.h"
+#include "ui-term.h"
+#include "z-rand.h"
+
+/**
+ * A recording is a script for main-test.c:  the seed for the random numbers,
+ * then each keypress or mouse click from the front end, with the number of
+ * times the game had asked for input since the one before, so the replay can
+ * hand the input over at the same point even when the game was only checking
+ * for a key, as it does while resting or running.  Input the game makes up
+ * itself is not recorded, since it will make it up again in the replay.
+ * The input is only the same if the replay starts from the same savefile,
+ * so keep a copy of it from before the recording.
+ */
+static ang_file *record_file = NULL;
+
+/**
+ * Called once when the game ends, so a replay can report how it went
+ */
+void (*record_end_hook)(void) = NULL;
+
+static void record_input(const ui_event *e, int asks)
+{
+	if (e->type == EVT_KBRD) {
+		file_putf(record_file, "keypress %d %lu %u\n", asks,
+			(unsigned long)e->key.code, (unsigned)e->key.mods);
+	} else if (e->type == EVT_MOUSE) {
+		file_putf(record_file, "mouse %d %u %u %u %u\n", asks,
+			(unsigned)e->mouse.button, (unsigned)e->mouse.x,
+			(unsigned)e->mouse.y, (unsigned)e->mouse.mods);
+	}
+}
+
+/**
+ * Start a new phase of the replay's timing on each new level
+ */
+static void record_new_level(game_event_type type, game_event_data *data,
+		void *user)
+{
+	file_putf(record_file, "phase level-%d\n", player->depth);
+}
+
+/**
+ * Start recording the input to the given file, and reseed the random
+ * numbers with a seed written to the file.
+ */
+bool record_start(const char *path)
+{
+	uint32_t seed;
+
+	record_file = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!record_file) return false;
+
+	seed = randint0(0x10000000);
+	Rand_quick = false;
+	Rand_state_init(seed);
+
+	file_putf(record_file, "# Recorded by %s from savefile %s\n", buildid,
+		savefile[0] ? savefile : "(new)");
+	file_putf(record_file, "seed %lu\n", (unsigned long)seed);
+	file_putf(record_file, "phase start\n");
+	inkey_record_hook = record_input;
+	event_add_handler(EVENT_NEW_LEVEL_DISPLAY, record_new_level, NULL);
+	return true;
+}
+
+/**
+ * Stop recording, noting the state of the game for checking replays, and
+ * let a replay report; called when the game ends
+ */
+void record_end(void)
+{
+	if (record_file) {
+		inkey_record_hook = NULL;
+		event_remove_handler(EVENT_NEW_LEVEL_DISPLAY, record_new_level,
+			NULL);
+		if (character_dungeon) {
+			file_putf(record_file, "# state-hash %08lx\n",
+				(unsigned long)record_state_hash());
+		}
+		file_close(record_file);
+		record_file = NULL;
+	}
+	if (record_end_hook) {
+		void (*hook)(void) = record_end_hook;
+
+		record_end_hook = NULL;
+		hook();
+	}
+}
+
+static uint32_t hash_add(uint32_t hash, int32_t value)
+{
+	return (hash * 33) ^ (uint32_t)value;
+}
+
+/**
+ * Hash the parts of the game state which a replay should reproduce:  the
+ * random numbers, the player, the gear, the terrain and the monsters.
+ */
+uint32_t record_state_hash(void)
+{
+	uint32_t hash = 5381;
+	struct object *obj;
+	struct loc grid;
+	int i;
+
+	hash = hash_add(hash, state_i);
+	for (i = 0; i < RAND_DEG; i++) {
+		hash = hash_add(hash, STATE[i]);
+	}
+	hash = hash_add(hash, turn);
+
+	hash = hash_add(hash, player->depth);
+	hash = hash_add(hash, player->grid.x);
+	hash = hash_add(hash, player->grid.y);
+	hash = hash_add(hash, player->lev);
+	hash = hash_add(hash, player->exp);
+	hash = hash_add(hash, player->chp);
+	hash = hash_add(hash, player->csp);
+	hash = hash_add(hash, player->au);
+	for (i = 0; i < STAT_MAX; i++) {
+		hash = hash_add(hash, player->stat_cur[i]);
+	}
+	for (obj = player->gear; obj; obj = obj->next) {
+		hash = hash_add(hash, obj->kind->kidx);
+		hash = hash_add(hash, obj->number);
+	}
+
+	if (!cave) return hash;
+	for (grid.y = 0; grid.y < cave->height; grid.y++) {
+		for (grid.x = 0; grid.x < cave->width; grid.x++) {
+			hash = hash_add(hash, square(cave, grid)->feat);
+		}
+	}
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (!mon->race) continue;
+		hash = hash_add(hash, mon->race->ridx);
+		hash = hash_add(hash, mon->grid.x);
+		hash = hash_add(hash, mon->grid.y);
+		hash = hash_add(hash, mon->hp);
+	}
+	return hash;
+}
@@ -0,0 +1,26 @@
+/**
+ * \file ui-record.h
+ * \brief Record the input of a session so main-test.c can replay it
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_UI_RECORD_H
+#define INCLUDED_UI_RECORD_H
+
+extern void (*record_end_hook)(void);
+
+bool record_start(const char *path);
+void record_end(void);
+uint32_t record_state_hash(void);
+
+#endif /* INCLUDED_UI_RECORD_H */
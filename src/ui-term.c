@@ -19,6 +19,7 @@
 #include "h-basic.h"
 #include "ui-term.h"
 #include "z-color.h"
+#include "z-prof.h"
 #include "z-util.h"
 #include "z-virt.h"
 
@@ -315,6 +316,15 @@ int log_i = 0;
 int log_size = 0;
 struct keypress keylog[KEYLOG_SIZE];
 
+/**
+ * If set, called with each keypress or mouse click the front end queues
+ * while Term_inkey() asks it for input, and the number of times Term_inkey()
+ * has asked since the last one; see ui-record.c
+ */
+void (*inkey_record_hook)(const ui_event *e, int asks) = NULL;
+static bool inkey_asking = false;
+static int inkey_asks = 0;
+
 
 /**
  * ------------------------------------------------------------------------
@@ -742,6 +752,43 @@ void Term_queue_chars(int x, int y, int n, int a, const wchar_t *s)
  * ------------------------------------------------------------------------ */
 
 
+/**
+ * Number of columns compared at once when looking for changes in a row
+ */
+#define TERM_SAME_BLOCK 16
+
+/**
+ * Skip the blocks of columns, from x up to x2, that are the same on the
+ * displayed and requested screens; the terrain layers are compared too if
+ * asked.  Each block is compared with memcmp(), which the C library does
+ * many bytes at a time.
+ *
+ * Returns the first column of the first block with a change (or too short
+ * to compare whole), so the caller still checks columns one by one from
+ * there.
+ */
+static int Term_skip_same(int y, int x, int x2, bool terrain)
+{
+	const term_win *old = Term->old;
+	const term_win *scr = Term->scr;
+
+	while (x + TERM_SAME_BLOCK - 1 <= x2
+			&& !memcmp(old->a[y] + x, scr->a[y] + x,
+				TERM_SAME_BLOCK * sizeof(int))
+			&& !memcmp(old->c[y] + x, scr->c[y] + x,
+				TERM_SAME_BLOCK * sizeof(wchar_t))
+			&& (!terrain
+				|| (!memcmp(old->ta[y] + x, scr->ta[y] + x,
+					TERM_SAME_BLOCK * sizeof(int))
+				&& !memcmp(old->tc[y] + x, scr->tc[y] + x,
+					TERM_SAME_BLOCK * sizeof(wchar_t))))) {
+		x += TERM_SAME_BLOCK;
+	}
+
+	return x;
+}
+
+
 /**
  * Flush a row of the current window (see "Term_fresh")
  *
@@ -809,7 +856,8 @@ static void Term_fresh_row_pict(int y, int x1, int x2)
 				fn = 0;
 			}
 
-			/* Skip */
+			/* Skip, along with any unchanged blocks after */
+			x = Term_skip_same(y, x + 1, x2, true) - 1;
 			continue;
 		}
 
@@ -1149,7 +1197,13 @@ static void Term_fresh_row_both(int y, int x1, int x2)
 					&nta, &ntc));
 			}
 
-			/* Skip */
+			/*
+			 * Skip, along with any unchanged blocks after if
+			 * there are no big tiles whose padding could change
+			 */
+			if (tile_width == 1 && tile_height == 1) {
+				x = Term_skip_same(y, x + 1, x2, true) - 1;
+			}
 			continue;
 		}
 
@@ -1522,7 +1576,8 @@ static void Term_fresh_row_text(int y, int x1, int x2)
 				fn = 0;
 			}
 
-			/* Skip */
+			/* Skip, along with any unchanged blocks after */
+			x = Term_skip_same(y, x + 1, x2, false) - 1;
 			continue;
 		}
 
@@ -1739,6 +1794,7 @@ errr Term_fresh(void)
 		return (1);
 	}
 
+	PROF_BEGIN(PROF_TERM_FRESH);
 
 	/* Paranoia -- use "fake" hooks to prevent core dumps */
 	if (!Term->curs_hook) Term->curs_hook = Term_curs_hack;
@@ -1758,22 +1814,21 @@ errr Term_fresh(void)
 		old->cx = old->cy = 0;
 		old->cnx = old->cny = 1;
 
-		/* Wipe each row */
-		for (y = 0; y < h; y++) {
-			int *aa = old->a[y];
-			wchar_t *cc = old->c[y];
-			int *taa = old->ta[y];
-			wchar_t *tcc = old->tc[y];
-
-			/* Wipe each column */
-			for (x = 0; x < w; x++) {
-				/* Wipe each grid */
-				*aa++ = COLOUR_WHITE;
-				*cc++ = ' ';
-
-				*taa++ = COLOUR_WHITE;
-				*tcc++ = ' ';
-			}
+		/* Wipe each grid of the first row */
+		for (x = 0; x < w; x++) {
+			old->a[0][x] = COLOUR_WHITE;
+			old->c[0][x] = ' ';
+
+			old->ta[0][x] = COLOUR_WHITE;
+			old->tc[0][x] = ' ';
+		}
+
+		/* Copy it to the other rows */
+		for (y = 1; y < h; y++) {
+			memcpy(old->a[y], old->a[0], w * sizeof(int));
+			memcpy(old->c[y], old->c[0], w * sizeof(wchar_t));
+			memcpy(old->ta[y], old->ta[0], w * sizeof(int));
+			memcpy(old->tc[y], old->tc[0], w * sizeof(wchar_t));
 		}
 
 		/* Redraw every row */
@@ -1979,6 +2034,8 @@ errr Term_fresh(void)
 	/* Actually flush the output */
 	Term_xtra(TERM_XTRA_FRESH, 0);
 
+	PROF_END(PROF_TERM_FRESH);
+
 	/* Success */
 	return (0);
 }
@@ -2541,6 +2598,18 @@ static void log_keypress(ui_event e)
 }
 
 
+/**
+ * Pass input the front end has just queued to the recording hook, if the
+ * game asked for it; input queued by the game itself isn't recorded
+ */
+static void record_input(const ui_event *e)
+{
+	if (!inkey_asking || !inkey_record_hook) return;
+	inkey_record_hook(e, inkey_asks);
+	inkey_asks = 0;
+}
+
+
 /**
  * Add a keypress to the "queue"
  */
@@ -2576,6 +2645,7 @@ errr Term_keypress(keycode_t k, uint8_t mods)
 			.mods = mods
 		}
 	};
+	record_input(&Term->key_queue[Term->key_head]);
 	Term->key_head++;
 
 	/* Circular queue, handle wrap */
@@ -2609,6 +2679,7 @@ errr Term_mousepress(int x, int y, char button)/*, uint8_t mods);*/
 			.mods   = (button & 0xF0) >> 4
 		}
 	};
+	record_input(&Term->key_queue[Term->key_head]);
 
 	Term->key_head++;
 
@@ -2685,6 +2756,9 @@ errr Term_inkey(ui_event *ch, bool wait, bool take)
 	}
 
 	if (Term->key_head == Term->key_tail) {
+		/* Count the asks, for recording */
+		if (inkey_record_hook) inkey_asks++;
+
 		if (wait) {
 			do {
 				if (terms_disconnecting) {
@@ -2693,7 +2767,9 @@ errr Term_inkey(ui_event *ch, bool wait, bool take)
 				}
 
 				/* Process events (wait for one) */
+				inkey_asking = true;
 				Term_xtra(TERM_XTRA_EVENT, true);
+				inkey_asking = false;
 			} while (Term->key_head == Term->key_tail);
 		} else {
 			if (terms_disconnecting) {
@@ -2702,7 +2778,9 @@ errr Term_inkey(ui_event *ch, bool wait, bool take)
 			}
 
 			/* Process events (do not wait) */
+			inkey_asking = true;
 			Term_xtra(TERM_XTRA_EVENT, false);
+			inkey_asking = false;
 
 			/* No keys are ready */
 			if (Term->key_head == Term->key_tail) return 1;
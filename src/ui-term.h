@@ -337,6 +337,7 @@ extern int col_map[SIDEBAR_MAX];
 extern int log_i;
 extern int log_size;
 extern struct keypress keylog[KEYLOG_SIZE];
+extern void (*inkey_record_hook)(const ui_event *e, int asks);
 
 
 /**
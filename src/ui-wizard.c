@@ -32,6 +32,7 @@
 #include "ui-menu.h"
 #include "ui-prefs.h"
 #include "ui-wizard.h"
+#include "z-prof.h"
 
 
 static void proj_display(struct menu *m, int type, bool cursor,
@@ -142,6 +143,48 @@ void wiz_display_keylog(void)
 }
 
 
+/**
+ * Display the hot path timings; 'r' starts them afresh.  The times are
+ * written to profile.csv in the user directory when the game exits.
+ */
+void wiz_display_profile(void)
+{
+#ifdef ALLOW_PROFILING
+	struct keypress ch;
+
+	screen_save();
+	do {
+		char buf[80];
+		int i;
+
+		clear_from(0);
+		prt("Hot path timings since the game started or was reset:", 0, 0);
+		strnfmt(buf, sizeof(buf), "%-18s %10s %11s %10s %10s %10s",
+			"scope", "calls", "total ms", "mean us", "max us",
+			"allocs");
+		prt(buf, 2, 0);
+		for (i = 0; i < PROF_MAX; i++) {
+			const struct prof_counter *c = prof_counter(i);
+
+			strnfmt(buf, sizeof(buf),
+				"%-18s %10lu %11.1f %10.1f %10.1f %10lu", c->name,
+				(unsigned long)c->calls, c->total / 1e6,
+				c->calls ? c->total / 1e3 / c->calls : 0.0,
+				c->max / 1e3, (unsigned long)c->allocs);
+			prt(buf, i + 3, 0);
+		}
+		prt("Press 'r' to reset, any other key to continue.",
+			PROF_MAX + 4, 0);
+		ch = inkey();
+		if (ch.code == 'r') prof_reset();
+	} while (ch.code == 'r');
+	screen_load();
+#else
+	msg("The game was built without ALLOW_PROFILING.");
+#endif
+}
+
+
 /** Object creation code **/
 static bool choose_artifact = false;
 static const region wiz_create_item_area = { 0, 0, 0, 0 };
@@ -13,6 +13,7 @@ void wiz_create_artifact(void);
 void wiz_create_item(bool art);
 void wiz_create_nonartifact(void);
 void wiz_display_keylog(void);
+void wiz_display_profile(void);
 void wiz_learn_all_object_kinds(void);
 void wiz_phase_door(void);
 void wiz_proj_demo(void);
@@ -967,6 +967,22 @@ bool file_newer(const char *first, const char *second)
 #endif /* !HAVE_STAT */
 }
 
+/**
+ * Find the size of a file, returning false if that can't be done.
+ */
+bool file_size(const char *fname, size_t *size)
+{
+#ifdef HAVE_STAT
+	struct stat st;
+
+	if (stat(fname, &st) != 0) return false;
+	*size = (size_t)st.st_size;
+	return true;
+#else /* HAVE_STAT */
+	return false;
+#endif /* !HAVE_STAT */
+}
+
 
 
 
@@ -172,6 +172,13 @@ bool file_move(const char *fname, const char *newname);
  */
 bool file_newer(const char *first, const char *second);
 
+/**
+ * Sets `*size` to the size in bytes of the file `fname`.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool file_size(const char *fname, size_t *size);
+
 
 /** File handle creation **/
 
@@ -0,0 +1,204 @@
+/**
+ * \file z-names.c
+ * \brief Find names in a fixed list by whole name or by part
+ *
+ * Copyright (c) 2026 The Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "z-names.h"
+#include "z-util.h"
+#include "z-virt.h"
+
+/**
+ * Number of groups the three letter runs of the names are sorted into
+ */
+#define TRIGRAM_GROUPS	4096
+
+/**
+ * Whole names are found through an open addressing table of 1 + the place
+ * of each name in the list, 0 for an empty slot, by the hash of the name
+ * with case ignored.
+ *
+ * Parts of names are found through the groups of three letter runs.  The
+ * names with a run in group g are tri_names[tri_start[g]] up to, but not
+ * including, tri_names[tri_start[g + 1]], in list order; any name holding
+ * a part of three letters or more is in the group of each of its runs.
+ */
+struct name_index {
+	const char **names;
+	int n;
+	int *slots;
+	size_t n_slots;
+	int *tri_start;
+	int *tri_names;
+};
+
+/**
+ * Hash a name with case ignored, the way my_stricmp() compares
+ */
+static uint32_t name_hash(const char *s)
+{
+	uint32_t hash = 5381;
+
+	for (; *s; s++)
+		hash = ((hash << 5) + hash) + toupper((unsigned char) *s);
+
+	return hash;
+}
+
+/**
+ * Get the group of the three letter run starting at s, with case ignored
+ * the way my_stristr() ignores it
+ */
+static int trigram_group(const char *s)
+{
+	uint32_t t = (toupper((unsigned char) s[0]) * 31
+		+ toupper((unsigned char) s[1])) * 31
+		+ toupper((unsigned char) s[2]);
+
+	return (t ^ (t >> 12)) & (TRIGRAM_GROUPS - 1);
+}
+
+/**
+ * Add each name to the groups of its three letter runs, or just count the
+ * names in each group if tri_names is not ready
+ */
+static void trigram_fill(struct name_index *ni, int *last, int *pos)
+{
+	int i, g;
+
+	for (g = 0; g < TRIGRAM_GROUPS; g++)
+		last[g] = -1;
+
+	for (i = 0; i < ni->n; i++) {
+		const char *s = ni->names[i];
+
+		if (!s) continue;
+		for (; s[0] && s[1] && s[2]; s++) {
+			g = trigram_group(s);
+
+			/* Each name goes in a group once */
+			if (last[g] == i) continue;
+			last[g] = i;
+			if (pos) {
+				ni->tri_names[pos[g]++] = i;
+			} else {
+				ni->tri_start[g + 1]++;
+			}
+		}
+	}
+}
+
+struct name_index *name_index_new(const char **names, int n)
+{
+	struct name_index *ni = mem_zalloc(sizeof(*ni));
+	int *last = mem_alloc(TRIGRAM_GROUPS * sizeof(*last));
+	int *pos = mem_alloc(TRIGRAM_GROUPS * sizeof(*pos));
+	int i, g;
+
+	ni->names = mem_alloc(MAX(n, 1) * sizeof(*ni->names));
+	memcpy(ni->names, names, n * sizeof(*names));
+	ni->n = n;
+
+	/* Keep the table at most half full */
+	ni->n_slots = 16;
+	while (ni->n_slots < (size_t) n * 2)
+		ni->n_slots *= 2;
+	ni->slots = mem_zalloc(ni->n_slots * sizeof(*ni->slots));
+	for (i = 0; i < n; i++) {
+		size_t s;
+
+		if (!names[i]) continue;
+		s = name_hash(names[i]) & (ni->n_slots - 1);
+		while (ni->slots[s])
+			s = (s + 1) & (ni->n_slots - 1);
+		ni->slots[s] = i + 1;
+	}
+
+	/* Count the names in each group, then place them */
+	ni->tri_start = mem_zalloc((TRIGRAM_GROUPS + 1) * sizeof(*ni->tri_start));
+	trigram_fill(ni, last, NULL);
+	for (g = 0; g < TRIGRAM_GROUPS; g++) {
+		ni->tri_start[g + 1] += ni->tri_start[g];
+		pos[g] = ni->tri_start[g];
+	}
+	ni->tri_names = mem_alloc(MAX(ni->tri_start[TRIGRAM_GROUPS], 1)
+		* sizeof(*ni->tri_names));
+	trigram_fill(ni, last, pos);
+
+	mem_free(pos);
+	mem_free(last);
+	return ni;
+}
+
+void name_index_free(struct name_index *ni)
+{
+	if (!ni) return;
+	mem_free(ni->tri_names);
+	mem_free(ni->tri_start);
+	mem_free(ni->slots);
+	mem_free(ni->names);
+	mem_free(ni);
+}
+
+int name_index_find(const struct name_index *ni, const char *name,
+		int after, bool exact_case)
+{
+	size_t s = name_hash(name) & (ni->n_slots - 1);
+	int found = -1;
+
+	/* Names with the same hash are all in the run of full slots */
+	for (; ni->slots[s]; s = (s + 1) & (ni->n_slots - 1)) {
+		int i = ni->slots[s] - 1;
+
+		if (i <= after || (found >= 0 && i > found)) continue;
+		if (exact_case ? streq(ni->names[i], name)
+				: !my_stricmp(ni->names[i], name)) {
+			found = i;
+		}
+	}
+
+	return found;
+}
+
+int name_index_find_part(const struct name_index *ni, const char *part)
+{
+	size_t len = strlen(part);
+	int best, i;
+
+	/* Short parts are rare, so just look at every name */
+	if (len < 3) {
+		for (i = 0; i < ni->n; i++) {
+			if (ni->names[i] && my_stristr(ni->names[i], part))
+				return i;
+		}
+		return -1;
+	}
+
+	/* Look through the smallest group of the part's runs */
+	best = trigram_group(part);
+	for (i = 1; i + 2 < (int) len; i++) {
+		int g = trigram_group(part + i);
+
+		if (ni->tri_start[g + 1] - ni->tri_start[g]
+				< ni->tri_start[best + 1] - ni->tri_start[best]) {
+			best = g;
+		}
+	}
+	for (i = ni->tri_start[best]; i < ni->tri_start[best + 1]; i++) {
+		if (my_stristr(ni->names[ni->tri_names[i]], part))
+			return ni->tri_names[i];
+	}
+
+	return -1;
+}
@@ -0,0 +1,54 @@
+/**
+ * \file z-names.h
+ * \brief Find names in a fixed list by whole name or by part
+ *
+ * Copyright (c) 2026 The Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_Z_NAMES_H
+#define INCLUDED_Z_NAMES_H
+
+#include "h-basic.h"
+
+/**
+ * An index of a list of names, such as those of the monster races.  The
+ * names are not copied, so must stay unchanged while the index is in use.
+ */
+struct name_index;
+
+/**
+ * Index the n names in names; any of them may be NULL
+ */
+struct name_index *name_index_new(const char **names, int n);
+
+/**
+ * Free an index made by name_index_new()
+ */
+void name_index_free(struct name_index *ni);
+
+/**
+ * Return the first name after `after` which is `name`, ignoring case unless
+ * `exact_case` is set, or -1 if there is none.  Pass -1 for `after` to
+ * start at the beginning.
+ */
+int name_index_find(const struct name_index *ni, const char *name,
+		int after, bool exact_case);
+
+/**
+ * Return the first name which contains `part`, as my_stristr() would find
+ * it, or -1 if there is none
+ */
+int name_index_find_part(const struct name_index *ni, const char *part);
+
+#endif /* INCLUDED_Z_NAMES_H */
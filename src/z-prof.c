@@ -0,0 +1,121 @@
+/**
+ * \file z-prof.c
+ * \brief Counters for timing the game's hot paths
+ *
+ * Copyright (c) 2026 The Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "z-file.h"
+#include "z-prof.h"
+#ifdef WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint32_t prof_allocs = 0;
+
+static struct prof_counter counters[PROF_MAX] = {
+	#define PROF(a, b) { b, 0, 0, 0, 0, 0, 0, 0 },
+	#include "list-prof-scopes.h"
+	#undef PROF
+};
+
+/**
+ * Nanoseconds from some fixed point, from the best clock to hand
+ */
+uint64_t prof_now(void)
+{
+#if defined(WINDOWS)
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+	return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+void prof_begin(enum prof_scope s)
+{
+	struct prof_counter *c = &counters[s];
+
+	c->calls++;
+	if (c->depth++) return;
+	c->start_allocs = prof_allocs;
+	c->start = prof_now();
+}
+
+void prof_end(enum prof_scope s)
+{
+	struct prof_counter *c = &counters[s];
+	uint64_t time;
+
+	assert(c->depth > 0);
+	if (--c->depth) return;
+	time = prof_now() - c->start;
+	c->total += time;
+	if (time > c->max) c->max = time;
+	c->allocs += prof_allocs - c->start_allocs;
+}
+
+const struct prof_counter *prof_counter(enum prof_scope s)
+{
+	return &counters[s];
+}
+
+/**
+ * Start counting afresh; scopes which are running keep running
+ */
+void prof_reset(void)
+{
+	int i;
+
+	for (i = 0; i < PROF_MAX; i++) {
+		counters[i].calls = 0;
+		counters[i].total = 0;
+		counters[i].max = 0;
+		counters[i].allocs = 0;
+		counters[i].start = prof_now();
+		counters[i].start_allocs = prof_allocs;
+	}
+}
+
+/**
+ * Write the counts as comma-separated values, with times in microseconds
+ */
+bool prof_write_csv(const char *path)
+{
+	ang_file *f = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	int i;
+
+	if (!f) return false;
+	file_putf(f, "scope,calls,total_us,mean_us,max_us,allocs\n");
+	for (i = 0; i < PROF_MAX; i++) {
+		const struct prof_counter *c = &counters[i];
+
+		file_putf(f, "%s,%lu,%.1f,%.3f,%.1f,%lu\n", c->name,
+			(unsigned long)c->calls, c->total / 1000.0,
+			c->calls ? c->total / 1000.0 / c->calls : 0.0,
+			c->max / 1000.0, (unsigned long)c->allocs);
+	}
+	return file_close(f);
+}
@@ -0,0 +1,76 @@
+/**
+ * \file z-prof.h
+ * \brief Counters for timing the game's hot paths
+ *
+ * Copyright (c) 2026 The Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_Z_PROF_H
+#define INCLUDED_Z_PROF_H
+
+#include "h-basic.h"
+
+/**
+ * The scopes, from list-prof-scopes.h
+ */
+enum prof_scope {
+	#define PROF(a, b) PROF_##a,
+	#include "list-prof-scopes.h"
+	#undef PROF
+	PROF_MAX
+};
+
+/**
+ * What has been counted for a scope.  Time is inclusive of the scopes
+ * nested inside; a scope re-entered before it ends (project() from an
+ * effect of project(), say) counts the call but not the time twice.
+ */
+struct prof_counter {
+	const char *name;
+	uint32_t calls;
+	uint64_t total;		/* nanoseconds */
+	uint64_t max;		/* nanoseconds, for the longest call */
+	uint32_t allocs;	/* calls to mem_alloc() and mem_realloc() */
+
+	int depth;
+	uint64_t start;
+	uint32_t start_allocs;
+};
+
+/**
+ * Calls to mem_alloc() and mem_realloc(), when built with ALLOW_PROFILING
+ */
+extern uint32_t prof_allocs;
+
+/**
+ * Time the code between them.  These compile to nothing unless the game is
+ * built with ALLOW_PROFILING (SUPPORT_PROFILING in cmake, --enable-profiling
+ * for configure).
+ */
+#ifdef ALLOW_PROFILING
+#define PROF_BEGIN(s) prof_begin(s)
+#define PROF_END(s) prof_end(s)
+#else
+#define PROF_BEGIN(s) ((void)0)
+#define PROF_END(s) ((void)0)
+#endif
+
+uint64_t prof_now(void);
+void prof_begin(enum prof_scope s);
+void prof_end(enum prof_scope s);
+const struct prof_counter *prof_counter(enum prof_scope s);
+void prof_reset(void);
+bool prof_write_csv(const char *path);
+
+#endif /* INCLUDED_Z_PROF_H */
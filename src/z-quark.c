@@ -26,16 +26,46 @@ static char **quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/* Open addressing index of the quarks by string hash, 0 for an empty slot */
+static quark_t *quark_index;
+static size_t index_size = 0;
+
 #define QUARKS_INIT	16
 
+/**
+ * Find the index slot holding str, or the empty slot where it would go
+ */
+static size_t quark_slot(const char *str)
+{
+	size_t i = djb2_hash(str) & (index_size - 1);
+
+	while (quark_index[i] && !streq(quarks[quark_index[i]], str))
+		i = (i + 1) & (index_size - 1);
+
+	return i;
+}
+
+/**
+ * Double the size of the index and put the quarks back in it
+ */
+static void quark_index_grow(void)
+{
+	quark_t q;
+
+	mem_free(quark_index);
+	index_size *= 2;
+	quark_index = mem_zalloc(index_size * sizeof(quark_t));
+	for (q = 1; q < nr_quarks; q++)
+		quark_index[quark_slot(quarks[q])] = q;
+}
+
 quark_t quark_add(const char *str)
 {
 	quark_t q;
+	size_t slot = quark_slot(str);
 
-	for (q = 1; q < nr_quarks; q++) {
-		if (streq(quarks[q], str))
-			return q;
-	}
+	if (quark_index[slot])
+		return quark_index[slot];
 
 	if (nr_quarks == alloc_quarks) {
 		alloc_quarks *= 2;
@@ -44,6 +74,11 @@ quark_t quark_add(const char *str)
 
 	q = nr_quarks++;
 	quarks[q] = string_make(str);
+	quark_index[slot] = q;
+
+	/* Keep the index at most half full */
+	if (nr_quarks * 2 > index_size)
+		quark_index_grow();
 
 	return q;
 }
@@ -58,6 +93,8 @@ void quarks_init(void)
 	nr_quarks = 1;
 	alloc_quarks = QUARKS_INIT;
 	quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+	index_size = QUARKS_INIT * 2;
+	quark_index = mem_zalloc(index_size * sizeof(quark_t));
 }
 
 void quarks_free(void)
@@ -69,6 +106,7 @@ void quarks_free(void)
 		string_free(quarks[i]);
 
 	mem_free(quarks);
+	mem_free(quark_index);
 }
 
 struct init_module z_quark_module = {
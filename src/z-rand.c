@@ -105,8 +105,9 @@ void Rand_state_init(uint32_t seed)
 {
 	int i, j;
 
-	/* Seed the table */
+	/* Seed the table, starting from a fixed index */
 	STATE[0] = seed;
+	state_i = 0;
 
 	/* Propagate the seed */
 	for (i = 1; i < RAND_DEG; i++)
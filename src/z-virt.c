@@ -15,6 +15,7 @@
  *    and not for profit purposes provided that this copyright and statement
  *    are included in all such copies.  Other copyrights may also apply.
  */
+#include "z-prof.h"
 #include "z-virt.h"
 #include "z-util.h"
 
@@ -35,6 +36,9 @@ void *mem_alloc(size_t len)
 	if (!len)
 		return NULL;
 
+#ifdef ALLOW_PROFILING
+	prof_allocs++;
+#endif
 	void *p = malloc(len);
 	if (!p)
 		quit("Out of memory!");
@@ -61,6 +65,9 @@ void *mem_realloc(void *p, size_t len)
 	if (!len)
 		return NULL;
 
+#ifdef ALLOW_PROFILING
+	prof_allocs++;
+#endif
 	p = realloc(p, len);
 	if (!p)
 		quit("Out of Memory!");